@@ -40,6 +40,8 @@ void blm_Enable(blm_t *m)
         m->dT = 1. / 30000.;	/* PWM period */
 	m->sT = 1E-6;		/* Solver step */
 	m->PWM_R = 2800;	/* PWM resolution */
+	m->DUAL = 0;		/* Double update */
+	m->Mext = 0.;		/* External torque */
 
         m->X[0] = 0.;	/* Axis D current (Ampere) */
 	m->X[1] = 0.;	/* Axis Q current (Ampere) */
@@ -62,6 +64,7 @@ void blm_Enable(blm_t *m)
 	m->VSI[1] = 0;
 	m->VSI[2] = 0;
 	m->surge_I = 0;
+	m->sH = 0;
 
 	/* Winding resistance. (Ohm)
          * */
@@ -95,6 +98,14 @@ void blm_Enable(blm_t *m)
 	 * */
 	m->Cb = 2040E-6;
 
+	/* Equivalent FETs switching time. (Second)
+	 * */
+	m->Tsw = 50E-9;
+
+	/* Equivalent FETs output capacitance. (Farad)
+	 * */
+	m->Coss = 0.;
+
 	/* Number of the rotor pole pairs.
 	 * */
 	m->Zp = 15;
@@ -116,6 +127,10 @@ void blm_Enable(blm_t *m)
 	m->M[1] = 2E-2;
 	m->M[2] = 5E-3;
 
+	/* Cogging torque amplitude.
+	 * */
+	m->M[3] = 0E-3;
+
 	/* ADC conversion time (s).
 	 * */
 	m->T_ADC = 0.643E-6;
@@ -125,6 +140,11 @@ void blm_Enable(blm_t *m)
 	m->tau_I = 0.636E-6;
 	m->tau_U = 25.53E-6;
 
+	/* Current sensor offset drift (A).
+	 * */
+	m->bias_I[0] = 0.;
+	m->bias_I[1] = 0.;
+
 	/* Hall sensor angles.
 	 * */
 	m->HS[0] = 30.;
@@ -192,6 +212,14 @@ blm_DQ_Equation(const blm_t *m, const double X[7], double D[7])
 	wS = X[2] / m->Zp;
 	ML = m->M[0] - wS * (m->M[1] + fabs(wS) * m->M[2]);
 
+	/* Cogging.
+	 * */
+	ML += m->M[3] * sin(X[3] * 6.);
+
+	/* Torque applied from outside (coupled shaft).
+	 * */
+	ML += m->Mext;
+
 	/* Mechanical equations.
 	 * */
 	D[2] = m->Zp * (MT + ML) / m->J;
@@ -377,10 +405,10 @@ blm_VSI_Sample(blm_t *m, int N)
 
 	if (N == 0) {
 
-		ADC = blm_ADC(m->X[7] / 2. / range_I + .5);
+		ADC = blm_ADC((m->X[7] + m->bias_I[0]) / 2. / range_I + .5);
 		m->ADC_IA = (ADC - 2047) * range_I / 2048.;
 
-		ADC = blm_ADC(m->X[8] / 2. / range_I + .5);
+		ADC = blm_ADC((m->X[8] + m->bias_I[1]) / 2. / range_I + .5);
 		m->ADC_IB = (ADC - 2047) * range_I / 2048.;
 	}
 	else if (N == 1) {
@@ -404,6 +432,26 @@ blm_VSI_Sample(blm_t *m, int N)
 	}
 }
 
+static void
+blm_VSI_Loss(blm_t *m, int N)
+{
+	double		iA, iB, iX;
+
+	if (m->HI_Z == 0) {
+
+		blm_DQ_AB(m->X[3], m->X[0], m->X[1], &iA, &iB);
+
+		iX = (N == 0) ? iA : (N == 1) ? iB : - (iA + iB);
+
+		/* Switching losses of the half-bridge. Overlap of voltage
+		 * and current plus the output capacitance charge that does
+		 * not depend on the load.
+		 * */
+		m->X[5] += .5 * m->X[6] * fabs(iX) * m->Tsw;
+		m->X[5] += .5 * m->X[6] * m->X[6] * m->Coss;
+	}
+}
+
 static void
 blm_VSI_Solve(blm_t *m)
 {
@@ -412,70 +460,103 @@ blm_VSI_Solve(blm_t *m)
 
 	tTIM = m->dT / m->PWM_R / 2.;
 
-	/* ADC sampling.
-	 * */
-	Tev[0] = m->PWM_R - (int) (m->T_ADC / tTIM);
-	Tev[1] = m->PWM_R - (int) (2. * m->T_ADC / tTIM);
+	if (m->DUAL == 0 || m->sH == 0) {
 
-	/* FETs switching.
-	 * */
-	Tev[2] = (m->PWM_A < 0) ? 0 : (m->PWM_A > m->PWM_R) ? m->PWM_R : m->PWM_A;
-	Tev[3] = (m->PWM_B < 0) ? 0 : (m->PWM_B > m->PWM_R) ? m->PWM_R : m->PWM_B;
-	Tev[4] = (m->PWM_C < 0) ? 0 : (m->PWM_C > m->PWM_R) ? m->PWM_R : m->PWM_C;
+		/* ADC sampling.
+		 * */
+		Tev[0] = m->PWM_R - (int) (m->T_ADC / tTIM);
+		Tev[1] = m->PWM_R - (int) (2. * m->T_ADC / tTIM);
 
-	for (n = 0; n < 5; ++n)
-		pm[n] = n;
+		/* FETs switching.
+		 * */
+		Tev[2] = (m->PWM_A < 0) ? 0 : (m->PWM_A > m->PWM_R) ? m->PWM_R : m->PWM_A;
+		Tev[3] = (m->PWM_B < 0) ? 0 : (m->PWM_B > m->PWM_R) ? m->PWM_R : m->PWM_B;
+		Tev[4] = (m->PWM_C < 0) ? 0 : (m->PWM_C > m->PWM_R) ? m->PWM_R : m->PWM_C;
 
-	/* Get sorted events.
-	 * */
-	for (n = 0; n < 5; ++n) {
+		for (n = 0; n < 5; ++n)
+			pm[n] = n;
 
-		for (k = n + 1; k < 5; ++k) {
+		/* Get sorted events.
+		 * */
+		for (n = 0; n < 5; ++n) {
 
-			if (Tev[pm[n]] < Tev[pm[k]]) {
+			for (k = n + 1; k < 5; ++k) {
 
-				tmp = pm[n];
-				pm[n] = pm[k];
-				pm[k] = tmp;
+				if (Tev[pm[n]] < Tev[pm[k]]) {
+
+					tmp = pm[n];
+					pm[n] = pm[k];
+					pm[k] = tmp;
+				}
 			}
 		}
-	}
 
-	/* Count Up.
-	 * */
-	blm_VSI_Sample(m, 0);
+		/* Count Up.
+		 * */
+		blm_VSI_Sample(m, 0);
 
-	tmp = m->PWM_R;
+		tmp = m->PWM_R;
 
-	for (n = 0; n < 5; ++n) {
+		for (n = 0; n < 5; ++n) {
 
-		dT = tTIM * (tmp - Tev[pm[n]]);
-		blm_Solve_Split(m, dT);
+			dT = tTIM * (tmp - Tev[pm[n]]);
+			blm_Solve_Split(m, dT);
+
+			if (pm[n] < 2) {
 
-		if (pm[n] < 2) {
+				blm_VSI_Sample(m, pm[n] + 1);
+			}
+			else {
+				m->VSI[pm[n] - 2] = 1;
+				m->surge_I = pm[n];
+
+				blm_VSI_Loss(m, pm[n] - 2);
+			}
 
-			blm_VSI_Sample(m, pm[n] + 1);
+			tmp = Tev[pm[n]];
 		}
-		else {
-			m->VSI[pm[n] - 2] = 1;
-			m->surge_I = pm[n];
+
+		dT = tTIM * (Tev[pm[4]]);
+		blm_Solve_Split(m, dT);
+
+		if (m->DUAL != 0) {
+
+			/* Stop at the valley to let the controller update
+			 * the duty cycle.
+			 * */
+			m->sH = 1;
+			return ;
 		}
+	}
+	else {
+		/* Sample the currents at the valley.
+		 * */
+		blm_VSI_Sample(m, 0);
 
-		tmp = Tev[pm[n]];
+		m->sH = 0;
 	}
 
-	dT = tTIM * (Tev[pm[4]]);
-	blm_Solve_Split(m, dT);
+	/* FETs switching.
+	 * */
+	Tev[2] = (m->PWM_A < 0) ? 0 : (m->PWM_A > m->PWM_R) ? m->PWM_R : m->PWM_A;
+	Tev[3] = (m->PWM_B < 0) ? 0 : (m->PWM_B > m->PWM_R) ? m->PWM_R : m->PWM_B;
+	Tev[4] = (m->PWM_C < 0) ? 0 : (m->PWM_C > m->PWM_R) ? m->PWM_R : m->PWM_C;
 
-	/* Keep only three of them.
+	for (n = 0; n < 3; ++n)
+		pm[n] = n + 2;
+
+	/* Get sorted events.
 	 * */
-	for (n = 0, k = 0; n < 5; ++n) {
+	for (n = 0; n < 3; ++n) {
 
-		tmp = pm[n];
+		for (k = n + 1; k < 3; ++k) {
 
-		if (tmp != 0 && tmp != 1) {
+			if (Tev[pm[n]] < Tev[pm[k]]) {
 
-			pm[k++] = tmp;
+				tmp = pm[n];
+				pm[n] = pm[k];
+				pm[k] = tmp;
+			}
 		}
 	}
 
@@ -489,6 +570,8 @@ blm_VSI_Solve(blm_t *m)
 		m->VSI[pm[n] - 2] = 0;
 		m->surge_I = pm[n];
 
+		blm_VSI_Loss(m, pm[n] - 2);
+
 		tmp = Tev[pm[n]];
 	}
 
@@ -504,6 +587,6 @@ blm_VSI_Solve(blm_t *m)
 void blm_Update(blm_t *m)
 {
 	blm_VSI_Solve(m);
-	m->Tsim += m->dT;
+	m->Tsim += (m->DUAL != 0) ? m->dT / 2. : m->dT;
 }
 
@@ -17,11 +17,20 @@ typedef struct {
 	 * */
 	int		HI_Z;
 
+	/* Double update at the valley (INPUT).
+	 * */
+	int		DUAL;
+
+	/* External shaft torque (INPUT).
+	 * */
+	double		Mext;
+
 	/* State variabes.
 	 * */
 	double		X[14];
 	int		VSI[3];
 	int		surge_I;
+	int		sH;
 
 	/* Cycle Power.
 	 * */
@@ -46,16 +55,22 @@ typedef struct {
 	double		Rs;
 	double		Cb;
 
+	/* Power stage constants.
+	 * */
+	double		Tsw;
+	double		Coss;
+
 	/* Mechanical constants.
 	 * */
 	double		J;
-	double		M[3];
+	double		M[4];
 
 	/* Sensor constants.
 	 * */
 	double		T_ADC;
 	double		tau_I;
 	double		tau_U;
+	double		bias_I[2];
 
 	/* Hall Sensors.
 	 * */
@@ -0,0 +1,238 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "canbus.h"
+
+void canbus_init(canbus_t *bus, double bitrate)
+{
+	memset(bus, 0, sizeof(canbus_t));
+
+	bus->bitrate = bitrate;
+}
+
+int canbus_attach(canbus_t *bus, void (* proc_recv) (void *, const can_msg_t *),
+		void *link)
+{
+	canbus_port_t		*port;
+
+	if (bus->port_N >= CANBUS_PORT_MAX)
+		return -1;
+
+	port = &bus->port[bus->port_N];
+
+	port->proc_recv = proc_recv;
+	port->link = link;
+
+	return bus->port_N++;
+}
+
+int canbus_send(canbus_t *bus, int port, const can_msg_t *msg, int N)
+{
+	canbus_port_t		*p = &bus->port[port];
+	int			j;
+
+	if (p->head - p->tail + N > CANBUS_QUEUE_SZ) {
+
+		/* Burst is dropped as a whole as firmware does.
+		 * */
+		p->drop_N += N;
+
+		return -1;
+	}
+
+	for (j = 0; j < N; ++j) {
+
+		p->queue[p->head % CANBUS_QUEUE_SZ].msg = msg[j];
+		p->queue[p->head % CANBUS_QUEUE_SZ].tQ = bus->Tnow;
+		p->head++;
+	}
+
+	return 0;
+}
+
+static int
+canbus_stuff(int *run, int *last, int bit)
+{
+	int		stuff = 0;
+
+	if (bit == *last) {
+
+		*run += 1;
+	}
+	else {
+		*last = bit;
+		*run = 1;
+	}
+
+	if (*run == 5) {
+
+		/* Stuff bit of the opposite value begins the new run.
+		 * */
+		*last = ! bit;
+		*run = 1;
+
+		stuff = 1;
+	}
+
+	return stuff;
+}
+
+int canbus_bits(const can_msg_t *msg)
+{
+	int		bits[19 + 64 + 15], N = 0;
+	int		j, len, crc = 0, nxt, run = 0, last = -1, stuff = 0;
+
+	/* SOF, ID, RTR, IDE, r0, DLC, DATA.
+	 * */
+	bits[N++] = 0;
+
+	for (j = 10; j >= 0; --j)
+		bits[N++] = (int) (msg->ID >> j) & 1;
+
+	bits[N++] = 0;
+	bits[N++] = 0;
+	bits[N++] = 0;
+
+	for (j = 3; j >= 0; --j)
+		bits[N++] = (msg->len >> j) & 1;
+
+	/* DLC of 9 to 15 is valid and means 8 bytes.
+	 * */
+	len = (msg->len > 8) ? 8 : msg->len;
+
+	for (j = 0; j < len * 8; ++j)
+		bits[N++] = (msg->payload[j / 8] >> (7 - j % 8)) & 1;
+
+	/* CRC-15.
+	 * */
+	for (j = 0; j < N; ++j) {
+
+		nxt = bits[j] ^ ((crc >> 14) & 1);
+		crc = (crc << 1) & 0x7FFF;
+		crc ^= (nxt != 0) ? 0x4599 : 0;
+	}
+
+	for (j = 14; j >= 0; --j)
+		bits[N++] = (crc >> j) & 1;
+
+	for (j = 0; j < N; ++j)
+		stuff += canbus_stuff(&run, &last, bits[j]);
+
+	/* CRC delimiter, ACK, EOF and interframe space.
+	 * */
+	return N + stuff + 1 + 2 + 7 + 3;
+}
+
+static void
+canbus_deliver(canbus_t *bus)
+{
+	canbus_port_t		*p = &bus->port[bus->fly_port];
+	double			lat;
+	int			j;
+
+	lat = bus->Tbus - bus->fly.tQ;
+
+	p->tx_N++;
+	p->lat_sum += lat;
+	p->lat_max = (lat > p->lat_max) ? lat : p->lat_max;
+
+	bus->busy = 0;
+	bus->Tnow = bus->Tbus;
+
+	/* Receiver sees 8 bytes for DLC above 8.
+	 * */
+	bus->fly.msg.len = (bus->fly.msg.len > 8) ? 8 : bus->fly.msg.len;
+
+	for (j = 0; j < bus->port_N; ++j) {
+
+		if (j != bus->fly_port && bus->port[j].proc_recv != NULL)
+			bus->port[j].proc_recv(bus->port[j].link, &bus->fly.msg);
+	}
+}
+
+static int
+canbus_arbitrate(canbus_t *bus, double Tsim)
+{
+	canbus_port_t		*p;
+	canbus_frame_t		*f;
+	double			tS = 0.;
+	int			j, win = -1, bits;
+
+	/* Bus is taken at the time the first frame is ready.
+	 * */
+	for (j = 0; j < bus->port_N; ++j) {
+
+		p = &bus->port[j];
+
+		if (p->head != p->tail) {
+
+			f = &p->queue[p->tail % CANBUS_QUEUE_SZ];
+
+			if (win < 0 || f->tQ < tS)
+				tS = f->tQ;
+
+			win = j;
+		}
+	}
+
+	if (win < 0)
+		return 0;
+
+	tS = (tS > bus->Tbus) ? tS : bus->Tbus;
+
+	if (tS > Tsim)
+		return 0;
+
+	/* Lowest ID of the ready frames wins.
+	 * */
+	win = -1;
+
+	for (j = 0; j < bus->port_N; ++j) {
+
+		p = &bus->port[j];
+		f = &p->queue[p->tail % CANBUS_QUEUE_SZ];
+
+		if (p->head != p->tail && f->tQ <= tS) {
+
+			if (win < 0 || f->msg.ID < bus->fly.msg.ID) {
+
+				bus->fly = *f;
+				win = j;
+			}
+		}
+	}
+
+	bus->port[win].tail++;
+	bus->fly_port = win;
+
+	bits = canbus_bits(&bus->fly.msg);
+
+	bus->Tbus = tS + bits / bus->bitrate;
+	bus->busy = 1;
+
+	bus->frame_N++;
+	bus->bit_N += bits;
+	bus->busy_T += bits / bus->bitrate;
+
+	return 1;
+}
+
+void canbus_update(canbus_t *bus, double Tsim)
+{
+	do {
+		if (bus->busy != 0) {
+
+			if (bus->Tbus > Tsim)
+				break;
+
+			canbus_deliver(bus);
+		}
+
+		if (canbus_arbitrate(bus, Tsim) == 0)
+			break;
+	}
+	while (1);
+
+	bus->Tnow = Tsim;
+}
+
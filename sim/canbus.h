@@ -0,0 +1,69 @@
+#ifndef _H_CANBUS_
+#define _H_CANBUS_
+
+#include "../src/canring.h"
+
+#define CANBUS_PORT_MAX		16
+#define CANBUS_QUEUE_SZ		64
+
+/* Virtual CAN bus. Each port has TX queue that is sent in order. When the
+ * bus is idle the port with the lowest ID at the queue head wins the
+ * arbitration. Frame takes the time of its bits (with stuffing) and is
+ * delivered to all other ports at the end of transmission.
+ * */
+
+typedef struct {
+
+	can_msg_t	msg;
+	double		tQ;
+}
+canbus_frame_t;
+
+typedef struct {
+
+	canbus_frame_t	queue[CANBUS_QUEUE_SZ];
+	int		head;
+	int		tail;
+
+	void		(* proc_recv) (void *link, const can_msg_t *msg);
+	void		*link;
+
+	int		tx_N;
+	int		drop_N;
+
+	double		lat_sum;
+	double		lat_max;
+}
+canbus_port_t;
+
+typedef struct {
+
+	double		bitrate;
+
+	double		Tnow;
+	double		Tbus;
+	int		busy;
+
+	canbus_frame_t	fly;
+	int		fly_port;
+
+	int		port_N;
+	canbus_port_t	port[CANBUS_PORT_MAX];
+
+	int		frame_N;
+	double		bit_N;
+	double		busy_T;
+}
+canbus_t;
+
+void canbus_init(canbus_t *bus, double bitrate);
+int canbus_attach(canbus_t *bus, void (* proc_recv) (void *, const can_msg_t *),
+		void *link);
+
+int canbus_send(canbus_t *bus, int port, const can_msg_t *msg, int N);
+void canbus_update(canbus_t *bus, double Tsim);
+
+int canbus_bits(const can_msg_t *msg);
+
+#endif /* _H_CANBUS_ */
+
@@ -0,0 +1 @@
+#include "../src/crc32.c"
@@ -0,0 +1,184 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/crc32.h"
+
+/* Host test of the table CRC used by firmware. We check that blocks written
+ * with the legacy bit-serial CRC still validate and measure the time of
+ * config scan over all flash sectors.
+ * */
+
+#define CRC_BLOCK_SZ		4096
+#define CRC_BLOCK_N		128
+#define CRC_BENCH_N		20
+
+static unsigned int	rseed = 1;
+
+volatile unsigned long	crc_sink;
+
+static unsigned int
+crc_rand()
+{
+	rseed = rseed * 1103515245U + 12345U;
+
+	return rseed >> 16;
+}
+
+static unsigned long
+crc_legacy(const void *s, int n)
+{
+	const unsigned char	*xs = (const unsigned char *) s;
+	unsigned long		crc, m;
+	int			j;
+
+	crc = 0xFFFFFFFFUL;
+
+	while (n >= 1) {
+
+		crc = crc ^ *xs++;
+		n--;
+
+		for (j = 7; j >= 0; j--) {
+
+			m = -(crc & 1UL);
+			crc = ((crc >> 1) ^ (0xEDB88320UL & m)) & 0xFFFFFFFFUL;
+		}
+	}
+
+	return ~crc & 0xFFFFFFFFUL;
+}
+
+static void
+crc_block_fill(unsigned int *block, int number)
+{
+	int		j;
+
+	/* Same layout as flash_block_t with CRC in the last word.
+	 * */
+	block[0] = number;
+	block[1] = 61;
+
+	for (j = 2; j < CRC_BLOCK_SZ / 4 - 1; ++j)
+		block[j] = crc_rand() | (crc_rand() << 16);
+
+	block[CRC_BLOCK_SZ / 4 - 1] = crc_legacy(block, CRC_BLOCK_SZ - 4);
+}
+
+static int
+crc_scan(unsigned long (* crc) (const void *, int), unsigned int *map)
+{
+	unsigned int	*block;
+	int		j, N = 0;
+
+	for (j = 0; j < CRC_BLOCK_N; ++j) {
+
+		block = map + j * (CRC_BLOCK_SZ / 4);
+
+		if (crc(block, CRC_BLOCK_SZ - 4) == block[CRC_BLOCK_SZ / 4 - 1])
+			N++;
+	}
+
+	return N;
+}
+
+static double
+crc_clock()
+{
+	struct timespec		ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1E+9 + ts.tv_nsec;
+}
+
+static void
+crc_bench(const char *name, unsigned long (* crc) (const void *, int),
+		unsigned int *map)
+{
+	double			tS;
+	int			j;
+
+	tS = crc_clock();
+
+	for (j = 0; j < CRC_BENCH_N; ++j)
+		crc_sink = crc_scan(crc, map);
+
+	tS = (crc_clock() - tS) / CRC_BENCH_N;
+
+	printf("crctest: %-10s %i blocks %.1f (us)\n", name, CRC_BLOCK_N, tS / 1E+3);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned char	buf[300 + 4];
+	unsigned int	*map;
+	int		j, k, n, fail = 0;
+
+	if (crc32b("123456789", 9) != 0xCBF43926UL) {
+
+		printf("crctest: check value %08lX\n", crc32b("123456789", 9));
+		fail = 1;
+	}
+
+	/* All lengths at all alignments.
+	 * */
+	for (j = 0; j < sizeof(buf); ++j)
+		buf[j] = crc_rand();
+
+	for (k = 0; k < 4 && fail == 0; ++k) {
+
+		for (n = 0; n <= 300 && fail == 0; ++n) {
+
+			if (crc32b(buf + k, n) != crc_legacy(buf + k, n)) {
+
+				printf("crctest: offset %i length %i\n", k, n);
+				fail = 1;
+			}
+		}
+	}
+
+	/* Blocks written by the legacy code must validate and any single bit
+	 * error must be caught.
+	 * */
+	map = malloc(CRC_BLOCK_N * CRC_BLOCK_SZ);
+
+	for (j = 0; j < CRC_BLOCK_N; ++j)
+		crc_block_fill(map + j * (CRC_BLOCK_SZ / 4), j);
+
+	if (crc_scan(&crc32b, map) != CRC_BLOCK_N) {
+
+		printf("crctest: legacy blocks do not validate\n");
+		fail = 1;
+	}
+
+	for (j = 0; j < 1000 && fail == 0; ++j) {
+
+		k = crc_rand() % CRC_BLOCK_SZ;
+		n = 1 << (crc_rand() % 8);
+
+		((unsigned char *) map)[k] ^= n;
+
+		if (crc_scan(&crc32b, map) != CRC_BLOCK_N - 1) {
+
+			printf("crctest: bit error at %i not detected\n", k);
+			fail = 1;
+		}
+
+		((unsigned char *) map)[k] ^= n;
+	}
+
+	printf("crctest: %s\n", (fail == 0) ? "OK" : "FAIL");
+
+	if (argc == 2 && strcmp(argv[1], "-b") == 0) {
+
+		crc_bench("crc32b", &crc32b, map);
+		crc_bench("legacy", &crc_legacy, map);
+	}
+
+	free(map);
+
+	return fail;
+}
+
@@ -0,0 +1,17 @@
+/* Build the config storage of firmware against the fake flash and register
+ * table of flashtest. Shell output goes through the flashtest functions.
+ * */
+#define regfile		flash_regfile
+#define printf		flash_printf
+#define puts		flash_puts
+
+#include "../src/flash.c"
+
+pmc_t			pm;
+
+extern void flash_putc(int c);
+
+static io_ops_t		flash_io = { NULL, &flash_putc, NULL };
+
+io_ops_t		*iodef = &flash_io;
+
@@ -0,0 +1,484 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "../src/crc32.h"
+#include "../src/regfile.h"
+
+/* Host test of the config storage. Firmware code runs on RAM backed fake
+ * flash that behaves as real one (erase sets all bits, write only clears
+ * them). Pages of unused flash are made inaccessible to check that saves and
+ * flash_info_map do not touch them. Firmware update is simulated by moving
+ * register names to other IDs in the register table.
+ * */
+
+#define FLASH_SECTOR_MAX	4
+#define FLASH_SECTOR_SZ		0x20000UL
+#define FLASH_PAGE_SZ		4096UL
+
+#define FLASH_RANDOM_N		20000
+
+typedef struct {
+
+	unsigned long		number;
+	unsigned long		version;
+	unsigned long		content[1021];
+	unsigned long		crc32;
+}
+flash_block_t;
+
+typedef struct {
+
+	unsigned long		magic;
+	unsigned long		version;
+	unsigned long		number;
+	unsigned long		crc32;
+}
+flash_head_t;
+
+static unsigned char	flash_mem[FLASH_SECTOR_MAX * FLASH_SECTOR_SZ]
+				__attribute__ ((aligned (FLASH_PAGE_SZ)));
+
+const unsigned long	flash_ram_map[] = {
+
+	(unsigned long) flash_mem,
+	(unsigned long) flash_mem + FLASH_SECTOR_SZ,
+	(unsigned long) flash_mem + FLASH_SECTOR_SZ * 2,
+	(unsigned long) flash_mem + FLASH_SECTOR_SZ * 3,
+	(unsigned long) flash_mem + FLASH_SECTOR_SZ * 4
+};
+
+reg_t			flash_regfile[REG_ID_MAX + 1];
+
+static char		name[REG_ID_MAX][16];
+
+static unsigned long	value[REG_ID_MAX];
+static unsigned long	saved[REG_ID_MAX];
+
+static int		erase_N, write_N;
+
+static char		text[4096];
+static int		text_N;
+
+static unsigned int	rseed = 1;
+
+extern int flash_block_load();
+extern int flash_block_migrate();
+extern void flash_write(const char *s);
+extern void flash_info_map(const char *s);
+extern void flash_cleanup(const char *s);
+
+void *FLASH_sector_erase(void *flash)
+{
+	int		N;
+
+	for (N = 0; N < FLASH_SECTOR_MAX; ++N) {
+
+		if (		(unsigned long) flash >= flash_ram_map[N]
+				&& (unsigned long) flash < flash_ram_map[N + 1]) {
+
+			flash = (void *) flash_ram_map[N];
+			memset(flash, 0xFF, FLASH_SECTOR_SZ);
+
+			erase_N++;
+			break;
+		}
+	}
+
+	return flash;
+}
+
+void *FLASH_write(void *flash, const void *s, unsigned long sz)
+{
+	unsigned char		*xd = flash;
+	const unsigned char	*xs = s;
+
+	write_N += sz;
+
+	while (sz >= 1) {
+
+		*xd++ &= *xs++;
+		sz--;
+	}
+
+	return flash;
+}
+
+void *pvPortMalloc(size_t sz) { return malloc(sz); }
+void vPortFree(void *p) { free(p); }
+
+void flash_putc(int c)
+{
+	if (text_N < sizeof(text) - 1) {
+
+		text[text_N++] = (char) c;
+		text[text_N] = 0;
+	}
+}
+
+void flash_puts(const char *s)
+{
+	while (*s) flash_putc(*s++);
+}
+
+void flash_printf(const char *fmt, ...)
+{
+	char		s[200];
+	va_list		ap;
+
+	va_start(ap, fmt);
+	vsnprintf(s, sizeof(s), fmt, ap);
+	va_end(ap);
+
+	flash_puts(s);
+}
+
+static unsigned int
+flash_rand()
+{
+	rseed = rseed * 1103515245U + 12345U;
+
+	return rseed >> 16;
+}
+
+static void
+flash_regfile_init()
+{
+	int		ID;
+
+	for (ID = 0; ID < REG_ID_MAX; ++ID) {
+
+		sprintf(name[ID], "reg_%i", ID);
+
+		flash_regfile[ID].sym = name[ID];
+		flash_regfile[ID].mode = (ID % 3 == 1) ? REG_CONFIG : 0;
+		flash_regfile[ID].link = (reg_val_t *) &value[ID];
+
+		value[ID] = ID;
+	}
+}
+
+static int
+flash_reboot()
+{
+	int		ID, rc;
+
+	for (ID = 0; ID < REG_ID_MAX; ++ID) {
+
+		saved[ID] = value[ID];
+		value[ID] = 0xDEADBEEFUL;
+	}
+
+	rc = flash_block_load();
+
+	return rc;
+}
+
+static int
+flash_check(const char *name)
+{
+	int		ID, N = 0;
+
+	for (ID = 0; ID < REG_ID_MAX; ++ID) {
+
+		if (		(flash_regfile[ID].mode & REG_CONFIG)
+				&& value[ID] != saved[ID]) {
+
+			N++;
+		}
+	}
+
+	if (N != 0)
+		printf("flashtest: %s %i values lost\n", name, N);
+
+	return (N == 0) ? 1 : 0;
+}
+
+static void
+flash_legacy_block(int sector_N, int block_N)
+{
+	flash_block_t	*block;
+	unsigned long	*content;
+	int		ID;
+
+	block = (flash_block_t *) flash_ram_map[sector_N] + block_N;
+	content = block->content;
+
+	block->number = 7;
+	block->version = REG_CONFIG_VERSION;
+
+	for (ID = 0; ID < REG_ID_MAX; ++ID) {
+
+		if (flash_regfile[ID].mode & REG_CONFIG)
+			*content++ = ID * 100;
+	}
+
+	block->crc32 = crc32b(block, offsetof(flash_block_t, crc32));
+}
+
+static void
+flash_legacy_v54(int sector_N, int block_N)
+{
+	flash_block_t	*block;
+	int		N;
+
+	block = (flash_block_t *) flash_ram_map[sector_N] + block_N;
+
+	block->number = 9;
+	block->version = 54;
+
+	/* There were 176 config registers, ap.ppm_reg_ID is linked to
+	 * pm.s_setpoint_pc by its ID and the last one is out of range.
+	 * */
+	for (N = 0; N < 176; ++N)
+		block->content[N] = 5000 + N;
+
+	block->content[12] = 256;
+
+	block->crc32 = crc32b(block, offsetof(flash_block_t, crc32));
+}
+
+static int
+flash_sector_of(const void *flash)
+{
+	return (int) (((unsigned long) flash - flash_ram_map[0]) / FLASH_SECTOR_SZ);
+}
+
+static void
+flash_update(int shift)
+{
+	flash_head_t	*head, *last = NULL;
+	int		N, ID;
+
+	/* New firmware has other config version and register IDs.
+	 * */
+	for (N = 0; N < FLASH_SECTOR_MAX; ++N) {
+
+		head = (flash_head_t *) flash_ram_map[N];
+
+		if (		head->magic != ~0UL
+				&& crc32b(head, offsetof(flash_head_t, crc32)) == head->crc32
+				&& (last == NULL || head->number > last->number))
+			last = head;
+	}
+
+	head = FLASH_sector_erase((void *) flash_ram_map[(flash_sector_of(last)
+				+ 1) % FLASH_SECTOR_MAX]);
+
+	memcpy(head, last, FLASH_SECTOR_SZ);
+
+	head->version = REG_CONFIG_VERSION - 1;
+	head->number = last->number + 1;
+	head->crc32 = crc32b(head, offsetof(flash_head_t, crc32));
+
+	for (ID = 0; ID < REG_ID_MAX; ++ID) {
+
+		N = (ID + REG_ID_MAX - shift) % REG_ID_MAX;
+
+		flash_regfile[ID].sym = name[N];
+		flash_regfile[ID].mode = (N % 3 == 1) ? REG_CONFIG : 0;
+	}
+}
+
+static void
+flash_protect(int prot, unsigned long from)
+{
+	from = (from + FLASH_PAGE_SZ - 1) & ~(FLASH_PAGE_SZ - 1);
+
+	if (from < flash_ram_map[FLASH_SECTOR_MAX]) {
+
+		mprotect((void *) from, flash_ram_map[FLASH_SECTOR_MAX] - from, prot);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned char	*tail;
+	int		j, ID, N, fail = 0;
+
+	memset(flash_mem, 0xFF, sizeof(flash_mem));
+
+	flash_regfile_init();
+
+	/* Legacy full block is loaded and converted on the first save.
+	 * */
+	flash_legacy_block(2, 3);
+
+	fail |= (flash_reboot() != 0);
+
+	for (ID = 0; ID < REG_ID_MAX; ++ID) {
+
+		if (flash_regfile[ID].mode & REG_CONFIG)
+			fail |= (value[ID] != ID * 100UL);
+		else
+			value[ID] = saved[ID];
+	}
+
+	flash_write("");
+	fail |= (erase_N != 1);
+
+	fail |= (flash_reboot() != 0);
+	fail |= (flash_check("legacy") == 0);
+
+	/* Only changed registers are written.
+	 * */
+	value[4] = 1000;
+	value[7] = 2000;
+
+	write_N = 0;
+	flash_write("");
+
+	fail |= (erase_N != 1 || write_N != 2 * 3 * sizeof(unsigned long));
+
+	/* Sectors 0 and 1 are never used while the journal is in sector 3
+	 * behind the legacy block, the space after the journal tail as well.
+	 * */
+	tail = flash_mem + FLASH_SECTOR_SZ * 3 + 2 * FLASH_PAGE_SZ;
+
+	flash_protect(PROT_NONE, (unsigned long) tail);
+	mprotect(flash_mem, FLASH_SECTOR_SZ * 2, PROT_NONE);
+
+	value[10] = 3000;
+
+	text_N = 0;
+	flash_write("");
+	flash_info_map("");
+
+	mprotect(flash_mem, sizeof(flash_mem), PROT_READ | PROT_WRITE);
+
+	if (		strstr(text, "Done") == NULL
+			|| strstr(text, "...a..") == NULL
+			|| strstr(text, "J...") == NULL) {
+
+		printf("flashtest: map\n%s", text);
+		fail = 1;
+	}
+
+	fail |= (flash_reboot() != 0);
+	fail |= (flash_check("append") == 0);
+
+	/* Damaged record is skipped and the previous value is kept.
+	 * */
+	value[13] = 4000;
+	flash_write("");
+
+	flash_reboot();
+
+	for (j = sizeof(flash_mem) / sizeof(unsigned long) - 1; j >= 0; --j) {
+
+		if (((unsigned long *) flash_mem)[j] == 4000UL) {
+
+			FLASH_write((unsigned long *) flash_mem + j, &(unsigned long) { 3968UL },
+					sizeof(unsigned long));
+			break;
+		}
+	}
+
+	value[13] = 13 * 100;
+	fail |= (flash_reboot() != 0);
+	fail |= (flash_check("damaged") == 0);
+
+	/* Random saves to go through the compaction many times.
+	 * */
+	for (j = 0; j < FLASH_RANDOM_N && fail == 0; ++j) {
+
+		ID = 3 * (flash_rand() % (REG_ID_MAX / 3)) + 1;
+		value[ID] = flash_rand();
+
+		flash_write("");
+
+		if (flash_rand() % 1000 == 0) {
+
+			fail |= (flash_reboot() != 0);
+			fail |= (flash_check("random") == 0);
+		}
+	}
+
+	fail |= (flash_reboot() != 0);
+	fail |= (flash_check("random") == 0);
+
+	/* Linked register keeps the name of target.
+	 * */
+	flash_regfile[4].mode |= REG_LINKED;
+	value[4] = 100;
+
+	flash_write("");
+
+	fail |= (flash_reboot() != 0);
+	fail |= (flash_check("linked") == 0);
+
+	/* Values follow the names after update, the journal is rewritten
+	 * at the next save.
+	 * */
+	flash_update(3);
+	flash_regfile[4].mode &= ~REG_LINKED;
+	flash_regfile[7].mode |= REG_LINKED;
+
+	fail |= (flash_reboot() != 1);
+
+	for (ID = 0; ID < REG_ID_MAX; ++ID)
+		value[ID] = 7;
+
+	fail |= (flash_block_migrate() != 0);
+
+	for (ID = 0; ID < REG_ID_MAX; ++ID) {
+
+		j = (ID + REG_ID_MAX - 3) % REG_ID_MAX;
+
+		if (flash_regfile[ID].mode & REG_CONFIG)
+			fail |= (value[ID] != ((ID == 7) ? 103 : saved[j]));
+	}
+
+	N = erase_N;
+	flash_write("");
+
+	fail |= (erase_N != N + 1);
+	fail |= (flash_reboot() != 0);
+	fail |= (flash_check("update") == 0);
+
+	printf("flashtest: %i saves %i erases\n", FLASH_RANDOM_N, erase_N);
+
+	flash_cleanup("");
+	fail |= (flash_reboot() == 0);
+
+	/* Block of config version 54 is read by the frozen register names
+	 * over the defaults.
+	 * */
+	memset(flash_mem, 0xFF, sizeof(flash_mem));
+
+	flash_regfile_init();
+	flash_legacy_v54(1, 0);
+
+	flash_regfile[1].sym = "hal.USART_baud_rate";
+	flash_regfile[2].sym = "pm.s_setpoint_pc";
+	flash_regfile[4].sym = "pm.const_E";
+	flash_regfile[7].sym = "ap.ppm_reg_ID";
+	flash_regfile[10].sym = "ti.reg_ID[9]";
+
+	flash_regfile[7].mode |= REG_LINKED;
+	flash_regfile[10].mode |= REG_LINKED;
+
+	fail |= (flash_reboot() != 1);
+
+	for (ID = 0; ID < REG_ID_MAX; ++ID)
+		value[ID] = 7;
+
+	fail |= (flash_block_migrate() != 0);
+
+	fail |= (value[1] != 5000 || value[4] != 5129);
+	fail |= (value[7] != 2 || value[10] != ID_NULL);
+	fail |= (value[13] != 7);
+
+	flash_write("");
+
+	fail |= (flash_reboot() != 0);
+	fail |= (flash_check("v54") == 0);
+
+	printf("flashtest: %s\n", (fail == 0) ? "OK" : "FAIL");
+
+	return fail;
+}
+
@@ -0,0 +1,301 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "../src/ftoa.h"
+
+/* Host test of the float formatting used by printf in firmware. We compare
+ * the output against C library for all formats registers are printed with
+ * and measure the time per conversion against the legacy float loop.
+ * */
+
+#define FMT_RANDOM_N		500000
+#define FMT_BENCH_N		1000000
+
+static const struct {
+
+	int		conv;
+	int		n;
+}
+fmt_list[] = {
+
+	{ 'f', 1 }, { 'f', 2 }, { 'f', 3 }, { 'f', 4 }, { 'f', 5 },
+	{ 'e', 2 }, { 'e', 4 }, { 'e', 5 }, { 'e', 8 }
+};
+
+#define FMT_LIST_N		(sizeof(fmt_list) / sizeof(fmt_list[0]))
+
+static unsigned int	rseed = 1;
+
+volatile char		fmt_sink;
+
+static unsigned int
+fmt_rand()
+{
+	rseed = rseed * 1103515245U + 12345U;
+
+	return (rseed >> 16) | ((rseed * 1103515245U + 12345U) & 0xFFFF0000U);
+}
+
+static float
+fmt_bits(unsigned int i)
+{
+	union {
+		float		f;
+		unsigned int	i;
+	}
+	u = { .i = i };
+
+	return u.f;
+}
+
+static void
+fmt_ref(char *s, int conv, float x, int n)
+{
+	char		t[80], *e;
+
+	if (conv == 'f') {
+
+		if (fabsf(x) >= 2147483648.f)
+			strcpy(t, (x < 0.f) ? "-MAX" : "MAX");
+		else
+			sprintf(t, "%.*f", n, (double) x);
+
+		strcpy(s, t);
+	}
+	else {
+		/* Convert "1.2500e-05" into "1.2500E-5".
+		 * */
+		sprintf(t, "%.*e", n, (double) x);
+
+		e = strchr(t, 'e');
+		*e = 0;
+
+		sprintf(s, "%sE%c%i", t, e[1], abs(atoi(e + 2)));
+	}
+}
+
+static int
+fmt_check(float x)
+{
+	char		s[FTOA_STRING_MAX], r[80];
+	int		j;
+
+	if (isfinite(x) == 0)
+		return 1;
+
+	for (j = 0; j < FMT_LIST_N; ++j) {
+
+		if (fmt_list[j].conv == 'f')
+			ftoa_fixed(s, x, fmt_list[j].n);
+		else
+			ftoa_fexp(s, x, fmt_list[j].n);
+
+		fmt_ref(r, fmt_list[j].conv, x, fmt_list[j].n);
+
+		if (strcmp(s, r) != 0) {
+
+			printf("fmttest: %.9e %%%i%c \"%s\" != \"%s\"\n", (double) x,
+					fmt_list[j].n, fmt_list[j].conv, s, r);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static void
+fmt_legacy_fixed(char *s, float x, int n)
+{
+	int		i;
+	float		h;
+
+	if (x < 0.f) {
+
+		*s++ = '-';
+		x = - x;
+	}
+
+	h = .5f;
+	for (i = 0; i < n; ++i)
+		h /= 10.f;
+
+	x += h;
+
+	s += sprintf(s, "%i", (int) x);
+	x -= (int) x;
+
+	*s++ = '.';
+
+	while (n > 0) {
+
+		x *= 10.f;
+		i = (int) x;
+		x -= i;
+
+		*s++ = '0' + i;
+		n--;
+	}
+
+	*s = 0;
+}
+
+static void
+fmt_legacy_fexp(char *s, float x, int n)
+{
+	int		i, e = 0;
+	float		h;
+
+	if (x < 0.f) {
+
+		*s++ = '-';
+		x = - x;
+	}
+
+	do {
+		if (x > 0.f && x < 1.f) {
+
+			x *= 10.f;
+			e--;
+		}
+		else if (x >= 10.f) {
+
+			x /= 10.f;
+			e++;
+		}
+		else
+			break;
+	}
+	while (1);
+
+	h = .5f;
+	for (i = 0; i < n; ++i)
+		h /= 10.f;
+
+	x += h;
+
+	if (x >= 10.f) {
+
+		x /= 10.f;
+		e++;
+	}
+
+	i = (int) x;
+	x -= i;
+
+	*s++ = '0' + i;
+	*s++ = '.';
+
+	while (n > 0) {
+
+		x *= 10.f;
+		i = (int) x;
+		x -= i;
+
+		*s++ = '0' + i;
+		n--;
+	}
+
+	sprintf(s, "E%c%i", (e < 0) ? '-' : '+', abs(e));
+}
+
+static double
+fmt_clock()
+{
+	struct timespec		ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1E+9 + ts.tv_nsec;
+}
+
+static void
+fmt_bench(const char *name, void (* fmt) (char *, float, int), int n)
+{
+	char			s[80];
+	double			tS;
+	int			j;
+
+	rseed = 7;
+	tS = fmt_clock();
+
+	for (j = 0; j < FMT_BENCH_N; ++j) {
+
+		fmt(s, fmt_bits((fmt_rand() & 0x0FFFFFFFU) | 0x38000000U), n);
+		fmt_sink = s[0];
+	}
+
+	tS = (fmt_clock() - tS) / FMT_BENCH_N;
+
+	printf("fmttest: %-14s %%%i %.1f (ns)\n", name, n, tS);
+}
+
+static void
+fmt_ftoa_fixed(char *s, float x, int n) { ftoa_fixed(s, x, n); }
+
+static void
+fmt_ftoa_fexp(char *s, float x, int n) { ftoa_fexp(s, x, n); }
+
+static void
+fmt_libc_fixed(char *s, float x, int n) { sprintf(s, "%.*f", n, (double) x); }
+
+static void
+fmt_libc_fexp(char *s, float x, int n) { sprintf(s, "%.*e", n, (double) x); }
+
+int main(int argc, char *argv[])
+{
+	int		j, k, fail = 0;
+	float		x;
+
+	/* Exact halves at every digit position.
+	 * */
+	for (j = 0; j < 100000 && fail == 0; ++j) {
+
+		for (k = 0; k < 12 && fail == 0; ++k) {
+
+			x = (float) ((j + .5) * pow(10., - k));
+			fail |= (fmt_check(x) == 0);
+			fail |= (fmt_check(- x) == 0);
+
+			x = (float) (j * 2 + 1) / (float) (1 << (k + 1));
+			fail |= (fmt_check(x) == 0);
+		}
+	}
+
+	/* Integers, powers of two, denormals and random bit patterns.
+	 * */
+	for (j = 0; j < 280 && fail == 0; ++j) {
+
+		fail |= (fmt_check(ldexpf(1.f, j - 150)) == 0);
+		fail |= (fmt_check((float) j * 12500000.f) == 0);
+	}
+
+	for (j = 0; j < FMT_RANDOM_N && fail == 0; ++j)
+		fail |= (fmt_check(fmt_bits(fmt_rand())) == 0);
+
+	fail |= (fmt_check(0.f) == 0);
+
+	printf("fmttest: %s\n", (fail == 0) ? "OK" : "FAIL");
+
+	if (argc == 2 && strcmp(argv[1], "-b") == 0) {
+
+		for (k = 1; k <= 4; k += 3) {
+
+			fmt_bench("ftoa_fixed", &fmt_ftoa_fixed, k);
+			fmt_bench("legacy_fixed", &fmt_legacy_fixed, k);
+			fmt_bench("libc_fixed", &fmt_libc_fixed, k);
+		}
+
+		for (k = 2; k <= 4; k += 2) {
+
+			fmt_bench("ftoa_fexp", &fmt_ftoa_fexp, k);
+			fmt_bench("legacy_fexp", &fmt_legacy_fexp, k);
+			fmt_bench("libc_fexp", &fmt_libc_fexp, k);
+		}
+	}
+
+	return fail;
+}
+
@@ -0,0 +1,2 @@
+#include "../src/ftoa.c"
+
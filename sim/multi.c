@@ -0,0 +1,558 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "blm.h"
+#include "canbus.h"
+#include "lib.h"
+#include "pm.h"
+
+#include "../src/canproto.h"
+
+/* Co-simulation of several controllers with their motors. Each node is the
+ * pair of pmc_t and blm_t updated in lockstep. Shafts are joined to the
+ * common load through elastic couplings and controllers talk over the
+ * virtual CAN bus with the host port that plays the role of master. Node 1
+ * runs speed control and the others follow its current from the state
+ * broadcast so the load is shared.
+ * */
+
+#define MULTI_NODE_MAX		8
+#define MULTI_BITRATE		1E+6
+
+typedef struct {
+
+	blm_t		m;
+	pmc_t		pm;
+	canproto_t	cp;
+
+	int		port;
+
+	/* Mechanical shaft angle and coupling torque.
+	 * */
+	double		xM;
+	double		tau;
+}
+multi_node_t;
+
+static struct {
+
+	multi_node_t	node[MULTI_NODE_MAX];
+	int		N;
+
+	canbus_t	bus;
+	int		host;
+
+	double		Tsim;
+	double		dT;
+
+	/* Coupling and load constants.
+	 * */
+	double		K;
+	double		C;
+	double		JL;
+	double		ML[2];
+
+	/* Load state.
+	 * */
+	double		xL;
+	double		wL;
+	int		coupled;
+
+	/* Host view of the bus.
+	 * */
+	int		state_N;
+	float		lead_iQ;
+	float		lead_wS;
+}
+mu;
+
+static multi_node_t	*na;
+
+static void
+multiDC(int A, int B, int C)
+{
+	na->m.PWM_A = A;
+	na->m.PWM_B = B;
+	na->m.PWM_C = C;
+}
+
+static void
+multiZ(int Z)
+{
+	na->m.HI_Z = (Z == 7) ? 1 : 0;
+}
+
+static int
+multiFREQ(float F)
+{
+	double		K;
+
+	K = na->m.PWM_R / na->m.dT;
+
+	na->m.PWM_R = (int) (K / F + .5);
+	na->m.dT = na->m.PWM_R / K;
+
+	return na->m.PWM_R;
+}
+
+static void
+multi_node_send(void *link, const can_msg_t *msg, int N)
+{
+	multi_node_t	*n = (multi_node_t *) link;
+
+	canbus_send(&mu.bus, n->port, msg, N);
+}
+
+static void
+multi_node_recv(void *link, const can_msg_t *msg)
+{
+	multi_node_t	*n = (multi_node_t *) link;
+
+	canproto_input(&n->cp, msg);
+}
+
+static void
+multi_host_send(int func, int node, int len, const void *data)
+{
+	can_msg_t	msg;
+
+	msg.ID = CANPROTO_ID(func, node);
+	msg.len = len;
+
+	memcpy(msg.payload, data, len);
+
+	canbus_send(&mu.bus, mu.host, &msg, 1);
+}
+
+static void
+multi_host_recv(void *link, const can_msg_t *msg)
+{
+	int		j;
+
+	if (msg->ID == CANPROTO_ID(CANPROTO_STATE, 1)) {
+
+		memcpy(&mu.lead_iQ, msg->payload + 0, 4);
+		memcpy(&mu.lead_wS, msg->payload + 4, 4);
+
+		mu.state_N++;
+
+		/* Followers get the current of the lead node.
+		 * */
+		for (j = 1; j < mu.N; ++j)
+			multi_host_send(CANPROTO_CURRENT, j + 1, 4, &mu.lead_iQ);
+	}
+}
+
+static void
+multi_node_init(multi_node_t *n, int ID)
+{
+	blm_Enable(&n->m);
+
+	n->pm.freq_hz = (float) (1. / n->m.dT);
+	n->pm.dT = 1.f / n->pm.freq_hz;
+	n->pm.dc_resolution = n->m.PWM_R;
+	n->pm.proc_set_DC = &multiDC;
+	n->pm.proc_set_Z = &multiZ;
+	n->pm.proc_set_FREQ = &multiFREQ;
+
+	pm_default(&n->pm);
+
+	n->pm.const_Zp = n->m.Zp;
+
+	/* Solver step is relaxed as we do not need sensor transients.
+	 * */
+	n->m.sT = 5E-6;
+
+	n->cp.node_ID = ID;
+	n->cp.state_ms = (ID == 1) ? 1 : 10;
+	n->cp.pm = &n->pm;
+	n->cp.bus = n;
+	n->cp.proc_send = &multi_node_send;
+
+	n->port = canbus_attach(&mu.bus, &multi_node_recv, n);
+}
+
+static void
+multi_couple()
+{
+	multi_node_t	*n;
+	int		j;
+
+	mu.xL = 0.;
+	mu.wL = 0.;
+
+	for (j = 0; j < mu.N; ++j) {
+
+		n = &mu.node[j];
+
+		n->xM = 0.;
+		mu.wL += n->m.X[2] / n->m.Zp / mu.N;
+	}
+
+	mu.coupled = 1;
+}
+
+static void
+multi_load(double dT)
+{
+	multi_node_t	*n;
+	double		wM, sum = 0.;
+	int		j;
+
+	for (j = 0; j < mu.N; ++j) {
+
+		n = &mu.node[j];
+
+		if (mu.coupled != 0) {
+
+			/* Elastic coupling between the shaft and the load.
+			 * */
+			wM = n->m.X[2] / n->m.Zp;
+			n->xM += wM * dT;
+
+			n->tau = mu.K * (n->xM - mu.xL) + mu.C * (wM - mu.wL);
+		}
+		else {
+			n->tau = 0.;
+		}
+
+		n->m.Mext = - n->tau;
+		sum += n->tau;
+	}
+
+	if (mu.coupled != 0) {
+
+		sum += - mu.wL * (mu.ML[0] + fabs(mu.wL) * mu.ML[1]);
+
+		mu.wL += sum / mu.JL * dT;
+		mu.xL += mu.wL * dT;
+	}
+}
+
+static int
+multi_step(double dT)
+{
+	multi_node_t	*n;
+	pmfb_t		fb;
+	unsigned long	clock_ms;
+	int		j, ms;
+
+	ms = (int) (mu.Tsim * 1000.);
+
+	mu.Tsim += dT;
+
+	for (j = 0; j < mu.N; ++j) {
+
+		n = na = &mu.node[j];
+
+		while (n->m.Tsim < mu.Tsim) {
+
+			blm_Update(&n->m);
+
+			fb.current_A = n->m.ADC_IA;
+			fb.current_B = n->m.ADC_IB;
+			fb.voltage_U = n->m.ADC_US;
+			fb.voltage_A = n->m.ADC_UA;
+			fb.voltage_B = n->m.ADC_UB;
+			fb.voltage_C = n->m.ADC_UC;
+			fb.pulse_HS = n->m.pulse_HS;
+			fb.pulse_EP = n->m.pulse_EP;
+
+			pm_feedback(&n->pm, &fb);
+		}
+
+		if (n->pm.fail_reason != PM_OK) {
+
+			printf("** node %i fail_reason: %s\n", j + 1,
+					pm_strerror(n->pm.fail_reason));
+			return 0;
+		}
+	}
+
+	multi_load(dT);
+
+	canbus_update(&mu.bus, mu.Tsim);
+
+	if ((int) (mu.Tsim * 1000.) != ms) {
+
+		clock_ms = (unsigned long) (mu.Tsim * 1000.);
+
+		for (j = 0; j < mu.N; ++j)
+			canproto_periodic(&mu.node[j].cp, clock_ms);
+	}
+
+	return 1;
+}
+
+static int
+multi_F(double dT)
+{
+	double		Tend = mu.Tsim + dT;
+
+	while (mu.Tsim < Tend) {
+
+		if (multi_step(mu.dT) == 0)
+			return 0;
+	}
+
+	return 1;
+}
+
+static int
+multi_fsm(int req)
+{
+	double		Tend = mu.Tsim + 20.;
+	int		j, busy;
+
+	for (j = 0; j < mu.N; ++j)
+		mu.node[j].pm.fsm_req = req;
+
+	do {
+		if (multi_step(mu.dT) == 0)
+			return 0;
+
+		busy = 0;
+
+		for (j = 0; j < mu.N; ++j) {
+
+			busy |= (mu.node[j].pm.fsm_req != PM_STATE_IDLE);
+			busy |= (mu.node[j].pm.fsm_state != PM_STATE_IDLE);
+		}
+	}
+	while (busy != 0 && mu.Tsim < Tend);
+
+	return (busy == 0) ? 1 : 0;
+}
+
+static int
+multi_identify()
+{
+	int		j;
+
+	/* Motors are identified in parallel before they are coupled.
+	 * */
+	if (multi_fsm(PM_STATE_ZERO_DRIFT) == 0) return 0;
+	if (multi_fsm(PM_STATE_ADJUST_VOLTAGE) == 0) return 0;
+	if (multi_fsm(PM_STATE_PROBE_CONST_R) == 0) return 0;
+	if (multi_fsm(PM_STATE_PROBE_CONST_L) == 0) return 0;
+	if (multi_fsm(PM_STATE_PROBE_CONST_L) == 0) return 0;
+	if (multi_fsm(PM_STATE_LU_STARTUP) == 0) return 0;
+
+	for (j = 0; j < mu.N; ++j)
+		mu.node[j].pm.s_setpoint = mu.node[j].pm.probe_speed_hold;
+
+	if (multi_F(1.) == 0) return 0;
+	if (multi_fsm(PM_STATE_PROBE_CONST_E) == 0) return 0;
+
+	for (j = 0; j < mu.N; ++j)
+		mu.node[j].pm.s_setpoint = 0.f;
+
+	if (multi_F(1.) == 0) return 0;
+	if (multi_fsm(PM_STATE_LU_SHUTDOWN) == 0) return 0;
+
+	for (j = 0; j < mu.N; ++j) {
+
+		printf("node %i R %.4E (Ohm) Kv %.2f (rpm/v)\n", j + 1,
+				mu.node[j].pm.const_R, 5.513289f
+				/ (mu.node[j].pm.const_E * mu.node[j].pm.const_Zp));
+	}
+
+	return 1;
+}
+
+static double
+multi_clock()
+{
+	struct timespec		ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+static void
+multi_stat(double tR)
+{
+	canbus_port_t	*p;
+	int		j;
+
+	printf("sim %.1f (s) real %.1f (s) x%.1f\n", mu.Tsim, tR, mu.Tsim / tR);
+	printf("bus %i frames %.1f %% load\n", mu.bus.frame_N,
+			mu.bus.busy_T / mu.Tsim * 100.);
+
+	for (j = 0; j < mu.bus.port_N; ++j) {
+
+		p = &mu.bus.port[j];
+
+		printf("port %i tx %i drop %i lat %.1f %.1f (us)\n", j, p->tx_N,
+				p->drop_N, p->lat_sum / (p->tx_N + 1E-9) * 1E+6,
+				p->lat_max * 1E+6);
+	}
+
+	for (j = 0; j < mu.N; ++j) {
+
+		printf("node %i iQ %.2f (A) wS %.2f (rad/s) tau %.3f (Nm)\n", j + 1,
+				mu.node[j].pm.lu_iQ, mu.node[j].pm.lu_wS,
+				mu.node[j].tau);
+	}
+
+	printf("load wL %.2f (rad/s)\n", mu.wL);
+}
+
+#define t_xprintf(s)		fprintf(stderr, "** assert(%s) in %s:%i\n", s, __FILE__, __LINE__)
+#define t_assert(x)		if ((x) == 0) { t_xprintf(#x); return 0; }
+
+static int
+multi_run(int N, double Tend, int test)
+{
+	multi_node_t	*n;
+	unsigned char	cmd;
+	float		wSP;
+	double		tR, Tstart, iQ[MULTI_NODE_MAX], tau[MULTI_NODE_MAX];
+	int		j, k;
+
+	memset(&mu, 0, sizeof(mu));
+
+	mu.N = N;
+	mu.dT = 1. / 30000.;
+
+	mu.K = 20.;
+	mu.C = 5E-2;
+	mu.JL = 2E-2;
+	mu.ML[0] = 5E-2;
+	mu.ML[1] = 2E-3;
+
+	canbus_init(&mu.bus, MULTI_BITRATE);
+
+	mu.host = canbus_attach(&mu.bus, &multi_host_recv, NULL);
+
+	for (j = 0; j < N; ++j)
+		multi_node_init(&mu.node[j], j + 1);
+
+	tR = multi_clock();
+
+	t_assert(multi_identify() != 0);
+
+	multi_couple();
+
+	for (j = 0; j < N; ++j) {
+
+		n = &mu.node[j];
+
+		n->pm.config_DRIVE = (j == 0) ? PM_DRIVE_SPEED : PM_DRIVE_CURRENT;
+		n->pm.s_setpoint = 0.f;
+		n->pm.i_setpoint_Q = 0.f;
+	}
+
+	cmd = CANPROTO_NMT_START;
+	multi_host_send(CANPROTO_NMT, 0, 1, &cmd);
+
+	t_assert(multi_F(.5) != 0);
+
+	for (j = 0; j < N; ++j)
+		t_assert(mu.node[j].pm.lu_mode != PM_LU_DISABLED);
+
+	Tstart = mu.Tsim;
+	mu.state_N = 0;
+
+	for (k = 0; mu.Tsim < Tstart + Tend; ++k) {
+
+		/* Speed profile of the load.
+		 * */
+		n = &mu.node[0];
+		wSP = (float) (((k % 4) + 1) * .05 * n->m.U / n->m.E);
+
+		multi_host_send(CANPROTO_SPEED, 1, 4, &wSP);
+
+		t_assert(multi_F((test != 0) ? Tend : 5.) != 0);
+	}
+
+	tR = multi_clock() - tR;
+
+	multi_stat(tR);
+
+	if (test != 0) {
+
+		for (j = 0; j < N; ++j) {
+
+			iQ[j] = 0.;
+			tau[j] = 0.;
+		}
+
+		/* Average over 100 (ms) as the sensor noise makes the
+		 * instant values differ.
+		 * */
+		for (k = 0; k < 100; ++k) {
+
+			t_assert(multi_F(1E-3) != 0);
+
+			for (j = 0; j < N; ++j) {
+
+				iQ[j] += mu.node[j].pm.lu_iQ / 100.;
+				tau[j] += mu.node[j].tau / 100.;
+			}
+		}
+
+		/* Load runs at the speed setpoint and is shared.
+		 * */
+		t_assert(fabs(mu.wL * mu.node[0].m.Zp - wSP) < .1 * wSP);
+
+		for (j = 1; j < N; ++j) {
+
+			t_assert(fabs(iQ[j] - iQ[0]) < .1 * fabs(iQ[0]) + .5);
+			t_assert(fabs(tau[j] - tau[0]) < .1 * fabs(tau[0]) + .05);
+		}
+
+		t_assert(mu.state_N > Tend * 900.);
+		t_assert(mu.bus.port[mu.host].drop_N == 0);
+		t_assert(mu.bus.port[mu.host].lat_max < 1E-3);
+	}
+
+	cmd = CANPROTO_NMT_STOP;
+	multi_host_send(CANPROTO_NMT, 0, 1, &cmd);
+
+	wSP = 0.f;
+	multi_host_send(CANPROTO_SPEED, 1, 4, &wSP);
+
+	t_assert(multi_F(2.) != 0);
+
+	return 1;
+}
+
+int main(int argc, char *argv[])
+{
+	int		j, N = 2, test = 0, rc;
+	double		Tend = 60.;
+
+	for (j = 1; j < argc; ++j) {
+
+		if (strcmp(argv[j], "-t") == 0) {
+
+			test = 1;
+			Tend = 3.;
+		}
+		else if (strcmp(argv[j], "-n") == 0 && j + 1 < argc) {
+
+			N = atoi(argv[++j]);
+			N = (N < 1) ? 1 : (N > MULTI_NODE_MAX) ? MULTI_NODE_MAX : N;
+		}
+		else if (strcmp(argv[j], "-T") == 0 && j + 1 < argc) {
+
+			Tend = atof(argv[++j]);
+		}
+	}
+
+	lib_start();
+
+	rc = multi_run(N, Tend, test);
+
+	lib_stop();
+
+	printf("multi: %s\n", (rc != 0) ? "OK" : "FAIL");
+
+	return (rc != 0) ? 0 : 1;
+}
+
@@ -0,0 +1 @@
+#include "../src/prof.c"
@@ -0,0 +1,7 @@
+/* Build the binary register protocol of firmware against the register
+ * table of regtest.
+ * */
+#define regfile		regtest_regfile
+
+#include "../src/regbin.c"
+
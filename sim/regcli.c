@@ -0,0 +1,199 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "reglink.h"
+
+/* Poll registers of the controller over the binary register protocol.
+ *
+ * regcli [-b baud] [-n count] [-c ms] [-w sym=value]... device sym...
+ *
+ * With -c option we subscribe to the registers and print only the changed
+ * values with the given period.
+ * */
+
+#define REGCLI_MAX		100
+
+static double
+regcli_clock()
+{
+	struct timespec		ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+static int
+regcli_write(reglink_t *rl, const char *arg)
+{
+	char			sym[REGLINK_SYM_MAX], *eq;
+	reglink_val_t		val;
+	int			ID, status;
+
+	strncpy(sym, arg, sizeof(sym) - 1);
+	sym[sizeof(sym) - 1] = 0;
+
+	eq = strchr(sym, '=');
+
+	if (eq == NULL)
+		return 0;
+
+	*eq++ = 0;
+
+	ID = reglink_search(rl, sym);
+
+	if (ID < 0) {
+
+		fprintf(stderr, "regcli: no register \"%s\"\n", sym);
+		return 0;
+	}
+
+	if (rl->desc[ID].type == 'i')
+		val.i = atoi(eq);
+	else
+		val.f = strtof(eq, NULL);
+
+	if (reglink_write(rl, &ID, &val, &status, 1) != 1 || status != 0) {
+
+		fprintf(stderr, "regcli: write \"%s\" failed\n", sym);
+		return 0;
+	}
+
+	return 1;
+}
+
+int main(int argc, char *argv[])
+{
+	reglink_t		rl;
+	reglink_val_t		val[REGCLI_MAX];
+	int			ID[REGCLI_MAX];
+	const char		*dev = NULL;
+	double			tS;
+	int			baud = 57600, count = 1, period = 0;
+	int			argN, N = 0, j, k, n;
+
+	for (argN = 1; argN < argc && argv[argN][0] == '-'; argN += 2) {
+
+		if (argN + 1 >= argc)
+			break;
+
+		if (strcmp(argv[argN], "-b") == 0)
+			baud = atoi(argv[argN + 1]);
+		else if (strcmp(argv[argN], "-n") == 0)
+			count = atoi(argv[argN + 1]);
+		else if (strcmp(argv[argN], "-c") == 0)
+			period = atoi(argv[argN + 1]);
+	}
+
+	if (argN >= argc) {
+
+		fprintf(stderr, "Usage: regcli [-b baud] [-n count] [-c ms] "
+				"[-w sym=value] device sym...\n");
+		return 1;
+	}
+
+	dev = argv[argN++];
+
+	if (reglink_open(&rl, dev, baud) == 0)
+		return 1;
+
+	if (reglink_describe(&rl) == 0) {
+
+		fprintf(stderr, "regcli: no response\n");
+		return 1;
+	}
+
+	for (j = 1; j < argc; j += 2) {
+
+		if (strcmp(argv[j], "-w") == 0 && j + 1 < argc) {
+
+			if (regcli_write(&rl, argv[j + 1]) == 0)
+				return 1;
+		}
+		else if (argv[j][0] != '-') {
+
+			break;
+		}
+	}
+
+	for (; argN < argc && N < REGCLI_MAX; ++argN) {
+
+		ID[N] = reglink_search(&rl, argv[argN]);
+
+		if (ID[N] < 0) {
+
+			fprintf(stderr, "regcli: no register \"%s\"\n", argv[argN]);
+			return 1;
+		}
+
+		printf("%s;", rl.desc[ID[N]].sym);
+		N++;
+	}
+
+	puts("");
+
+	if (period > 0) {
+
+		if (reglink_subscribe(&rl, ID, N) != N) {
+
+			fprintf(stderr, "regcli: subscribe failed\n");
+			return 1;
+		}
+
+		for (k = 0; k < count; ++k) {
+
+			n = reglink_changes(&rl, ID, val, REGCLI_MAX);
+
+			for (j = 0; j < n; ++j) {
+
+				if (rl.desc[ID[j]].type == 'i')
+					printf("%s %i\n", rl.desc[ID[j]].sym, val[j].i);
+				else
+					printf("%s %.4e\n", rl.desc[ID[j]].sym, (double) val[j].f);
+			}
+
+			fflush(stdout);
+			usleep(period * 1000);
+		}
+
+		reglink_close(&rl);
+
+		return 0;
+	}
+
+	tS = regcli_clock();
+
+	for (k = 0; k < count && N > 0; ++k) {
+
+		if (reglink_read(&rl, ID, val, NULL, N) != N) {
+
+			fprintf(stderr, "regcli: read failed\n");
+			break;
+		}
+
+		for (j = 0; j < N; ++j) {
+
+			if (rl.desc[ID[j]].type == 'i')
+				printf("%i;", val[j].i);
+			else
+				printf("%.4e;", (double) val[j].f);
+		}
+
+		puts("");
+	}
+
+	if (k > 1) {
+
+		fprintf(stderr, "regcli: %.1f polls per second, %i CRC errors,"
+				" %i timeouts\n", k / (regcli_clock() - tS),
+				rl.err_crc, rl.err_timeout);
+	}
+
+	reglink_close(&rl);
+
+	return 0;
+}
+
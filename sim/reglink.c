@@ -0,0 +1,500 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "reglink.h"
+
+/* Number of items per frame so the response fits into the firmware buffer.
+ * */
+#define REGLINK_READ_N		50
+#define REGLINK_WRITE_N		40
+#define REGLINK_DESC_N		4
+
+static unsigned long
+reglink_crc32(const unsigned char *s, int n)
+{
+	unsigned long		crc = 0xFFFFFFFFUL;
+	int			j;
+
+	while (n >= 1) {
+
+		crc ^= *s++;
+		n--;
+
+		for (j = 0; j < 8; ++j)
+			crc = (crc >> 1) ^ (0xEDB88320UL & - (crc & 1UL));
+	}
+
+	return ~crc & 0xFFFFFFFFUL;
+}
+
+static speed_t
+reglink_speed(int baud)
+{
+	switch (baud) {
+
+		case 9600:	return B9600;
+		case 19200:	return B19200;
+		case 38400:	return B38400;
+		case 57600:	return B57600;
+		case 115200:	return B115200;
+		case 230400:	return B230400;
+		case 460800:	return B460800;
+		case 921600:	return B921600;
+
+		default:	return B0;
+	}
+}
+
+int reglink_open(reglink_t *rl, const char *dev, int baud)
+{
+	struct termios		tio;
+	int			fd;
+
+	if (reglink_speed(baud) == B0) {
+
+		fprintf(stderr, "reglink: unsupported baud rate %i\n", baud);
+		return 0;
+	}
+
+	fd = open(dev, O_RDWR | O_NOCTTY);
+
+	if (fd < 0) {
+
+		perror(dev);
+		return 0;
+	}
+
+	tcgetattr(fd, &tio);
+	cfmakeraw(&tio);
+
+	/* Firmware uses 8 data bits with even parity.
+	 * */
+	tio.c_cflag |= PARENB | CLOCAL | CREAD;
+	tio.c_cflag &= ~(PARODD | CSTOPB | CRTSCTS);
+	tio.c_cc[VMIN] = 0;
+	tio.c_cc[VTIME] = 0;
+
+	cfsetispeed(&tio, reglink_speed(baud));
+	cfsetospeed(&tio, reglink_speed(baud));
+
+	tcsetattr(fd, TCSANOW, &tio);
+	tcflush(fd, TCIOFLUSH);
+
+	reglink_fdopen(rl, fd);
+
+	return 1;
+}
+
+void reglink_fdopen(reglink_t *rl, int fd)
+{
+	memset(rl, 0, sizeof(reglink_t));
+
+	rl->fd = fd;
+}
+
+void reglink_close(reglink_t *rl)
+{
+	free(rl->desc);
+	close(rl->fd);
+
+	rl->desc = NULL;
+	rl->N = 0;
+}
+
+static int
+reglink_send(reglink_t *rl, const unsigned char *req, int len)
+{
+	unsigned char		raw[REGLINK_FRAME_MAX + 4];
+	unsigned char		out[REGLINK_FRAME_MAX * 2], *p, *code_p;
+	unsigned long		crc;
+	int			j, code;
+
+	memcpy(raw, req, len);
+
+	crc = reglink_crc32(raw, len);
+
+	raw[len++] = (unsigned char) (crc);
+	raw[len++] = (unsigned char) (crc >> 8);
+	raw[len++] = (unsigned char) (crc >> 16);
+	raw[len++] = (unsigned char) (crc >> 24);
+
+	/* Leading zero switches the shell into frame receive.
+	 * */
+	p = out;
+	*p++ = 0;
+
+	code_p = p++;
+	code = 1;
+
+	for (j = 0; j < len; ++j) {
+
+		if (raw[j] == 0) {
+
+			*code_p = (unsigned char) code;
+			code_p = p++;
+			code = 1;
+		}
+		else {
+			*p++ = raw[j];
+			code++;
+
+			if (code == 0xFF) {
+
+				*code_p = (unsigned char) code;
+				code_p = p++;
+				code = 1;
+			}
+		}
+	}
+
+	*code_p = (unsigned char) code;
+	*p++ = 0;
+
+	len = (int) (p - out);
+
+	return (write(rl->fd, out, len) == len) ? 1 : 0;
+}
+
+static int
+reglink_getc(reglink_t *rl)
+{
+	struct pollfd		pfd;
+
+	if (rl->rx_pos >= rl->rx_len) {
+
+		pfd.fd = rl->fd;
+		pfd.events = POLLIN;
+
+		if (poll(&pfd, 1, REGLINK_TIMEOUT) <= 0)
+			return -1;
+
+		rl->rx_len = read(rl->fd, rl->rx, sizeof(rl->rx));
+		rl->rx_pos = 0;
+
+		if (rl->rx_len <= 0)
+			return -1;
+	}
+
+	return rl->rx[rl->rx_pos++];
+}
+
+static int
+reglink_recv(reglink_t *rl, unsigned char *frame)
+{
+	int			c, code = 0, rem = 0, len = 0, lost = 0;
+
+	do {
+		c = reglink_getc(rl);
+
+		if (c < 0) {
+
+			rl->err_timeout++;
+			return -1;
+		}
+
+		if (c == 0) {
+
+			if (lost == 0 && rem == 0 && len >= 5) {
+
+				len -= (code < 0xFF) ? 1 : 0;
+				len -= 4;
+
+				if (reglink_crc32(frame, len) == (frame[len]
+						| (frame[len + 1] << 8)
+						| (frame[len + 2] << 16)
+						| ((unsigned long) frame[len + 3] << 24))) {
+
+					return len;
+				}
+
+				rl->err_crc++;
+			}
+
+			/* Text output or broken frame is dropped.
+			 * */
+			code = 0;
+			rem = 0;
+			len = 0;
+			lost = 0;
+		}
+		else if (lost != 0) {
+
+			continue;
+		}
+		else if (len + 2 >= REGLINK_FRAME_MAX + 4) {
+
+			lost = 1;
+		}
+		else {
+			if (rem == 0) {
+
+				code = c;
+				rem = c;
+			}
+			else {
+				frame[len++] = (unsigned char) c;
+			}
+
+			if (--rem == 0 && code < 0xFF) {
+
+				frame[len++] = 0;
+			}
+		}
+	}
+	while (1);
+}
+
+static int
+reglink_call(reglink_t *rl, unsigned char *req, int len, unsigned char *resp)
+{
+	int			rlen, retry;
+
+	rl->seq = (rl->seq + 1) & 0xFF;
+	req[1] = (unsigned char) rl->seq;
+
+	for (retry = 0; retry < 3; ++retry) {
+
+		if (reglink_send(rl, req, len) == 0)
+			return -1;
+
+		/* Skip responses to the previous requests.
+		 * */
+		while ((rlen = reglink_recv(rl, resp)) >= 0) {
+
+			if (rlen >= 2 && resp[1] == req[1]) {
+
+				return (resp[0] == req[0]) ? rlen : -1;
+			}
+		}
+	}
+
+	return -1;
+}
+
+static int
+reglink_items(reglink_t *rl, int op, const int *ID, reglink_val_t *val,
+		int *status, int N)
+{
+	unsigned char		req[REGLINK_FRAME_MAX], resp[REGLINK_FRAME_MAX + 4];
+	unsigned char		*p;
+	unsigned int		u;
+	int			done = 0, n, m, k, rlen;
+
+	while (done < N) {
+
+		n = N - done;
+		n = (op == 'W') ? (n < REGLINK_WRITE_N ? n : REGLINK_WRITE_N)
+			: (n < REGLINK_READ_N ? n : REGLINK_READ_N);
+
+		p = req;
+
+		*p++ = (unsigned char) op;
+		*p++ = 0;
+
+		for (k = 0; k < n; ++k) {
+
+			*p++ = (unsigned char) (ID[done + k]);
+			*p++ = (unsigned char) (ID[done + k] >> 8);
+
+			if (op == 'W') {
+
+				u = (unsigned int) val[done + k].i;
+
+				*p++ = (unsigned char) (u);
+				*p++ = (unsigned char) (u >> 8);
+				*p++ = (unsigned char) (u >> 16);
+				*p++ = (unsigned char) (u >> 24);
+			}
+		}
+
+		rlen = reglink_call(rl, req, (int) (p - req), resp);
+
+		if (rlen < 0)
+			break;
+
+		m = (rlen - 2) / 5;
+		m = (m < n) ? m : n;
+
+		for (k = 0; k < m; ++k) {
+
+			p = resp + 2 + k * 5;
+
+			if (status != NULL)
+				status[done + k] = p[0];
+
+			val[done + k].i = (int) (p[1] | (p[2] << 8) | (p[3] << 16)
+					| ((unsigned int) p[4] << 24));
+		}
+
+		done += m;
+
+		if (m < n)
+			break;
+	}
+
+	return done;
+}
+
+int reglink_read(reglink_t *rl, const int *ID, reglink_val_t *val, int *status, int N)
+{
+	return reglink_items(rl, 'R', ID, val, status, N);
+}
+
+int reglink_write(reglink_t *rl, const int *ID, reglink_val_t *val, int *status, int N)
+{
+	return reglink_items(rl, 'W', ID, val, status, N);
+}
+
+int reglink_subscribe(reglink_t *rl, const int *ID, int N)
+{
+	unsigned char		req[REGLINK_FRAME_MAX], resp[REGLINK_FRAME_MAX + 4];
+	int			done = 0, n, k, rlen;
+
+	while (done < N) {
+
+		n = N - done;
+		n = (n < REGLINK_READ_N) ? n : REGLINK_READ_N;
+
+		req[0] = 'S';
+
+		for (k = 0; k < n; ++k) {
+
+			req[2 + k * 2] = (unsigned char) (ID[done + k]);
+			req[3 + k * 2] = (unsigned char) (ID[done + k] >> 8);
+		}
+
+		rlen = reglink_call(rl, req, 2 + n * 2, resp);
+
+		if (rlen != 2 + n)
+			break;
+
+		for (k = 0; k < n; ++k) {
+
+			if (resp[2 + k] != 0)
+				return done + k;
+		}
+
+		done += n;
+	}
+
+	return done;
+}
+
+int reglink_changes(reglink_t *rl, int *ID, reglink_val_t *val, int N)
+{
+	unsigned char		req[2], resp[REGLINK_FRAME_MAX + 4], *p;
+	int			n = 0, rlen;
+
+	req[0] = 'C';
+
+	rlen = reglink_call(rl, req, 2, resp);
+
+	for (p = resp + 2; p + 6 <= resp + rlen && n < N; p += 6, ++n) {
+
+		ID[n] = p[0] | (p[1] << 8);
+		val[n].i = (int) (p[2] | (p[3] << 8) | (p[4] << 16)
+				| ((unsigned int) p[5] << 24));
+	}
+
+	return n;
+}
+
+static const unsigned char *
+reglink_str(char *s, const unsigned char *p, const unsigned char *end)
+{
+	int			n = 0;
+
+	while (p < end && *p != 0) {
+
+		if (n < REGLINK_SYM_MAX - 1)
+			s[n++] = (char) *p;
+
+		p++;
+	}
+
+	s[n] = 0;
+
+	return (p < end) ? p + 1 : NULL;
+}
+
+int reglink_describe(reglink_t *rl)
+{
+	unsigned char		req[REGLINK_FRAME_MAX], resp[REGLINK_FRAME_MAX + 4];
+	const unsigned char	*p, *end;
+	reglink_desc_t		*desc;
+	int			k, rlen;
+
+	free(rl->desc);
+
+	rl->desc = NULL;
+	rl->N = 0;
+
+	do {
+		req[0] = 'D';
+
+		for (k = 0; k < REGLINK_DESC_N; ++k) {
+
+			req[2 + k * 2] = (unsigned char) (rl->N + k);
+			req[3 + k * 2] = (unsigned char) ((rl->N + k) >> 8);
+		}
+
+		rlen = reglink_call(rl, req, 2 + REGLINK_DESC_N * 2, resp);
+
+		if (rlen < 0)
+			break;
+
+		p = resp + 2;
+		end = resp + rlen;
+
+		while (p < end) {
+
+			if (*p != 0 || p + 3 > end) {
+
+				/* End of the register file.
+				 * */
+				return rl->N;
+			}
+
+			desc = realloc(rl->desc, (rl->N + 1) * sizeof(reglink_desc_t));
+
+			if (desc == NULL)
+				return rl->N;
+
+			rl->desc = desc;
+			desc += rl->N;
+
+			desc->type = p[1];
+			desc->mode = p[2];
+
+			p = reglink_str(desc->sym, p + 3, end);
+			p = (p != NULL) ? reglink_str(desc->unit, p, end) : NULL;
+
+			if (p == NULL)
+				return rl->N;
+
+			rl->N++;
+		}
+	}
+	while (rlen > 2);
+
+	return rl->N;
+}
+
+int reglink_search(const reglink_t *rl, const char *sym)
+{
+	int			ID;
+
+	for (ID = 0; ID < rl->N; ++ID) {
+
+		if (strcmp(rl->desc[ID].sym, sym) == 0)
+			return ID;
+	}
+
+	return -1;
+}
+
@@ -0,0 +1,59 @@
+#ifndef _H_REGLINK_
+#define _H_REGLINK_
+
+#define REGLINK_FRAME_MAX	260
+#define REGLINK_SYM_MAX		80
+#define REGLINK_TIMEOUT		500
+
+/* Host client of the binary register protocol (see src/regbin.h).
+ * */
+
+typedef union {
+
+	float		f;
+	int		i;
+}
+reglink_val_t;
+
+typedef struct {
+
+	char		sym[REGLINK_SYM_MAX];
+	char		unit[REGLINK_SYM_MAX];
+
+	int		type;
+	int		mode;
+}
+reglink_desc_t;
+
+typedef struct {
+
+	int		fd;
+	int		seq;
+
+	reglink_desc_t	*desc;
+	int		N;
+
+	int		err_crc;
+	int		err_timeout;
+
+	unsigned char	rx[256];
+	int		rx_len;
+	int		rx_pos;
+}
+reglink_t;
+
+int reglink_open(reglink_t *rl, const char *dev, int baud);
+void reglink_fdopen(reglink_t *rl, int fd);
+void reglink_close(reglink_t *rl);
+
+int reglink_describe(reglink_t *rl);
+int reglink_search(const reglink_t *rl, const char *sym);
+
+int reglink_read(reglink_t *rl, const int *ID, reglink_val_t *val, int *status, int N);
+int reglink_write(reglink_t *rl, const int *ID, reglink_val_t *val, int *status, int N);
+
+int reglink_subscribe(reglink_t *rl, const int *ID, int N);
+int reglink_changes(reglink_t *rl, int *ID, reglink_val_t *val, int N);
+
+#endif /* _H_REGLINK_ */
+
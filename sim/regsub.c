@@ -0,0 +1,7 @@
+/* Build the register subscriptions of firmware against the register table
+ * of regtest.
+ * */
+#define regfile		regtest_regfile
+
+#include "../src/regsub.c"
+
@@ -0,0 +1,370 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/regbin.h"
+
+/* Host test of the binary register protocol and subscriptions. Firmware
+ * code runs against the register table of the test where even registers
+ * are integer, odd are float and each fourth is read only. State variables
+ * are changed directly as control IRQ does.
+ * */
+
+#define REG_MANY_N		60
+
+reg_t			regtest_regfile[REG_ID_MAX + 1];
+
+static char		name[REG_ID_MAX][16];
+static reg_val_t	value[REG_ID_MAX];
+
+static unsigned char	resp[REGBIN_FRAME_MAX + 4];
+
+int hal_lock_irq() { return 0; }
+void hal_unlock_irq(int irq) { }
+
+void frame_send(unsigned char *frame, int len) { }
+int frame_recv(unsigned char *frame, int max) { return 0; }
+
+void reg_getval(const reg_t *reg, void *lval)
+{
+	*(reg_val_t *) lval = *reg->link;
+}
+
+void reg_setval(const reg_t *reg, const void *rval)
+{
+	if ((reg->mode & REG_READ_ONLY) == 0) {
+
+		*reg->link = *(const reg_val_t *) rval;
+
+		reg_mark_value((int) (reg - regtest_regfile));
+	}
+}
+
+static void
+reg_table_init()
+{
+	int		ID, N;
+
+	for (ID = 0; ID < REG_ID_MAX; ++ID) {
+
+		/* Unit is placed after the symbol.
+		 * */
+		N = sprintf(name[ID], "reg_%i", ID);
+		strcpy(name[ID] + N + 1, (ID % 2 == 0) ? "" : "V");
+
+		regtest_regfile[ID].sym = name[ID];
+		regtest_regfile[ID].mode = (ID % 4 == 3) ? REG_READ_ONLY : REG_CONFIG;
+		regtest_regfile[ID].link = &value[ID];
+
+		memcpy((char *) regtest_regfile[ID].fmt, (ID % 2 == 0) ? "%i" : "%3f", 4);
+
+		if (ID % 2 == 0)
+			value[ID].i = ID * 10;
+		else
+			value[ID].f = (float) ID * .5f;
+	}
+}
+
+static unsigned char *
+reg_put_ID(unsigned char *p, int ID)
+{
+	p[0] = (unsigned char) (ID);
+	p[1] = (unsigned char) (ID >> 8);
+
+	return p + 2;
+}
+
+static int
+reg_get_ID(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static int
+reg_get_val(const unsigned char *p)
+{
+	return (int) (p[0] | (p[1] << 8) | (p[2] << 16)
+			| ((unsigned int) p[3] << 24));
+}
+
+static int
+reg_call(regbin_t *rb, int op, const int *list, int N, int max)
+{
+	unsigned char	req[REGBIN_FRAME_MAX], *p = req;
+	int		j;
+
+	*p++ = (unsigned char) op;
+	*p++ = 0x5A;
+
+	for (j = 0; j < N; ++j)
+		p = reg_put_ID(p, list[j]);
+
+	memset(resp, 0xA5, sizeof(resp));
+
+	return regbin_call(rb, req, (int) (p - req), resp, max);
+}
+
+static int
+reg_framing()
+{
+	unsigned char	req[20], *p;
+	regbin_t	rb = { 0 };
+	int		fail = 0, len;
+
+	/* Read returns the status and value of each item.
+	 * */
+	len = reg_call(&rb, REGBIN_READ, (int []) { 2, 5, 0xFFFF }, 3, REGBIN_FRAME_MAX);
+
+	fail |= (len != 2 + 3 * 5);
+	fail |= (resp[0] != REGBIN_READ || resp[1] != 0x5A);
+	fail |= (resp[2] != REGBIN_OK || reg_get_val(resp + 3) != value[2].i);
+	fail |= (resp[7] != REGBIN_OK || reg_get_val(resp + 8) != value[5].i);
+	fail |= (resp[12] != REGBIN_INVALID || reg_get_val(resp + 13) != 0);
+
+	/* Write returns the value that was read back.
+	 * */
+	p = req;
+
+	*p++ = REGBIN_WRITE;
+	*p++ = 0x11;
+
+	p = reg_put_ID(p, 4);
+	p = reg_put_ID(p, 1234);
+	p = reg_put_ID(p, 0);
+	p = reg_put_ID(p, 3);
+	p = reg_put_ID(p, 4321);
+	p = reg_put_ID(p, 0);
+
+	len = regbin_call(&rb, req, (int) (p - req), resp, REGBIN_FRAME_MAX);
+
+	fail |= (len != 2 + 2 * 5);
+	fail |= (resp[0] != REGBIN_WRITE || resp[1] != 0x11);
+	fail |= (resp[2] != REGBIN_OK || reg_get_val(resp + 3) != 1234);
+	fail |= (resp[7] != REGBIN_READ_ONLY || reg_get_val(resp + 8) != value[3].i);
+	fail |= (value[4].i != 1234 || value[3].f != 1.5f);
+
+	/* Description has the type, mode, symbol and unit.
+	 * */
+	len = reg_call(&rb, REGBIN_DESC, (int []) { 7, 6 }, 2, REGBIN_FRAME_MAX);
+
+	fail |= (len != 2 + 3 + 6 + 2 + 3 + 6 + 1);
+	fail |= (resp[2] != REGBIN_OK || resp[3] != '3' || resp[4] != REG_READ_ONLY);
+	fail |= (memcmp(resp + 5, "reg_7\0V", 8) != 0);
+	fail |= (resp[13] != REGBIN_OK || resp[14] != 'i' || resp[15] != REG_CONFIG);
+	fail |= (memcmp(resp + 16, "reg_6\0", 7) != 0);
+
+	/* Unknown operation and short request.
+	 * */
+	len = reg_call(&rb, 'X', (int []) { 1 }, 1, REGBIN_FRAME_MAX);
+	fail |= (len != 2 || resp[0] != REGBIN_UNKNOWN || resp[1] != 0x5A);
+
+	fail |= (regbin_call(&rb, req, 1, resp, REGBIN_FRAME_MAX) != 0);
+
+	if (fail != 0)
+		printf("regtest: framing FAIL\n");
+
+	return fail;
+}
+
+static int
+reg_truncate()
+{
+	unsigned char	req[20], *p;
+	regbin_t	rb = { 0 };
+	int		fail = 0, len;
+
+	/* Items that do not fit are dropped.
+	 * */
+	len = reg_call(&rb, REGBIN_READ, (int []) { 0, 1, 2, 4, 5 }, 5, 2 + 3 * 5 + 4);
+
+	fail |= (len != 2 + 3 * 5);
+	fail |= (resp[12] != REGBIN_OK || reg_get_val(resp + 13) != value[2].i);
+	fail |= (resp[len] != 0xA5);
+
+	/* Description that does not fit is not cut in the middle.
+	 * */
+	len = reg_call(&rb, REGBIN_DESC, (int []) { 7, 6 }, 2, 2 + 11 + 5);
+
+	fail |= (len != 2 + 11);
+
+	/* Dropped write is not applied.
+	 * */
+	p = req;
+
+	*p++ = REGBIN_WRITE;
+	*p++ = 0x22;
+
+	p = reg_put_ID(p, 8);
+	p = reg_put_ID(p, 500);
+	p = reg_put_ID(p, 0);
+	p = reg_put_ID(p, 10);
+	p = reg_put_ID(p, 600);
+	p = reg_put_ID(p, 0);
+
+	len = regbin_call(&rb, req, (int) (p - req), resp, 2 + 5 + 4);
+
+	fail |= (len != 2 + 5);
+	fail |= (value[8].i != 500 || value[10].i != 100);
+
+	if (fail != 0)
+		printf("regtest: truncate FAIL\n");
+
+	return fail;
+}
+
+static int
+reg_changes(regbin_t *rb, int *list, int max)
+{
+	int		len, N, j;
+
+	len = reg_call(rb, REGBIN_CHANGES, NULL, 0, max);
+
+	N = (len - 2) / 6;
+
+	for (j = 0; j < N; ++j)
+		list[j] = reg_get_ID(resp + 2 + j * 6);
+
+	return ((len - 2) % 6 == 0) ? N : -1;
+}
+
+static int
+reg_subs()
+{
+	regbin_t	rb[5] = { 0 };
+	int		list[REG_ID_MAX], many[REG_MANY_N], seen[REG_ID_MAX];
+	int		fail = 0, len, N, j, ID, last;
+
+	/* Two transports subscribe independently.
+	 * */
+	len = reg_call(&rb[0], REGBIN_SUBSCRIBE, (int []) { 1, 2 }, 2, REGBIN_FRAME_MAX);
+
+	fail |= (len != 2 + 2 || resp[2] != REGBIN_OK || resp[3] != REGBIN_OK);
+
+	len = reg_call(&rb[1], REGBIN_SUBSCRIBE, (int []) { 2, 0xFFFF }, 2, REGBIN_FRAME_MAX);
+
+	fail |= (len != 2 + 2 || resp[2] != REGBIN_OK || resp[3] != REGBIN_INVALID);
+
+	/* Current values are reported at first.
+	 * */
+	N = reg_changes(&rb[0], list, REGBIN_FRAME_MAX);
+
+	fail |= (N != 2 || list[0] != 1 || list[1] != 2);
+	fail |= (reg_get_val(resp + 2 + 2) != value[1].i);
+	fail |= (reg_changes(&rb[0], list, REGBIN_FRAME_MAX) != 0);
+
+	N = reg_changes(&rb[1], list, REGBIN_FRAME_MAX);
+
+	fail |= (N != 1 || list[0] != 2);
+	fail |= (reg_changes(&rb[1], list, REGBIN_FRAME_MAX) != 0);
+
+	/* Write is marked for all subscribers once.
+	 * */
+	reg_setval(&regtest_regfile[2], &(reg_val_t) { .i = 77 });
+
+	N = reg_changes(&rb[0], list, REGBIN_FRAME_MAX);
+
+	fail |= (N != 1 || list[0] != 2 || reg_get_val(resp + 2 + 2) != 77);
+	fail |= (reg_changes(&rb[0], list, REGBIN_FRAME_MAX) != 0);
+
+	N = reg_changes(&rb[1], list, REGBIN_FRAME_MAX);
+
+	fail |= (N != 1 || list[0] != 2);
+
+	/* State variable is detected by value.
+	 * */
+	value[1].f = 100.f;
+
+	N = reg_changes(&rb[0], list, REGBIN_FRAME_MAX);
+
+	fail |= (N != 1 || list[0] != 1);
+	fail |= (reg_changes(&rb[1], list, REGBIN_FRAME_MAX) != 0);
+
+	/* Short excursion of the state is not lost.
+	 * */
+	reg_call(&rb[0], REGBIN_SUBSCRIBE, (int []) { ID_PM_FSM_STATE }, 1, REGBIN_FRAME_MAX);
+	reg_changes(&rb[0], list, REGBIN_FRAME_MAX);
+
+	last = value[ID_PM_FSM_STATE].i;
+
+	value[ID_PM_FSM_STATE].i = last + 1;
+	reg_mark_state();
+
+	value[ID_PM_FSM_STATE].i = last;
+	reg_mark_state();
+
+	N = reg_changes(&rb[0], list, REGBIN_FRAME_MAX);
+
+	fail |= (N != 1 || list[0] != ID_PM_FSM_STATE);
+
+	/* Changes that do not fit are carried over to the next request.
+	 * */
+	for (j = 0; j < REG_MANY_N; ++j)
+		many[j] = 20 + j * 3;
+
+	reg_call(&rb[0], REGBIN_SUBSCRIBE, many, REG_MANY_N, REGBIN_FRAME_MAX);
+
+	memset(seen, 0, sizeof(seen));
+
+	for (j = 0; j < 10; ++j) {
+
+		N = reg_changes(&rb[0], list, 2 + 6 * 7 + 5);
+
+		fail |= (N < 0 || N > 7);
+
+		if (N <= 0)
+			break;
+
+		while (N-- > 0)
+			seen[list[N]]++;
+	}
+
+	for (j = 0; j < REG_MANY_N; ++j)
+		fail |= (seen[many[j]] != 1);
+
+	fail |= (reg_changes(&rb[0], list, REGBIN_FRAME_MAX) != 0);
+
+	/* There are only REG_SUB_MAX subscriptions.
+	 * */
+	for (j = 2; j < 5; ++j) {
+
+		len = reg_call(&rb[j], REGBIN_SUBSCRIBE, (int []) { 5 }, 1, REGBIN_FRAME_MAX);
+
+		fail |= (len != 3);
+		fail |= (resp[2] != ((j < REG_SUB_MAX) ? REGBIN_OK : REGBIN_NO_SPACE));
+	}
+
+	/* Unsubscribe of one does not affect the other.
+	 * */
+	len = reg_call(&rb[0], REGBIN_UNSUBSCRIBE, NULL, 0, REGBIN_FRAME_MAX);
+
+	fail |= (len != 2 || resp[0] != REGBIN_UNSUBSCRIBE);
+
+	reg_setval(&regtest_regfile[2], &(reg_val_t) { .i = 78 });
+
+	fail |= (reg_changes(&rb[0], list, REGBIN_FRAME_MAX) != 0);
+	fail |= (reg_changes(&rb[1], list, REGBIN_FRAME_MAX) != 1);
+
+	for (ID = 1; ID < 5; ++ID)
+		reg_call(&rb[ID], REGBIN_UNSUBSCRIBE, NULL, 0, REGBIN_FRAME_MAX);
+
+	if (fail != 0)
+		printf("regtest: subs FAIL\n");
+
+	return fail;
+}
+
+int main(int argc, char *argv[])
+{
+	int		fail = 0;
+
+	reg_table_init();
+
+	fail |= reg_framing();
+	fail |= reg_truncate();
+	fail |= reg_subs();
+
+	printf("regtest: %s\n", (fail == 0) ? "OK" : "FAIL");
+
+	return fail;
+}
+
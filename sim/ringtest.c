@@ -0,0 +1,215 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "../src/canring.h"
+
+/* Host test of the CAN receive ring. Producer thread plays the role of RX
+ * interrupt and pushes numbered frames as fast as it can, main thread is the
+ * consumer that checks the order and content of each frame. The first run
+ * drops frames on full ring as interrupt does, the second one waits for free
+ * space so no frame may be lost. TX queues use the same ring with depth
+ * limit.
+ * */
+
+#define RING_FRAME_N		2000000
+
+static canring_t	ring;
+
+static int		ring_wait;
+static int		ring_done;
+static int		ring_stop;
+static int		ring_lost;
+
+static void
+ring_fill(can_msg_t *msg, unsigned int seq)
+{
+	int		j;
+
+	msg->ID = seq & 0x7FFUL;
+	msg->len = (int) (seq % 9U);
+
+	for (j = 0; j < 4; ++j) {
+
+		msg->payload[j] = (unsigned char) (seq >> (j * 8));
+		msg->payload[j + 4] = (unsigned char) ~(seq >> (j * 8));
+	}
+}
+
+static int
+ring_check(const can_msg_t *msg, unsigned int *seq)
+{
+	can_msg_t	ref;
+	unsigned int	n = 0;
+	int		j;
+
+	for (j = 0; j < 4; ++j)
+		n |= (unsigned int) msg->payload[j] << (j * 8);
+
+	ring_fill(&ref, n);
+
+	if (memcmp(&ref, msg, sizeof(can_msg_t)) != 0) {
+
+		printf("ringtest: frame %u is broken\n", n);
+		return 0;
+	}
+
+	if (n < *seq) {
+
+		printf("ringtest: frame %u after %u\n", n, *seq);
+		return 0;
+	}
+
+	*seq = n + 1;
+
+	return 1;
+}
+
+static void *
+ring_producer(void *arg)
+{
+	can_msg_t	*msg;
+	unsigned int	seq;
+
+	for (seq = 0; seq < RING_FRAME_N; ++seq) {
+
+		do {
+			msg = canring_alloc(&ring);
+
+			if (msg == NULL && ring_wait == 0)
+				ring_lost++;
+			else if (msg == NULL)
+				sched_yield();
+		}
+		while (		msg == NULL && ring_wait != 0
+				&& __atomic_load_n(&ring_stop, __ATOMIC_ACQUIRE) == 0);
+
+		if (msg != NULL) {
+
+			/* Fill the frame in place as the interrupt does.
+			 * */
+			ring_fill(msg, seq);
+			canring_commit(&ring);
+		}
+
+		if (seq % 53U == 0) {
+
+			/* Let the consumer run on a single CPU.
+			 * */
+			sched_yield();
+		}
+	}
+
+	__atomic_store_n(&ring_done, 1, __ATOMIC_RELEASE);
+
+	return NULL;
+}
+
+static int
+ring_run(int wait)
+{
+	pthread_t	th;
+	can_msg_t	msg;
+	unsigned int	seq = 0;
+	int		N = 0, fail = 0;
+
+	memset(&ring, 0, sizeof(ring));
+
+	ring_wait = wait;
+	ring_done = 0;
+	ring_stop = 0;
+	ring_lost = 0;
+
+	pthread_create(&th, NULL, &ring_producer, NULL);
+
+	do {
+		if (canring_pop(&ring, &msg) != 0) {
+
+			fail |= (ring_check(&msg, &seq) == 0);
+			N++;
+
+			/* Stall the consumer sometimes to get the ring full.
+			 * */
+			if ((N & 0xFFFF) == 0)
+				sched_yield();
+		}
+		else if (__atomic_load_n(&ring_done, __ATOMIC_ACQUIRE) != 0
+				&& canring_count(&ring) == 0) {
+
+			break;
+		}
+		else {
+			sched_yield();
+		}
+	}
+	while (fail == 0);
+
+	__atomic_store_n(&ring_stop, 1, __ATOMIC_RELEASE);
+
+	pthread_join(th, NULL);
+
+	printf("ringtest: %s received %i overflow %i peak %i\n",
+			(wait != 0) ? "wait" : "drop", N, ring.overflow_N, ring.peak_N);
+
+	if (wait == 0) {
+
+		fail |= (N + ring.overflow_N != RING_FRAME_N);
+		fail |= (ring.overflow_N != ring_lost);
+	}
+	else {
+		fail |= (N != RING_FRAME_N);
+	}
+
+	fail |= (ring.peak_N > CANRING_SZ);
+
+	return fail;
+}
+
+static int
+ring_depth()
+{
+	can_msg_t	msg;
+	int		j, fail = 0;
+
+	/* Depth limits the fill and space tells how long burst fits.
+	 * */
+	memset(&ring, 0, sizeof(ring));
+
+	ring.depth = 5;
+
+	for (j = 0; j < 5; ++j) {
+
+		fail |= (canring_space(&ring) != 5 - j);
+		fail |= (canring_alloc(&ring) == NULL);
+
+		canring_commit(&ring);
+	}
+
+	fail |= (canring_alloc(&ring) != NULL);
+	fail |= (ring.overflow_N != 1 || ring.peak_N != 5);
+
+	fail |= (canring_pop(&ring, &msg) != 1);
+	fail |= (canring_space(&ring) != 1);
+
+	ring.depth = 0;
+
+	fail |= (canring_space(&ring) != CANRING_SZ - 4);
+
+	return fail;
+}
+
+int main(int argc, char *argv[])
+{
+	int		fail = 0;
+
+	fail |= ring_depth();
+	fail |= ring_run(0);
+	fail |= ring_run(1);
+
+	printf("ringtest: %s\n", (fail == 0) ? "OK" : "FAIL");
+
+	return fail;
+}
+
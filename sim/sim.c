@@ -3,16 +3,97 @@
 #include <string.h>
 #include <errno.h>
 #include <math.h>
+#include <time.h>
 
 #include "blm.h"
 #include "pm.h"
 #include "lib.h"
 
+#include "../src/canproto.h"
+#include "../src/prof.h"
+
 #define TEL_FILE	"/tmp/TEL"
 
 static blm_t		m;
 static pmc_t		pm;
 
+static struct {
+
+	can_msg_t	msg[64];
+	int		N;
+}
+sim_bus;
+
+static struct {
+
+	double		ef_sq;
+	double		ws_sq;
+	double		wh;
+	double		fq;
+	int		N;
+}
+sim_stat;
+
+static struct {
+
+	prof_t		pm_feedback;
+	prof_t		stage[PM_MARK_MAX];
+
+	unsigned long	stamp;
+}
+sim_prof;
+
+unsigned long prof_clock()
+{
+	struct timespec		ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+static void
+sim_prof_reset()
+{
+	int		N;
+
+	prof_reset(&sim_prof.pm_feedback);
+
+	for (N = 0; N < PM_MARK_MAX; ++N)
+		prof_reset(&sim_prof.stage[N]);
+}
+
+static void
+sim_prof_print()
+{
+	const char	*name[PM_MARK_MAX] = { "input", "FSM", "observer", "loop" };
+	const prof_t	*pf = &sim_prof.pm_feedback;
+	int		N;
+
+	printf("pm_feedback %.3f %.3f %.3f (us)\n", pf->min * 1E-3,
+			prof_mean(pf) * 1E-3, pf->max * 1E-3);
+
+	for (N = 0; N < PM_MARK_MAX; ++N) {
+
+		pf = &sim_prof.stage[N];
+
+		printf("  %-8s %.3f %.3f (us)\n", name[N],
+				prof_mean(pf) * 1E-3, pf->max * 1E-3);
+	}
+}
+
+static void
+sim_pm_mark(int stage)
+{
+	unsigned long		clock;
+
+	clock = prof_clock();
+
+	prof_add(&sim_prof.stage[stage], clock - sim_prof.stamp);
+
+	sim_prof.stamp = clock;
+}
+
 static void
 blmDC(int A, int B, int C)
 {
@@ -33,6 +114,21 @@ blmZ(int Z)
 	}
 }
 
+static int
+blmFREQ(float F)
+{
+	double		K;
+
+	/* Timer clock.
+	 * */
+	K = m.PWM_R / m.dT;
+
+	m.PWM_R = (int) (K / F + .5);
+	m.dT = m.PWM_R / K;
+
+	return m.PWM_R;
+}
+
 static void
 sim_Tel(float *pTel)
 {
@@ -137,7 +233,9 @@ sim_F(FILE *fdTel, double dT)
 {
 	const int	szTel = 40;
 	float		Tel[szTel];
-	double		Tend;
+	double		Tend, D, Q;
+
+	unsigned long	clock;
 
 	pmfb_t		fb;
 
@@ -151,6 +249,15 @@ sim_F(FILE *fdTel, double dT)
 
 		fb.current_A = m.ADC_IA;
 		fb.current_B = m.ADC_IB;
+
+		if (m.DUAL != 0 && m.sH == 0) {
+
+			/* Second half of the period was sampled at the valley.
+			 * */
+			pm_feedback_valley(&pm, &fb);
+			continue;
+		}
+
 		fb.voltage_U = m.ADC_US;
 		fb.voltage_A = m.ADC_UA;
 		fb.voltage_B = m.ADC_UB;
@@ -160,8 +267,29 @@ sim_F(FILE *fdTel, double dT)
 
 		/* PM update.
 		 * */
+		clock = prof_clock();
+		sim_prof.stamp = clock;
+
 		pm_feedback(&pm, &fb);
 
+		clock = prof_clock() - clock;
+		prof_add(&sim_prof.pm_feedback, clock);
+
+		/* Collect the observer statistics.
+		 * */
+		D = cos(m.X[3]) * pm.lu_F[1] - sin(m.X[3]) * pm.lu_F[0];
+		Q = cos(m.X[3]) * pm.lu_F[0] + sin(m.X[3]) * pm.lu_F[1];
+		D = atan2(D, Q);
+
+		sim_stat.ef_sq += D * D;
+
+		D = m.X[2] - pm.s_track;
+
+		sim_stat.ws_sq += D * D;
+		sim_stat.wh += m.iP * m.dT / 3600.;
+		sim_stat.fq += 1. / m.dT;
+		sim_stat.N++;
+
 		if (fdTel != NULL) {
 
 			/* Collect telemetry.
@@ -198,6 +326,8 @@ sim_test_BASE(FILE *fdTel)
 	pm.dc_resolution = m.PWM_R;
 	pm.proc_set_DC = &blmDC;
 	pm.proc_set_Z = &blmZ;
+	pm.proc_set_FREQ = &blmFREQ;
+	pm.proc_mark = &sim_pm_mark;
 
 	pm_default(&pm);
 
@@ -296,6 +426,79 @@ sim_test_BASE(FILE *fdTel)
 	return 1;
 }
 
+static int
+sim_test_DRIFT(FILE *fdTel)
+{
+	double		bias_A, bias_B, ad_A, ad_B;
+
+	t_prologue();
+
+	bias_A = 5E-2;
+	bias_B = - 1E-1;
+
+	m.bias_I[0] = bias_A;
+	m.bias_I[1] = bias_B;
+
+	/* Sensor offset has changed since ZERO_DRIFT as after a power cycle
+	 * with offsets restored from flash. Bridge is in Z state in IDLE.
+	 * */
+	sim_F(fdTel, 2.);
+
+	printf("drift[AB] %.4f %.4f (A)\n", pm.drift_IA, pm.drift_IB);
+
+	t_assert(pm.fail_reason == PM_OK);
+	t_assert(fabs(pm.drift_IA + bias_A) < 2E-2);
+	t_assert(fabs(pm.drift_IB + bias_B) < 2E-2);
+
+	pm.fsm_req = PM_STATE_LU_STARTUP;
+	sim_F(fdTel, 0.);
+
+	t_assert(pm.fail_reason == PM_OK);
+
+	pm.s_setpoint = .2f * m.U / m.E;
+	sim_F(fdTel, 1.);
+
+	t_assert(pm.fail_reason == PM_OK);
+	t_assert_ref(pm.lu_wS, pm.s_setpoint);
+
+	pm.s_setpoint = 0.f;
+	sim_F(fdTel, 1.);
+
+	pm.fsm_req = PM_STATE_LU_SHUTDOWN;
+	sim_F(fdTel, 0.);
+
+	t_assert(pm.fail_reason == PM_OK);
+
+	m.bias_I[0] = 0.;
+	m.bias_I[1] = 0.;
+
+	sim_F(fdTel, 2.);
+
+	printf("drift[AB] %.4f %.4f (A)\n", pm.drift_IA, pm.drift_IB);
+
+	t_assert(fabs(pm.drift_IA) < 2E-2);
+	t_assert(fabs(pm.drift_IB) < 2E-2);
+
+	/* Offsets restored from flash are far off so the tracker requests
+	 * the complete ZERO_DRIFT.
+	 * */
+	ad_A = pm.ad_IA[0];
+	ad_B = pm.ad_IB[0];
+
+	pm.ad_IA[0] += 1.5f * pm.fault_current_tol;
+	pm.ad_IB[0] += - 1.5f * pm.fault_current_tol;
+
+	sim_F(fdTel, 2.);
+
+	printf("Z[AB] %.4f %.4f (A)\n", pm.ad_IA[0], pm.ad_IB[0]);
+
+	t_assert(pm.fail_reason == PM_OK);
+	t_assert(fabs(pm.ad_IA[0] - ad_A) < 2E-2);
+	t_assert(fabs(pm.ad_IB[0] - ad_B) < 2E-2);
+
+	return 1;
+}
+
 static int
 sim_test_SPEED(FILE *fdTel)
 {
@@ -335,6 +538,506 @@ sim_test_SPEED(FILE *fdTel)
 	return 1;
 }
 
+static void
+sim_can_send(void *bus, const can_msg_t *msg, int N)
+{
+	int		j;
+
+	for (j = 0; j < N; ++j) {
+
+		if (sim_bus.N < sizeof(sim_bus.msg) / sizeof(sim_bus.msg[0]))
+			sim_bus.msg[sim_bus.N++] = msg[j];
+	}
+}
+
+static int
+sim_can_reg(void *reg, const unsigned char *req, int len,
+		unsigned char *resp, int max)
+{
+	int		j;
+
+	/* Response of 10 bytes takes two chunks.
+	 * */
+	for (j = 0; j < 10; ++j)
+		resp[j] = req[j % len];
+
+	return 10;
+}
+
+static void
+sim_can_frame(canproto_t *cp, int func, int node, int len, const void *data)
+{
+	can_msg_t	msg;
+
+	msg.ID = CANPROTO_ID(func, node);
+	msg.len = len;
+
+	memcpy(msg.payload, data, len);
+
+	canproto_input(cp, &msg);
+}
+
+static int
+sim_test_CAN(FILE *fdTel)
+{
+	canproto_t	cp = { 0 };
+	unsigned char	cmd;
+	float		wSP, wS, x;
+	int		N;
+
+	t_prologue();
+
+	cp.node_ID = 5;
+	cp.state_ms = 10;
+	cp.pm = &pm;
+	cp.proc_send = &sim_can_send;
+	cp.proc_reg = &sim_can_reg;
+
+	pm.config_DRIVE = PM_DRIVE_SPEED;
+	pm.s_setpoint = 0.f;
+
+	cmd = CANPROTO_NMT_START;
+	sim_can_frame(&cp, CANPROTO_NMT, 0, 1, &cmd);
+
+	t_assert(pm.fsm_req == PM_STATE_LU_STARTUP);
+
+	sim_F(fdTel, 0.);
+
+	t_assert(pm.fail_reason == PM_OK);
+
+	/* Setpoint to another node is ignored.
+	 * */
+	wSP = .2f * m.U / m.E;
+
+	sim_can_frame(&cp, CANPROTO_SPEED, 6, 4, &wSP);
+	t_assert(pm.s_setpoint == 0.f);
+
+	sim_can_frame(&cp, CANPROTO_SPEED, 5, 4, &wSP);
+	t_assert(pm.s_setpoint == wSP);
+
+	for (N = 0; N < 200; ++N) {
+
+		sim_F(fdTel, .01);
+
+		sim_bus.N = 0;
+		canproto_periodic(&cp, (unsigned long) (m.Tsim * 1000. + .5));
+	}
+
+	t_assert(pm.fail_reason == PM_OK);
+	t_assert(sim_bus.N == 2);
+	t_assert(sim_bus.msg[0].ID == CANPROTO_ID(CANPROTO_STATE, 5));
+	t_assert(sim_bus.msg[1].ID == CANPROTO_ID(CANPROTO_STATUS, 5));
+	t_assert(sim_bus.msg[1].payload[0] == PM_STATE_IDLE);
+
+	memcpy(&wS, sim_bus.msg[0].payload + 4, 4);
+
+	printf("wSP %.2f (rad/s)\n", wSP);
+	printf("STATE wS %.2f (rad/s)\n", wS);
+
+	t_assert_ref(wS, wSP);
+
+	/* Position is split into revolutions.
+	 * */
+	x = 7.f;
+	sim_can_frame(&cp, CANPROTO_SERVO, 5, 4, &x);
+
+	t_assert(pm.x_setpoint_revol == 1);
+	t_assert(fabs(atan2(pm.x_setpoint_F[1], pm.x_setpoint_F[0])
+				- (7. - 2. * M_PI)) < 1E-3);
+
+	/* Register response is split into chunks.
+	 * */
+	sim_bus.N = 0;
+	sim_can_frame(&cp, CANPROTO_REG_REQ, 5, 4, "R\x01\x02\x00");
+
+	t_assert(sim_bus.N == 2);
+	t_assert(sim_bus.msg[0].ID == CANPROTO_ID(CANPROTO_REG_RESP, 5));
+	t_assert(sim_bus.msg[0].len == 8 && sim_bus.msg[0].payload[0] == 0x00);
+	t_assert(sim_bus.msg[1].len == 4 && sim_bus.msg[1].payload[0] == 0x81);
+	t_assert(sim_bus.msg[1].payload[3] == 0x01);
+
+	sim_bus.N = 0;
+	sim_can_frame(&cp, CANPROTO_REG_REQ, 0, 4, "R\x01\x02\x00");
+
+	t_assert(sim_bus.N == 0);
+
+	pm.s_setpoint = 0.f;
+	sim_F(fdTel, 1.);
+
+	cmd = CANPROTO_NMT_STOP;
+	sim_can_frame(&cp, CANPROTO_NMT, 5, 1, &cmd);
+
+	t_assert(pm.fsm_req == PM_STATE_LU_SHUTDOWN);
+
+	sim_F(fdTel, 0.);
+
+	t_assert(pm.fail_reason == PM_OK);
+
+	return 1;
+}
+
+static int
+sim_test_EKF(FILE *fdTel)
+{
+	double		wSP, ef_rms[2], ef_load[2], tm_settle;
+	int		N, J;
+
+	t_prologue();
+
+	for (N = 0; N < 2; ++N) {
+
+		pm.config_EKF = (N == 0) ? PM_DISABLED : PM_ENABLED;
+
+		pm.fsm_req = PM_STATE_LU_STARTUP;
+		sim_F(fdTel, 0.);
+
+		t_assert(pm.fail_reason == PM_OK);
+
+		/* Low speed run.
+		 * */
+		wSP = .1 * m.U / m.E;
+		pm.s_setpoint = wSP;
+		sim_F(fdTel, 1.);
+
+		t_assert(pm.fail_reason == PM_OK);
+
+		sim_stat.ef_sq = 0.;
+		sim_stat.ws_sq = 0.;
+		sim_stat.N = 0;
+
+		sim_prof_reset();
+		sim_F(fdTel, 1.);
+
+		ef_rms[N] = sqrt(sim_stat.ef_sq / sim_stat.N);
+
+		printf("lu_mode %s\n", (pm.lu_mode == PM_LU_ESTIMATE_EKF) ? "EKF" : "FLUX");
+		sim_prof_print();
+		printf("eF rms %.2f (g)\n", ef_rms[N] * 180. / M_PI);
+		printf("lu_wS %.2f (rpm)\n", pm.lu_wS * 30. / M_PI / m.Zp);
+
+		t_assert(pm.fail_reason == PM_OK);
+		t_assert(pm.lu_mode == ((N == 0) ? PM_LU_ESTIMATE_FLUX : PM_LU_ESTIMATE_EKF));
+		t_assert_ref(pm.lu_wS, wSP);
+
+		/* Load step of 10% of maximal current equivalent torque
+		 * that takes speed out of 2% band for a while.
+		 * */
+		m.M[0] = - 1.5 * m.Zp * m.E * .1 * pm.i_maximal;
+		tm_settle = 0.;
+
+		sim_stat.ef_sq = 0.;
+		sim_stat.N = 0;
+
+		for (J = 0; J < 500; ++J) {
+
+			sim_F(fdTel, 1E-3);
+
+			if (fabs(m.X[2] - wSP) > .02 * wSP) {
+
+				tm_settle = (J + 1) * 1E-3;
+			}
+		}
+
+		m.M[0] = 0.;
+
+		ef_load[N] = sqrt(sim_stat.ef_sq / sim_stat.N);
+
+		printf("load step settle %.1f (ms)\n", tm_settle * 1E+3);
+		printf("load step eF rms %.2f (g)\n", ef_load[N] * 180. / M_PI);
+
+		t_assert(pm.fail_reason == PM_OK);
+		t_assert(tm_settle > 0.);
+		t_assert(tm_settle < .5);
+		t_assert_ref(pm.lu_wS, wSP);
+
+		pm.s_setpoint = 0.f;
+		sim_F(fdTel, 1.);
+
+		t_assert(pm.fail_reason == PM_OK);
+
+		pm.fsm_req = PM_STATE_LU_SHUTDOWN;
+		sim_F(fdTel, 0.);
+
+		t_assert(pm.fail_reason == PM_OK);
+	}
+
+	pm.config_EKF = PM_DISABLED;
+
+	/* EKF is expected to be at least as accurate as FLUX.
+	 * */
+	t_assert(ef_rms[1] < ef_rms[0] * 1.1);
+	t_assert(ef_load[1] < ef_load[0] * 1.1);
+
+	return 1;
+}
+
+static int
+sim_test_DUAL(FILE *fdTel)
+{
+	double		wSP, iSP, J0, P0, iQ[40], tm_rise[2];
+	int		N, K, J;
+
+	t_prologue();
+
+	J0 = m.J;
+	P0 = pm.i_gain_P;
+
+	for (N = 0; N < 2; ++N) {
+
+		/* Double update halves the loop delay so we are able to
+		 * double the proportional gain.
+		 * */
+		m.DUAL = N;
+		pm.i_gain_P = (N == 0) ? P0 : 2. * P0;
+
+		pm.fsm_req = PM_STATE_LU_STARTUP;
+		sim_F(fdTel, 0.);
+
+		t_assert(pm.fail_reason == PM_OK);
+
+		wSP = .2 * m.U / m.E;
+		pm.s_setpoint = wSP;
+		sim_F(fdTel, 1.);
+
+		t_assert(pm.fail_reason == PM_OK);
+		t_assert_ref(pm.lu_wS, wSP);
+
+		/* Keep the speed constant during the current step.
+		 * */
+		m.J = 1E+2;
+
+		iSP = 5.;
+		pm.config_DRIVE = PM_DRIVE_CURRENT;
+		pm.i_setpoint_Q = iSP;
+		sim_F(fdTel, .1);
+
+		t_assert(pm.fail_reason == PM_OK);
+
+		for (J = 0; J < 40; ++J)
+			iQ[J] = 0.;
+
+		/* Current steps of 2 (A) averaged over a few periods.
+		 * */
+		for (K = 0; K < 20; ++K) {
+
+			pm.i_setpoint_Q = iSP + 2.;
+
+			for (J = 0; J < 40; ++J) {
+
+				sim_F(fdTel, 0.);
+				iQ[J] += m.X[1] / 20.;
+			}
+
+			pm.i_setpoint_Q = iSP;
+			sim_F(fdTel, 2E-3);
+		}
+
+		for (J = 0; J < 40; ++J) {
+
+			if (iQ[J] > iSP + 1.8)
+				break;
+		}
+
+		tm_rise[N] = (J + 1) * m.dT;
+
+		printf("DUAL %i rise time %.1f (us)\n", N, tm_rise[N] * 1E+6);
+
+		t_assert(pm.fail_reason == PM_OK);
+		t_assert_ref(iQ[39], iSP + 2.);
+
+		m.J = J0;
+
+		pm.config_DRIVE = PM_DRIVE_SPEED;
+		pm.s_setpoint = 0.f;
+		sim_F(fdTel, 1.);
+
+		pm.fsm_req = PM_STATE_LU_SHUTDOWN;
+		sim_F(fdTel, 0.);
+
+		t_assert(pm.fail_reason == PM_OK);
+	}
+
+	m.DUAL = 0;
+	pm.i_gain_P = P0;
+
+	t_assert(tm_rise[1] < tm_rise[0]);
+
+	return 1;
+}
+
+static int
+sim_test_VSF(FILE *fdTel)
+{
+	const double	cycle[5][2] = {
+
+		{ .1, 0. }, { .3, 0. }, { .3, 10. }, { .5, 0. }, { .1, 0. }
+	};
+
+	double		wSP, wh[2], fq, Tsw, Coss;
+	float		gain_I, gain_LP_S;
+	int		N, J;
+
+	t_prologue();
+
+	/* Power stage with slow FETs where switching losses are noticeable.
+	 * */
+	Tsw = m.Tsw;
+	Coss = m.Coss;
+
+	m.Tsw = 200E-9;
+	m.Coss = 5E-9;
+
+	gain_I = pm.i_gain_I;
+	gain_LP_S = pm.lu_gain_LP_S;
+
+	for (N = 0; N < 2; ++N) {
+
+		pm.config_VSF = (N == 0) ? PM_DISABLED : PM_ENABLED;
+
+		/* Start from the same plant state.
+		 * */
+		m.X[2] = 0.;
+		m.X[4] = 25.;
+
+		pm.fsm_req = PM_STATE_LU_STARTUP;
+		sim_F(fdTel, 0.);
+
+		t_assert(pm.fail_reason == PM_OK);
+
+		wh[N] = 0.;
+		fq = 0.;
+
+		/* Drive cycle of speed and load steps. We collect the
+		 * energy in steady state only.
+		 * */
+		for (J = 0; J < 5; ++J) {
+
+			wSP = cycle[J][0] * m.U / m.E;
+			pm.s_setpoint = wSP;
+			m.M[0] = - 1.5 * m.Zp * m.E * cycle[J][1];
+
+			sim_F(fdTel, 1.);
+
+			sim_stat.wh = 0.;
+			sim_stat.fq = 0.;
+			sim_stat.N = 0;
+
+			sim_F(fdTel, 1.);
+
+			wh[N] += sim_stat.wh;
+			fq += sim_stat.fq / sim_stat.N / 5.;
+
+			t_assert(pm.fail_reason == PM_OK);
+			t_assert_ref(pm.lu_wS, wSP);
+		}
+
+		m.M[0] = 0.;
+
+		printf("VSF %i energy %.4f (Wh) mean freq %.1f (kHz)\n",
+				N, wh[N], fq * 1E-3);
+
+		pm.s_setpoint = 0.f;
+		sim_F(fdTel, 1.);
+
+		t_assert(pm.fail_reason == PM_OK);
+
+		pm.fsm_req = PM_STATE_LU_SHUTDOWN;
+		sim_F(fdTel, 0.);
+
+		t_assert(pm.fail_reason == PM_OK);
+		t_assert(fabs(pm.freq_hz - pm.vsf_freq_base) < 1.);
+
+		/* Configuration is kept at the base frequency.
+		 * */
+		t_assert(pm.i_gain_I == gain_I);
+		t_assert(pm.lu_gain_LP_S == gain_LP_S);
+	}
+
+	pm.config_VSF = PM_DISABLED;
+
+	m.Tsw = Tsw;
+	m.Coss = Coss;
+
+	printf("VSF gain %.2f (%%)\n", 100. * (wh[0] - wh[1]) / wh[0]);
+
+	/* Fixed drive cycle gives about 1 % gain with this power stage so
+	 * we require at least a half of it.
+	 * */
+	t_assert(wh[1] < wh[0] * .995);
+
+	return 1;
+}
+
+static int
+sim_test_COGG(FILE *fdTel)
+{
+	double		wSP, ws_rms[2];
+	int		N;
+
+	t_prologue();
+
+	/* Cogging of 2 (A) equivalent torque.
+	 * */
+	m.M[3] = 1.5 * m.Zp * m.E * 2.;
+
+	pm.config_COGG = PM_COGG_DISABLED;
+
+	for (N = 0; N < PM_COGG_MAX; ++N)
+		pm.cogg_T[N] = 0.f;
+
+	pm.fsm_req = PM_STATE_LU_STARTUP;
+	sim_F(fdTel, 0.);
+
+	t_assert(pm.fail_reason == PM_OK);
+
+	wSP = .1 * m.U / m.E;
+	pm.s_setpoint = wSP;
+	sim_F(fdTel, 1.);
+
+	t_assert(pm.fail_reason == PM_OK);
+
+	for (N = 0; N < 2; ++N) {
+
+		sim_stat.ws_sq = 0.;
+		sim_stat.N = 0;
+
+		sim_F(fdTel, 1.);
+
+		ws_rms[N] = sqrt(sim_stat.ws_sq / sim_stat.N);
+
+		printf("wS ripple %.3f (rpm)\n", ws_rms[N] * 30. / M_PI / m.Zp);
+
+		t_assert(pm.fail_reason == PM_OK);
+
+		if (N == 0) {
+
+			/* Learn the table and apply it then.
+			 * */
+			pm.config_COGG = PM_COGG_LEARN;
+			sim_F(fdTel, 20.);
+
+			pm.config_COGG = PM_COGG_APPLY;
+		}
+	}
+
+	t_assert(ws_rms[1] < .5 * ws_rms[0]);
+
+	m.M[3] = 0.;
+	pm.config_COGG = PM_COGG_DISABLED;
+
+	pm.s_setpoint = 0.f;
+	sim_F(fdTel, 1.);
+
+	t_assert(pm.fail_reason == PM_OK);
+
+	pm.fsm_req = PM_STATE_LU_SHUTDOWN;
+	sim_F(fdTel, 0.);
+
+	t_assert(pm.fail_reason == PM_OK);
+
+	return 1;
+}
+
 static int
 sim_test_HFI(FILE *fdTel)
 {
@@ -412,6 +1115,24 @@ sim_TEST(FILE *fdTel)
 	if (sim_test_SPEED(NULL) == 0)
 		return 0;
 
+	if (sim_test_CAN(NULL) == 0)
+		return 0;
+
+	if (sim_test_DRIFT(NULL) == 0)
+		return 0;
+
+	if (sim_test_EKF(NULL) == 0)
+		return 0;
+
+	if (sim_test_DUAL(NULL) == 0)
+		return 0;
+
+	if (sim_test_VSF(NULL) == 0)
+		return 0;
+
+	if (sim_test_COGG(NULL) == 0)
+		return 0;
+
 	if (sim_test_HFI(NULL) == 0)
 		return 0;
 
@@ -441,6 +1162,9 @@ sim_TEST(FILE *fdTel)
 	if (sim_test_SPEED(NULL) == 0)
 		return 0;
 
+	if (sim_test_EKF(NULL) == 0)
+		return 0;
+
 	return 1;
 }
 
@@ -0,0 +1,372 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "../src/telpack.h"
+
+/* Host decoder of the packed telemetry. Read the output of tel_pack_dump
+ * from stdin and print the same table as tel_flush_sync does. With -f option
+ * read binary frames of tel_flush_frame or tel_live_frame and write float
+ * rows in the same format as simulator TEL file.
+ * */
+
+#define TEL_LINE_MAX		(TELPACK_BLOCK_SIZE * 2 + 80)
+#define TEL_FRAME_MAX		(TELPACK_BLOCK_SIZE + 80)
+
+static struct {
+
+	int		type;
+	double		scale;
+	double		gain;
+	int		digits;
+	int		q;
+}
+ch[TELPACK_CHANNEL_MAX];
+
+static int		chN, qN;
+
+static FILE		*fdTel;
+
+static void
+teldec_chan(int type, double scale, double gain)
+{
+	ch[chN].type = type;
+	ch[chN].scale = scale;
+	ch[chN].gain = gain;
+	ch[chN].digits = 2;
+	ch[chN].q = qN;
+
+	if (type == 'f') {
+
+		for (ch[chN].digits = 0; scale > 1.5; scale /= 10.)
+			ch[chN].digits++;
+	}
+
+	qN += (type == 'a') ? 2 : 1;
+	chN++;
+}
+
+static int
+teldec_desc(char *s)
+{
+	char		*tok;
+	double		scale, gain;
+
+	chN = 0;
+	qN = 0;
+
+	for (tok = strtok(s, ";\r\n"); tok != NULL; tok = strtok(NULL, ";\r\n")) {
+
+		if (chN >= TELPACK_CHANNEL_MAX)
+			return 0;
+
+		scale = strtod(tok + 1, NULL);
+		gain = strtod(strchr(tok + 2, ' '), NULL);
+
+		teldec_chan(tok[0], scale, gain);
+	}
+
+	return (chN > 0 && qN <= TELPACK_CHANNEL_MAX) ? 1 : 0;
+}
+
+static double
+teldec_value(int N, const int *q)
+{
+	union {
+		float		f;
+		int		i;
+	}
+	raw;
+
+	double		value;
+
+	switch (ch[N].type) {
+
+		case 'a':
+			value = atan2((double) q[ch[N].q + 1], (double) q[ch[N].q])
+				* 180. / M_PI;
+			break;
+
+		case 'f':
+			value = (double) q[ch[N].q] / ch[N].scale * ch[N].gain;
+			break;
+
+		case 'e':
+			raw.i = q[ch[N].q];
+			value = (double) raw.f;
+			break;
+
+		default:
+			value = (double) q[ch[N].q];
+			break;
+	}
+
+	return value;
+}
+
+static void
+teldec_row(const int *q)
+{
+	float		Tel[TELPACK_CHANNEL_MAX];
+	int		N;
+
+	if (fdTel != NULL) {
+
+		for (N = 0; N < chN; ++N)
+			Tel[N] = (float) teldec_value(N, q);
+
+		fwrite(Tel, sizeof(float), chN, fdTel);
+		return ;
+	}
+
+	for (N = 0; N < chN; ++N) {
+
+		switch (ch[N].type) {
+
+			case 'e':
+				printf("%.4e;", teldec_value(N, q));
+				break;
+
+			case 'i':
+				printf("%i;", q[ch[N].q]);
+				break;
+
+			default:
+				printf("%.*f;", ch[N].digits, teldec_value(N, q));
+				break;
+		}
+	}
+
+	puts("");
+}
+
+static int
+teldec_block(const unsigned char *block, int len)
+{
+	telpack_iter_t		it;
+
+	if (len < 2)
+		return 0;
+
+	telpack_iter(&it, block, qN);
+
+	while (it.p < block + len && telpack_next(&it) != 0)
+		teldec_row(it.q);
+
+	if (it.k < it.n || it.p > block + len) {
+
+		fprintf(stderr, "teldec: truncated block\n");
+		return 0;
+	}
+
+	return 1;
+}
+
+static int
+teldec_text()
+{
+	static char		line[TEL_LINE_MAX];
+	unsigned char		block[TELPACK_BLOCK_SIZE + TELPACK_CHANNEL_MAX * 5];
+	unsigned int		byte;
+	const char		*s;
+	int			len;
+
+	/* Labels are passed as is.
+	 * */
+	if (fgets(line, sizeof(line), stdin) == NULL)
+		return 1;
+
+	fputs(line, stdout);
+
+	if (fgets(line, sizeof(line), stdin) == NULL
+			|| teldec_desc(line) == 0) {
+
+		fprintf(stderr, "teldec: invalid channel descriptors\n");
+		return 1;
+	}
+
+	while (fgets(line, sizeof(line), stdin) != NULL) {
+
+		memset(block, 0, sizeof(block));
+
+		for (s = line, len = 0; len < TELPACK_BLOCK_SIZE
+				&& sscanf(s, "%2x", &byte) == 1; s += 2)
+			block[len++] = (unsigned char) byte;
+
+		if (teldec_block(block, len) == 0)
+			break;
+	}
+
+	return 0;
+}
+
+static unsigned long
+teldec_crc32(const unsigned char *s, int n)
+{
+	unsigned long		crc = 0xFFFFFFFFUL;
+	int			j;
+
+	while (n >= 1) {
+
+		crc ^= *s++;
+		n--;
+
+		for (j = 0; j < 8; ++j)
+			crc = (crc >> 1) ^ (0xEDB88320UL & - (crc & 1UL));
+	}
+
+	return ~crc & 0xFFFFFFFFUL;
+}
+
+static void
+teldec_header(const unsigned char *p, int len)
+{
+	const unsigned char	*end = p + len;
+	float			scale, gain;
+	int			N, type, pN;
+
+	pN = *p++;
+
+	chN = 0;
+	qN = 0;
+
+	fprintf(stderr, "teldec: header\n");
+
+	for (N = 0; N < pN && N < TELPACK_CHANNEL_MAX && p + 9 < end; ++N) {
+
+		type = *p++;
+
+		memcpy(&scale, p, sizeof(float));
+		memcpy(&gain, p + 4, sizeof(float));
+		p += 8;
+
+		teldec_chan(type, scale, gain);
+
+		/* Print symbol and unit of the column.
+		 * */
+		fprintf(stderr, "  [%i] %s", N, (const char *) p);
+		p += strlen((const char *) p) + 1;
+
+		fprintf(stderr, " (%s)\n", (const char *) p);
+		p += strlen((const char *) p) + 1;
+	}
+}
+
+static void
+teldec_frame(const unsigned char *frame, int len)
+{
+	static int		seq = -1;
+	unsigned long		crc;
+	int			next;
+
+	if (len < 5)
+		return ;
+
+	len -= 4;
+
+	crc = frame[len] | (frame[len + 1] << 8)
+		| (frame[len + 2] << 16) | ((unsigned long) frame[len + 3] << 24);
+
+	if (teldec_crc32(frame, len) != crc) {
+
+		fprintf(stderr, "teldec: CRC mismatch\n");
+		return ;
+	}
+
+	if (frame[0] == 'H') {
+
+		teldec_header(frame + 1, len - 1);
+	}
+	else if (frame[0] == 'B' && len > 3 && chN > 0) {
+
+		next = frame[1] | (frame[2] << 8);
+
+		if (seq >= 0 && next != ((seq + 1) & 0xFFFF)) {
+
+			fprintf(stderr, "teldec: lost %i frames\n",
+					(next - seq - 1) & 0xFFFF);
+		}
+
+		seq = next;
+
+		teldec_block(frame + 3, len - 3);
+	}
+}
+
+static int
+teldec_binary()
+{
+	unsigned char		frame[TEL_FRAME_MAX];
+	int			c, code = 0, rem = 0, len = 0, lost = 0;
+
+	while ((c = fgetc(stdin)) != EOF) {
+
+		if (c == 0) {
+
+			/* End of COBS frame. Drop the trailing implicit zero.
+			 * */
+			if (lost == 0 && rem == 0 && len > 0) {
+
+				len -= (code < 0xFF) ? 1 : 0;
+				teldec_frame(frame, len);
+			}
+
+			code = 0;
+			rem = 0;
+			len = 0;
+			lost = 0;
+		}
+		else if (lost != 0) {
+
+			continue;
+		}
+		else if (len + 2 >= TEL_FRAME_MAX) {
+
+			lost = 1;
+		}
+		else {
+			if (rem == 0) {
+
+				code = c;
+				rem = c;
+			}
+			else {
+				frame[len++] = (unsigned char) c;
+			}
+
+			if (--rem == 0 && code < 0xFF) {
+
+				frame[len++] = 0;
+			}
+		}
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int		rc;
+
+	if (argc == 3 && strcmp(argv[1], "-f") == 0) {
+
+		fdTel = fopen(argv[2], "wb");
+
+		if (fdTel == NULL) {
+
+			fprintf(stderr, "fopen: %s\n", argv[2]);
+			return 1;
+		}
+
+		rc = teldec_binary();
+
+		fclose(fdTel);
+	}
+	else {
+		rc = teldec_text();
+	}
+
+	return rc;
+}
+
@@ -0,0 +1,2 @@
+#include "../src/telpack.c"
+
@@ -0,0 +1,196 @@
+#include <stddef.h>
+
+#include "phobia/libm.h"
+#include "phobia/pm.h"
+
+#include "canproto.h"
+
+typedef union {
+
+	float		f;
+	unsigned int	u;
+}
+canproto_val_t;
+
+static float
+canproto_get_F(const unsigned char *p)
+{
+	canproto_val_t		v;
+
+	v.u = p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int) p[3] << 24);
+
+	return v.f;
+}
+
+static void
+canproto_put_F(unsigned char *p, float x)
+{
+	canproto_val_t		v = { x };
+
+	p[0] = (unsigned char) (v.u);
+	p[1] = (unsigned char) (v.u >> 8);
+	p[2] = (unsigned char) (v.u >> 16);
+	p[3] = (unsigned char) (v.u >> 24);
+}
+
+static void
+canproto_head(canproto_t *cp, can_msg_t *msg, int func, int len)
+{
+	msg->ID = CANPROTO_ID(func, cp->node_ID);
+	msg->len = len;
+}
+
+static void
+canproto_send(canproto_t *cp, const can_msg_t *msg, int N)
+{
+	cp->proc_send(cp->bus, msg, N);
+	cp->tx_N += N;
+}
+
+static void
+canproto_servo(canproto_t *cp, float angle)
+{
+	pmc_t			*pm = cp->pm;
+	float			f_cosine, f_sine;
+	int			revol;
+
+	/* Split the position into full revolutions and the angle in the
+	 * range of -PI to PI as servo loop expects.
+	 * */
+	revol = (int) (angle / (2.f * M_PI_F));
+	angle -= (float) (revol * 2.f * M_PI_F);
+
+	if (angle < - M_PI_F) {
+
+		revol -= 1;
+		angle += 2.f * M_PI_F;
+	}
+
+	if (angle > M_PI_F) {
+
+		revol += 1;
+		angle -= 2.f * M_PI_F;
+	}
+
+	f_cosine = m_cosf(angle);
+	f_sine = m_sinf(angle);
+
+	if (cp->proc_lock != NULL)
+		cp->proc_lock(1);
+
+	pm->x_setpoint_F[0] = f_cosine;
+	pm->x_setpoint_F[1] = f_sine;
+	pm->x_setpoint_revol = revol;
+
+	if (cp->proc_lock != NULL)
+		cp->proc_lock(0);
+}
+
+static void
+canproto_reg(canproto_t *cp, const can_msg_t *msg)
+{
+	unsigned char		resp[CANPROTO_RESP_MAX];
+	can_msg_t		chunk[(CANPROTO_RESP_MAX + 6) / 7];
+	int			len, N, j;
+
+	if (cp->proc_reg == NULL)
+		return ;
+
+	len = cp->proc_reg(cp->reg, msg->payload, msg->len, resp, sizeof(resp));
+
+	for (N = 0; N * 7 < len; ++N) {
+
+		for (j = 0; j < 7 && N * 7 + j < len; ++j)
+			chunk[N].payload[j + 1] = resp[N * 7 + j];
+
+		canproto_head(cp, &chunk[N], CANPROTO_REG_RESP, j + 1);
+
+		chunk[N].payload[0] = (unsigned char) N;
+		chunk[N].payload[0] |= (N * 7 + j >= len) ? 0x80U : 0U;
+	}
+
+	/* All chunks are sent as one burst.
+	 * */
+	if (N > 0)
+		canproto_send(cp, chunk, N);
+}
+
+void canproto_input(canproto_t *cp, const can_msg_t *msg)
+{
+	int			func, node;
+
+	func = CANPROTO_FUNC(msg->ID);
+	node = CANPROTO_NODE(msg->ID);
+
+	if (		cp->node_ID < 1 || msg->ID > 0x7FFUL
+			|| (node != cp->node_ID && node != 0))
+		return ;
+
+	cp->rx_N++;
+
+	switch (func) {
+
+		case CANPROTO_NMT:
+			if (msg->len < 1)
+				break;
+
+			if (msg->payload[0] == CANPROTO_NMT_START)
+				cp->pm->fsm_req = PM_STATE_LU_STARTUP;
+			else if (msg->payload[0] == CANPROTO_NMT_STOP)
+				cp->pm->fsm_req = PM_STATE_LU_SHUTDOWN;
+			break;
+
+		case CANPROTO_CURRENT:
+			if (msg->len >= 4)
+				cp->pm->i_setpoint_Q = canproto_get_F(msg->payload);
+			break;
+
+		case CANPROTO_SPEED:
+			if (msg->len >= 4)
+				cp->pm->s_setpoint = canproto_get_F(msg->payload);
+			break;
+
+		case CANPROTO_SERVO:
+			if (msg->len >= 4)
+				canproto_servo(cp, canproto_get_F(msg->payload));
+			break;
+
+		case CANPROTO_REG_REQ:
+			/* Only addressed requests are answered as the
+			 * response chunks do not carry the request.
+			 * */
+			if (node == cp->node_ID && msg->len >= 2)
+				canproto_reg(cp, msg);
+			break;
+
+		default: break;
+	}
+}
+
+void canproto_periodic(canproto_t *cp, unsigned long clock_ms)
+{
+	pmc_t			*pm = cp->pm;
+	can_msg_t		msg[2];
+
+	if (cp->node_ID < 1 || cp->state_ms < 1)
+		return ;
+
+	if (clock_ms - cp->state_clock < (unsigned long) cp->state_ms)
+		return ;
+
+	cp->state_clock = clock_ms;
+
+	canproto_head(cp, &msg[0], CANPROTO_STATE, 8);
+	canproto_put_F(msg[0].payload + 0, pm->lu_iQ);
+	canproto_put_F(msg[0].payload + 4, pm->lu_wS);
+
+	canproto_head(cp, &msg[1], CANPROTO_STATUS, 8);
+	msg[1].payload[0] = (unsigned char) pm->fsm_state;
+	msg[1].payload[1] = (unsigned char) pm->fail_reason;
+	msg[1].payload[2] = (unsigned char) pm->lu_mode;
+	msg[1].payload[3] = 0;
+	canproto_put_F(msg[1].payload + 4, pm->const_lpf_U);
+
+	canproto_send(cp, msg, 2);
+}
+
@@ -0,0 +1,75 @@
+#ifndef _H_CANPROTO_
+#define _H_CANPROTO_
+
+#include "phobia/pm.h"
+
+#include "canring.h"
+
+#define CANPROTO_NODE_MAX		127
+#define CANPROTO_RESP_MAX		126
+
+#define CANPROTO_ID(func, node)		(((unsigned long) (func) << 7) | (node))
+#define CANPROTO_FUNC(ID)		((int) ((ID) >> 7) & 0xF)
+#define CANPROTO_NODE(ID)		((int) (ID) & 0x7F)
+
+/* CAN protocol of the controller. Standard 11-bit identifier consists of the
+ * function code (upper 4 bits) and node number (lower 7 bits), so the lower
+ * function code wins the arbitration. Node number 0 in the setpoint and NMT
+ * frames addresses all nodes at once. Values are 32-bit little-endian.
+ *
+ * NMT      ->  [cmd8]                Start (1) or stop (2) the motor.
+ * CURRENT  ->  [iQ32]                Current setpoint (A).
+ * SPEED    ->  [wS32]                Speed setpoint (rad/s).
+ * SERVO    ->  [xF32]                Position setpoint (rad).
+ * STATE    <-  [iQ32][wS32]          Broadcast of the current and speed.
+ * STATUS   <-  [state8][fail8][lu8][0][uDC32]
+ * REG_REQ  ->  [op8][seq8]...        Register request as binary protocol.
+ * REG_RESP <-  [hdr8][data]...       Response split into 7-byte chunks.
+ *
+ * Register request must fit into the single frame. The header byte of the
+ * response chunk is the chunk number with bit 7 set in the last one. Frames
+ * that belong together (state broadcast, response chunks) are passed to the
+ * transport as one burst.
+ * */
+
+enum {
+	CANPROTO_NMT			= 0,
+	CANPROTO_CURRENT,
+	CANPROTO_SPEED,
+	CANPROTO_SERVO,
+	CANPROTO_STATE,
+	CANPROTO_STATUS,
+	CANPROTO_REG_REQ,
+	CANPROTO_REG_RESP
+};
+
+enum {
+	CANPROTO_NMT_START		= 1,
+	CANPROTO_NMT_STOP
+};
+
+typedef struct {
+
+	int			node_ID;
+	int			state_ms;
+
+	unsigned long		state_clock;
+	int			rx_N;
+	int			tx_N;
+
+	pmc_t			*pm;
+	void			*bus;
+	void			*reg;
+
+	void			(* proc_send) (void *bus, const can_msg_t *msg, int N);
+	void			(* proc_lock) (int lock);
+	int			(* proc_reg) (void *reg, const unsigned char *req, int len,
+						unsigned char *resp, int max);
+}
+canproto_t;
+
+void canproto_input(canproto_t *cp, const can_msg_t *msg);
+void canproto_periodic(canproto_t *cp, unsigned long clock_ms);
+
+#endif /* _H_CANPROTO_ */
+
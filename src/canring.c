@@ -0,0 +1,74 @@
+#include <stddef.h>
+
+#include "canring.h"
+
+static unsigned int
+canring_depth(const canring_t *ring)
+{
+	return (ring->depth > 0 && ring->depth < CANRING_SZ)
+		? (unsigned int) ring->depth : CANRING_SZ;
+}
+
+can_msg_t *canring_alloc(canring_t *ring)
+{
+	unsigned int		head, tail;
+
+	head = ring->head;
+	tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	if (head - tail >= canring_depth(ring)) {
+
+		/* Frame is lost as consumer is behind.
+		 * */
+		ring->overflow_N++;
+
+		return NULL;
+	}
+
+	return &ring->msg[head & (CANRING_SZ - 1)];
+}
+
+void canring_commit(canring_t *ring)
+{
+	unsigned int		head, fill;
+
+	head = ring->head + 1U;
+	fill = head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	if ((int) fill > ring->peak_N)
+		ring->peak_N = (int) fill;
+
+	__atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+}
+
+int canring_space(canring_t *ring)
+{
+	unsigned int		fill;
+
+	fill = ring->head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	return (int) (canring_depth(ring) - fill);
+}
+
+int canring_pop(canring_t *ring, can_msg_t *msg)
+{
+	unsigned int		head, tail;
+
+	tail = ring->tail;
+	head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+	if (head == tail)
+		return 0;
+
+	*msg = ring->msg[tail & (CANRING_SZ - 1)];
+
+	__atomic_store_n(&ring->tail, tail + 1U, __ATOMIC_RELEASE);
+
+	return 1;
+}
+
+int canring_count(canring_t *ring)
+{
+	return (int) (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - ring->tail);
+}
+
@@ -0,0 +1,43 @@
+#ifndef _H_CANRING_
+#define _H_CANRING_
+
+#define CANRING_SZ			32
+
+/* Ring of CAN frames between the single producer (RX interrupt) and the
+ * single consumer (CAN task). Each index is written by one side only so no
+ * lock is needed. Indexes run freely and are masked at access, size must be
+ * the power of two. Frame is filled in place between alloc and commit. Depth
+ * limits the number of queued frames below the size if not zero.
+ * */
+
+typedef struct {
+
+	unsigned long		ID;
+	int			len;
+	unsigned char		payload[8];
+}
+can_msg_t;
+
+typedef struct {
+
+	can_msg_t		msg[CANRING_SZ];
+
+	unsigned int		head;
+	unsigned int		tail;
+
+	int			depth;
+	int			overflow_N;
+	int			peak_N;
+}
+canring_t;
+
+can_msg_t *canring_alloc(canring_t *ring);
+void canring_commit(canring_t *ring);
+
+int canring_space(canring_t *ring);
+
+int canring_pop(canring_t *ring, can_msg_t *msg);
+int canring_count(canring_t *ring);
+
+#endif /* _H_CANRING_ */
+
@@ -0,0 +1,12 @@
+#ifndef _H_CRC32_
+#define _H_CRC32_
+
+/* CRC-32 as in zlib or Ethernet (reflected, initial and final inversion). By
+ * default it is computed using slice-by-4 tables in flash, build with
+ * _HW_CRC32 defined to use STM32 CRC unit on aligned blocks instead.
+ * */
+
+unsigned long crc32b(const void *s, int n);
+
+#endif /* _H_CRC32_ */
+
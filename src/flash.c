@@ -3,11 +3,18 @@
 #include "freertos/FreeRTOS.h"
 #include "hal/hal.h"
 
+#include "crc32.h"
 #include "libc.h"
 #include "main.h"
 #include "regfile.h"
 #include "shell.h"
 
+#define FLASH_JOURNAL_MAGIC		0x32474643UL
+#define FLASH_ERASED			(~0UL)
+
+#define FLASH_LEGACY_VERSION		54
+#define FLASH_LEGACY_MAX		(sizeof(flash_legacy_v54) / sizeof(flash_legacy_t) - 1)
+
 typedef struct {
 
 	unsigned long		number;
@@ -17,51 +24,697 @@ typedef struct {
 }
 flash_block_t;
 
-static flash_block_t *
-flash_block_scan()
+typedef struct {
+
+	unsigned long		magic;
+	unsigned long		version;
+	unsigned long		number;
+	unsigned long		crc32;
+}
+flash_head_t;
+
+typedef struct {
+
+	unsigned long		key;
+	unsigned long		value;
+	unsigned long		crc32;
+}
+flash_rec_t;
+
+typedef struct {
+
+	unsigned long		tag;
+	int			ID;
+}
+flash_tag_t;
+
+typedef struct {
+
+	/* Latest legacy block.
+	 * */
+	flash_block_t		*block;
+
+	/* Active journal sector and its next free record.
+	 * */
+	int			sector_N;
+	unsigned long		number;
+	unsigned long		version;
+	flash_rec_t		*tail;
+
+	/* Used space of each sector (offsets of the first and past the
+	 * last used byte).
+	 * */
+	unsigned long		base[FLASH_SECTOR_MAX];
+	unsigned long		fill[FLASH_SECTOR_MAX];
+
+	/* Values as they are stored in the journal.
+	 * */
+	unsigned long		stored[REG_ID_MAX];
+}
+flash_index_t;
+
+typedef struct {
+
+	const char		*sym;
+	int			mode;
+}
+flash_legacy_t;
+
+static flash_index_t		flash_index = { NULL, -1 };
+
+/* Register table of config version 54 that was the last one stored in the
+ * legacy full blocks. It is frozen to read these blocks by register names,
+ * do not change it along with the regfile.
+ * */
+static const flash_legacy_t	flash_legacy_v54[] = {
+
+	{ "null",				0 },
+	{ "hal.HSE_crystal_clock",		0 },
+	{ "hal.USART_baud_rate",		REG_CONFIG },
+	{ "hal.PWM_frequency",			REG_CONFIG },
+	{ "hal.PWM_deadtime",			REG_CONFIG },
+	{ "hal.ADC_reference_voltage",		REG_CONFIG },
+	{ "hal.ADC_shunt_resistance",		REG_CONFIG },
+	{ "hal.ADC_amplifier_gain",		REG_CONFIG },
+	{ "hal.ADC_voltage_ratio",		REG_CONFIG },
+	{ "hal.ADC_terminal_ratio",		REG_CONFIG },
+	{ "hal.ADC_terminal_bias",		REG_CONFIG },
+	{ "hal.TIM_mode",			REG_CONFIG },
+	{ "hal.PPM_mode",			REG_CONFIG },
+	{ "hal.PPM_timebase",			REG_CONFIG },
+	{ "hal.PPM_signal_caught",		0 },
+	{ "ap.ppm_reg_ID",			REG_CONFIG | REG_LINKED },
+	{ "ap.ppm_pulse_range[0]",		REG_CONFIG },
+	{ "ap.ppm_pulse_range[1]",		REG_CONFIG },
+	{ "ap.ppm_pulse_range[2]",		REG_CONFIG },
+	{ "ap.ppm_pulse_lost[0]",		REG_CONFIG },
+	{ "ap.ppm_pulse_lost[1]",		REG_CONFIG },
+	{ "ap.ppm_control_range[0]",		REG_CONFIG },
+	{ "ap.ppm_control_range[1]",		REG_CONFIG },
+	{ "ap.ppm_control_range[2]",		REG_CONFIG },
+	{ "ap.ppm_startup_range[0]",		REG_CONFIG },
+	{ "ap.ppm_startup_range[1]",		REG_CONFIG },
+	{ "ap.analog_enabled",			REG_CONFIG },
+	{ "ap.analog_reg_ID",			REG_CONFIG | REG_LINKED },
+	{ "ap.analog_voltage_ratio",		REG_CONFIG },
+	{ "ap.analog_timeout",			REG_CONFIG },
+	{ "ap.analog_voltage_ANALOG[0]",	REG_CONFIG },
+	{ "ap.analog_voltage_ANALOG[1]",	REG_CONFIG },
+	{ "ap.analog_voltage_ANALOG[2]",	REG_CONFIG },
+	{ "ap.analog_voltage_BRAKE[0]",		REG_CONFIG },
+	{ "ap.analog_voltage_BRAKE[1]",		REG_CONFIG },
+	{ "ap.analog_voltage_BRAKE[2]",		REG_CONFIG },
+	{ "ap.analog_voltage_lost[0]",		REG_CONFIG },
+	{ "ap.analog_voltage_lost[1]",		REG_CONFIG },
+	{ "ap.analog_control_ANALOG[0]",	REG_CONFIG },
+	{ "ap.analog_control_ANALOG[1]",	REG_CONFIG },
+	{ "ap.analog_control_ANALOG[2]",	REG_CONFIG },
+	{ "ap.analog_control_BRAKE[0]",		REG_CONFIG },
+	{ "ap.analog_control_BRAKE[1]",		REG_CONFIG },
+	{ "ap.analog_control_BRAKE[2]",		REG_CONFIG },
+	{ "ap.analog_startup_range[0]",		REG_CONFIG },
+	{ "ap.analog_startup_range[1]",		REG_CONFIG },
+	{ "ap.ntc_PCB.r_balance",		REG_CONFIG },
+	{ "ap.ntc_PCB.r_ntc_0",			REG_CONFIG },
+	{ "ap.ntc_PCB.ta_0",			REG_CONFIG },
+	{ "ap.ntc_PCB.betta",			REG_CONFIG },
+	{ "ap.ntc_EXT.r_balance",		REG_CONFIG },
+	{ "ap.ntc_EXT.r_ntc_0",			REG_CONFIG },
+	{ "ap.ntc_EXT.ta_0",			REG_CONFIG },
+	{ "ap.ntc_EXT.betta",			REG_CONFIG },
+	{ "ap.temp_PCB",			0 },
+	{ "ap.temp_EXT",			0 },
+	{ "ap.temp_INT",			0 },
+	{ "ap.heat_PCB",			REG_CONFIG },
+	{ "ap.heat_PCB_derated_i",		REG_CONFIG },
+	{ "ap.heat_EXT",			REG_CONFIG },
+	{ "ap.heat_EXT_derated_i",		REG_CONFIG },
+	{ "ap.heat_PCB_FAN",			REG_CONFIG },
+	{ "ap.heat_gap",			REG_CONFIG },
+	{ "ap.pull_g",				0 },
+	{ "ap.pull_ad[0]",			REG_CONFIG },
+	{ "ap.pull_ad[1]",			REG_CONFIG },
+	{ "pm.dc_resolution",			0 },
+	{ "pm.dc_minimal",			REG_CONFIG },
+	{ "pm.dc_clearance",			REG_CONFIG },
+	{ "pm.dc_tm_hold",			REG_CONFIG },
+	{ "pm.fail_reason",			0 },
+	{ "pm.self_BM",				0 },
+	{ "pm.self_RMS",			0 },
+	{ "pm.config_NOP",			REG_CONFIG },
+	{ "pm.config_TVM",			REG_CONFIG },
+	{ "pm.config_HFI",			REG_CONFIG },
+	{ "pm.config_SENSOR",			REG_CONFIG },
+	{ "pm.config_WEAK",			REG_CONFIG },
+	{ "pm.config_DRIVE",			REG_CONFIG },
+	{ "pm.config_SERVO",			REG_CONFIG },
+	{ "pm.config_STAT",			REG_CONFIG },
+	{ "pm.fsm_req",				0 },
+	{ "pm.fsm_state",			0 },
+	{ "pm.fsm_phase",			0 },
+	{ "pm.tm_transient_slow",		REG_CONFIG },
+	{ "pm.tm_transient_fast",		REG_CONFIG },
+	{ "pm.tm_voltage_hold",			REG_CONFIG },
+	{ "pm.tm_current_hold",			REG_CONFIG },
+	{ "pm.tm_instant_probe",		REG_CONFIG },
+	{ "pm.tm_average_drift",		REG_CONFIG },
+	{ "pm.tm_average_probe",		REG_CONFIG },
+	{ "pm.tm_startup",			REG_CONFIG },
+	{ "pm.ad_IA[0]",			REG_CONFIG },
+	{ "pm.ad_IA[1]",			REG_CONFIG },
+	{ "pm.ad_IB[0]",			REG_CONFIG },
+	{ "pm.ad_IB[1]",			REG_CONFIG },
+	{ "pm.ad_US[0]",			REG_CONFIG },
+	{ "pm.ad_US[1]",			REG_CONFIG },
+	{ "pm.ad_UA[0]",			REG_CONFIG },
+	{ "pm.ad_UA[1]",			REG_CONFIG },
+	{ "pm.ad_UB[0]",			REG_CONFIG },
+	{ "pm.ad_UB[1]",			REG_CONFIG },
+	{ "pm.ad_UC[0]",			REG_CONFIG },
+	{ "pm.ad_UC[1]",			REG_CONFIG },
+	{ "pm.fb_iA",				0 },
+	{ "pm.fb_iB",				0 },
+	{ "pm.fb_uA",				0 },
+	{ "pm.fb_uB",				0 },
+	{ "pm.fb_uC",				0 },
+	{ "pm.fb_HS",				0 },
+	{ "pm.probe_current_hold",		REG_CONFIG },
+	{ "pm.probe_current_bias_Q",		REG_CONFIG },
+	{ "pm.probe_current_sine",		REG_CONFIG },
+	{ "pm.probe_freq_sine_hz",		REG_CONFIG },
+	{ "pm.probe_speed_hold",		REG_CONFIG },
+	{ "pm.probe_speed_hold_rpm",		0 },
+	{ "pm.probe_gain_P",			REG_CONFIG },
+	{ "pm.probe_gain_I",			REG_CONFIG },
+	{ "pm.fault_voltage_tol",		REG_CONFIG },
+	{ "pm.fault_current_tol",		REG_CONFIG },
+	{ "pm.fault_accuracy_tol",		REG_CONFIG },
+	{ "pm.fault_current_halt",		REG_CONFIG },
+	{ "pm.fault_voltage_halt",		REG_CONFIG },
+	{ "pm.fault_flux_lpfe_halt",		REG_CONFIG },
+	{ "pm.vsi_X",				0 },
+	{ "pm.vsi_Y",				0 },
+	{ "pm.vsi_DX",				0 },
+	{ "pm.vsi_DY",				0 },
+	{ "pm.vsi_IF",				0 },
+	{ "pm.vsi_UF",				0 },
+	{ "pm.tvm_range",			REG_CONFIG },
+	{ "pm.tvm_A",				0 },
+	{ "pm.tvm_B",				0 },
+	{ "pm.tvm_C",				0 },
+	{ "pm.tvm_FIR_A",			0 },
+	{ "pm.tvm_FIR_B",			0 },
+	{ "pm.tvm_FIR_C",			0 },
+	{ "pm.tvm_DX",				0 },
+	{ "pm.tvm_DY",				0 },
+	{ "pm.lu_iX",				0 },
+	{ "pm.lu_iY",				0 },
+	{ "pm.lu_iD",				0 },
+	{ "pm.lu_iQ",				0 },
+	{ "pm.lu_F[0]",				0 },
+	{ "pm.lu_F[1]",				0 },
+	{ "pm.lu_Fg",				0 },
+	{ "pm.lu_wS",				0 },
+	{ "pm.lu_wS_rpm",			0 },
+	{ "pm.lu_wS_kmh",			0 },
+	{ "pm.lu_lock_S",			REG_CONFIG },
+	{ "pm.lu_unlock_S",			REG_CONFIG },
+	{ "pm.lu_lpf_wS",			0 },
+	{ "pm.lu_lpf_wS_rpm",			0 },
+	{ "pm.lu_lpf_wS_kmh",			0 },
+	{ "pm.lu_gain_LP_S",			REG_CONFIG },
+	{ "pm.lu_mode",				0 },
+	{ "pm.forced_hold_D",			REG_CONFIG },
+	{ "pm.forced_maximal",			REG_CONFIG },
+	{ "pm.forced_maximal_rpm",		0 },
+	{ "pm.forced_reverse",			REG_CONFIG },
+	{ "pm.forced_reverse_rpm",		0 },
+	{ "pm.forced_accel",			REG_CONFIG },
+	{ "pm.forced_accel_rpm",		0 },
+	{ "pm.flux_N",				REG_CONFIG },
+	{ "pm.flux_lower_R",			REG_CONFIG },
+	{ "pm.flux_upper_R",			REG_CONFIG },
+	{ "pm.flux_transient_S",		REG_CONFIG },
+	{ "pm.flux_E",				0 },
+	{ "pm.flux_H",				0 },
+	{ "pm.flux_F[0]",			0 },
+	{ "pm.flux_F[1]",			0 },
+	{ "pm.flux_Fg",				0 },
+	{ "pm.flux_wS",				0 },
+	{ "pm.flux_wS_rpm",			0 },
+	{ "pm.flux_wS_kmh",			0 },
+	{ "pm.flux_lpf_E",			0 },
+	{ "pm.flux_gain_IN",			REG_CONFIG },
+	{ "pm.flux_gain_LO",			REG_CONFIG },
+	{ "pm.flux_gain_HI",			REG_CONFIG },
+	{ "pm.flux_gain_LP_E",			REG_CONFIG },
+	{ "pm.flux_gain_SF",			REG_CONFIG },
+	{ "pm.inject_bias_U",			REG_CONFIG },
+	{ "pm.inject_ratio_D",			REG_CONFIG },
+	{ "pm.hfi_freq_hz",			REG_CONFIG },
+	{ "pm.hfi_swing_D",			REG_CONFIG },
+	{ "pm.hfi_derated_i",			REG_CONFIG },
+	{ "pm.hfi_F[0]",			0 },
+	{ "pm.hfi_F[1]",			0 },
+	{ "pm.hfi_Fg",				0 },
+	{ "pm.hfi_wS",				0 },
+	{ "pm.hfi_wS_rpm",			0 },
+	{ "pm.hfi_wS_kmh",			0 },
+	{ "pm.hfi_polarity",			0 },
+	{ "pm.hfi_gain_EP",			REG_CONFIG },
+	{ "pm.hfi_gain_SF",			REG_CONFIG },
+	{ "pm.hfi_gain_FP",			REG_CONFIG },
+	{ "pm.hall_AT[1]",			0 },
+	{ "pm.hall_AT[2]",			0 },
+	{ "pm.hall_AT[3]",			0 },
+	{ "pm.hall_AT[4]",			0 },
+	{ "pm.hall_AT[5]",			0 },
+	{ "pm.hall_AT[6]",			0 },
+	{ "pm.hall_F[0]",			0 },
+	{ "pm.hall_F[1]",			0 },
+	{ "pm.hall_Fg",				0 },
+	{ "pm.hall_wS",				0 },
+	{ "pm.hall_wS_rpm",			0 },
+	{ "pm.hall_wS_kmh",			0 },
+	{ "pm.hall_TIM",			0 },
+	{ "pm.const_lpf_U",			0 },
+	{ "pm.const_gain_LP_U",			REG_CONFIG },
+	{ "pm.const_E",				REG_CONFIG },
+	{ "pm.const_E_kv",			0 },
+	{ "pm.const_R",				REG_CONFIG },
+	{ "pm.const_L",				REG_CONFIG },
+	{ "pm.const_Zp",			REG_CONFIG },
+	{ "pm.const_J",				REG_CONFIG },
+	{ "pm.const_im_LD",			REG_CONFIG },
+	{ "pm.const_im_LQ",			REG_CONFIG },
+	{ "pm.const_im_B",			REG_CONFIG },
+	{ "pm.const_im_R",			REG_CONFIG },
+	{ "pm.const_dd_T",			REG_CONFIG },
+	{ "pm.watt_wP_maximal",			REG_CONFIG },
+	{ "pm.watt_iB_maximal",			REG_CONFIG },
+	{ "pm.watt_wP_reverse",			REG_CONFIG },
+	{ "pm.watt_iB_reverse",			REG_CONFIG },
+	{ "pm.watt_dclink_HI",			REG_CONFIG },
+	{ "pm.watt_dclink_LO",			REG_CONFIG },
+	{ "pm.watt_lpf_D",			0 },
+	{ "pm.watt_lpf_Q",			0 },
+	{ "pm.watt_lpf_wP",			0 },
+	{ "pm.watt_gain_LP_F",			REG_CONFIG },
+	{ "pm.watt_gain_LP_P",			REG_CONFIG },
+	{ "pm.i_maximal",			REG_CONFIG },
+	{ "pm.i_reverse",			REG_CONFIG },
+	{ "pm.i_derated_1",			0 },
+	{ "pm.i_setpoint_D",			0 },
+	{ "pm.i_setpoint_Q",			0 },
+	{ "pm.i_setpoint_Q_pc",			0 },
+	{ "pm.i_gain_P",			REG_CONFIG },
+	{ "pm.i_gain_I",			REG_CONFIG },
+	{ "pm.weak_maximal",			REG_CONFIG },
+	{ "pm.weak_bias_U",			REG_CONFIG },
+	{ "pm.weak_D",				0 },
+	{ "pm.weak_gain_EU",			REG_CONFIG },
+	{ "pm.v_maximal",			REG_CONFIG },
+	{ "pm.v_reverse",			REG_CONFIG },
+	{ "pm.s_maximal",			REG_CONFIG },
+	{ "pm.s_maximal_rpm",			0 },
+	{ "pm.s_maximal_kmh",			0 },
+	{ "pm.s_reverse",			REG_CONFIG },
+	{ "pm.s_reverse_rpm",			0 },
+	{ "pm.s_reverse_kmh",			0 },
+	{ "pm.s_setpoint",			0 },
+	{ "pm.s_setpoint_rpm",			0 },
+	{ "pm.s_setpoint_kmh",			0 },
+	{ "pm.s_setpoint_pc",			0 },
+	{ "pm.s_accel",				REG_CONFIG },
+	{ "pm.s_accel_rpm",			0 },
+	{ "pm.s_accel_kmh",			0 },
+	{ "pm.s_gain_P",			REG_CONFIG },
+	{ "pm.s_gain_LP_I",			REG_CONFIG },
+	{ "pm.s_gain_HF_S",			REG_CONFIG },
+	{ "pm.x_setpoint_F",			0 },
+	{ "pm.x_setpoint_Fg",			0 },
+	{ "pm.x_near_EP",			REG_CONFIG },
+	{ "pm.x_gain_P",			REG_CONFIG },
+	{ "pm.x_gain_N",			REG_CONFIG },
+	{ "pm.stat_revol_total",		0 },
+	{ "pm.stat_distance",			0 },
+	{ "pm.stat_distance_km",		0 },
+	{ "pm.stat_consumed_wh",		0 },
+	{ "pm.stat_consumed_ah",		0 },
+	{ "pm.stat_reverted_wh",		0 },
+	{ "pm.stat_reverted_ah",		0 },
+	{ "pm.stat_capacity_ah",		REG_CONFIG },
+	{ "pm.stat_fuel_pc",			0 },
+	{ "pm.stat_peak_consumed_watt",		0 },
+	{ "pm.stat_peak_reverted_watt",		0 },
+	{ "pm.stat_peak_speed",			0 },
+	{ "pm.stat_peak_speed_rpm",		0 },
+	{ "pm.stat_peak_speed_kmh",		0 },
+	{ "ti.reg_ID[0]",			REG_CONFIG | REG_LINKED },
+	{ "ti.reg_ID[1]",			REG_CONFIG | REG_LINKED },
+	{ "ti.reg_ID[2]",			REG_CONFIG | REG_LINKED },
+	{ "ti.reg_ID[3]",			REG_CONFIG | REG_LINKED },
+	{ "ti.reg_ID[4]",			REG_CONFIG | REG_LINKED },
+	{ "ti.reg_ID[5]",			REG_CONFIG | REG_LINKED },
+	{ "ti.reg_ID[6]",			REG_CONFIG | REG_LINKED },
+	{ "ti.reg_ID[7]",			REG_CONFIG | REG_LINKED },
+	{ "ti.reg_ID[8]",			REG_CONFIG | REG_LINKED },
+	{ "ti.reg_ID[9]",			REG_CONFIG | REG_LINKED },
+	{ NULL, 0 }
+};
+
+static int
+flash_is_block_dirty(const flash_block_t *block)
+{
+	const unsigned long	*lsrc, *lend;
+	int			dirty = 0;
+
+	lsrc = (const unsigned long *) block;
+	lend = (const unsigned long *) (block + 1);
+
+	while (lsrc < lend) {
+
+		if (*lsrc++ != FLASH_ERASED) {
+
+			dirty = 1;
+			break;
+		}
+	}
+
+	return dirty;
+}
+
+static int
+flash_is_block_valid(const flash_block_t *block)
+{
+	return (	(block->version == REG_CONFIG_VERSION
+			|| block->version == FLASH_LEGACY_VERSION)
+			&& crc32b(block, offsetof(flash_block_t, crc32)) == block->crc32) ? 1 : 0;
+}
+
+static int
+flash_is_rec_free(const flash_rec_t *rec)
+{
+	return (rec->key == FLASH_ERASED && rec->value == FLASH_ERASED
+			&& rec->crc32 == FLASH_ERASED) ? 1 : 0;
+}
+
+static int
+flash_is_head_valid(const flash_head_t *head)
+{
+	return (head->magic == FLASH_JOURNAL_MAGIC
+			&& crc32b(head, offsetof(flash_head_t, crc32)) == head->crc32) ? 1 : 0;
+}
+
+static flash_rec_t *
+flash_journal_end(int sector_N)
+{
+	return (flash_rec_t *) (flash_ram_map[sector_N + 1]
+			- (flash_ram_map[sector_N + 1] - flash_ram_map[sector_N]
+			- sizeof(flash_head_t)) % sizeof(flash_rec_t));
+}
+
+static int
+flash_sector_of(const void *flash)
+{
+	int			N;
+
+	for (N = 0; N < FLASH_SECTOR_MAX; ++N) {
+
+		if ((unsigned long) flash < flash_ram_map[N + 1])
+			break;
+	}
+
+	return N;
+}
+
+static void
+flash_index_build()
 {
-	flash_block_t			*block, *last;
+	const flash_head_t	*head;
+	flash_block_t		*block;
+	flash_rec_t		*rec, *end;
+	int			N;
+
+	flash_index.block = NULL;
+	flash_index.sector_N = -1;
+	flash_index.number = 0;
+
+	for (N = 0; N < FLASH_SECTOR_MAX; ++N) {
+
+		head = (const flash_head_t *) flash_ram_map[N];
+
+		if (flash_is_head_valid(head) != 0) {
+
+			/* Records are appended in order so the first free
+			 * one ends the journal.
+			 * */
+			rec = (flash_rec_t *) (head + 1);
+			end = flash_journal_end(N);
+
+			while (rec < end && flash_is_rec_free(rec) == 0)
+				rec += 1;
+
+			flash_index.base[N] = 0;
+			flash_index.fill[N] = (unsigned long) rec - flash_ram_map[N];
+
+			if (		flash_index.sector_N < 0
+					|| head->number > flash_index.number) {
+
+				flash_index.sector_N = N;
+				flash_index.number = head->number;
+				flash_index.version = head->version;
+				flash_index.tail = rec;
+			}
+		}
+		else {
+			block = (flash_block_t *) flash_ram_map[N];
+
+			flash_index.base[N] = 0;
+			flash_index.fill[N] = 0;
 
-	block = (void *) flash_ram_map[0];
-	last = NULL;
+			while ((unsigned long) (block + 1) <= flash_ram_map[N + 1]) {
 
-	do {
-		if (block->version == REG_CONFIG_VERSION) {
+				if (flash_is_block_dirty(block) != 0) {
 
-			if (crc32b(block, sizeof(flash_block_t) - 4) == block->crc32) {
+					if (flash_index.fill[N] == 0) {
 
-				if (last != NULL) {
+						flash_index.base[N] = (unsigned long) block
+							- flash_ram_map[N];
+					}
 
-					last = (block->number > last->number)
-						? block : last;
+					flash_index.fill[N] = (unsigned long) (block + 1)
+						- flash_ram_map[N];
+
+					if (flash_is_block_valid(block) != 0) {
+
+						if (		flash_index.block == NULL
+								|| block->number > flash_index.block->number)
+							flash_index.block = block;
+					}
 				}
-				else
-					last = block;
+
+				block += 1;
 			}
 		}
+	}
 
-		block += 1;
+	if (flash_index.sector_N < 0 && flash_index.block != NULL)
+		flash_index.number = flash_index.block->number;
+}
 
-		if ((unsigned long) block >= flash_ram_map[FLASH_SECTOR_MAX])
-			break;
+static unsigned long
+flash_tag_sym(const char *sym)
+{
+	unsigned long		tag = 2166136261UL;
+
+	/* FNV-1a hash of the register name.
+	 * */
+	while (*sym != 0) {
+
+		tag ^= (unsigned char) *sym++;
+		tag = (tag * 16777619UL) & 0xFFFFFFFFUL;
+	}
+
+	return tag;
+}
+
+static unsigned long
+flash_tag(int ID)
+{
+	return flash_tag_sym(regfile[ID].sym);
+}
+
+static flash_tag_t *
+flash_tag_map()
+{
+	flash_tag_t		*map, temp;
+	int			ID, N;
+
+	map = pvPortMalloc(REG_ID_MAX * sizeof(flash_tag_t));
+
+	if (map == NULL)
+		return NULL;
+
+	/* Table of register name tags sorted for binary search.
+	 * */
+	for (ID = 0; ID < REG_ID_MAX; ++ID) {
+
+		temp.tag = flash_tag(ID);
+		temp.ID = ID;
+
+		for (N = ID; N > 0 && map[N - 1].tag > temp.tag; --N)
+			map[N] = map[N - 1];
+
+		map[N] = temp;
+	}
+
+	return map;
+}
+
+static int
+flash_tag_search(const flash_tag_t *map, unsigned long tag)
+{
+	int			L = 0, R = REG_ID_MAX - 1, N;
+
+	while (L <= R) {
+
+		N = (L + R) / 2;
+
+		if (map[N].tag < tag)
+			L = N + 1;
+		else if (map[N].tag > tag)
+			R = N - 1;
+		else
+			return map[N].ID;
+	}
+
+	return -1;
+}
+
+static int
+flash_journal_replay(int sector_N)
+{
+	const reg_t		*reg;
+	flash_tag_t		*map;
+	flash_rec_t		*rec;
+	unsigned long		value;
+	int			ID, N;
+
+	map = flash_tag_map();
+
+	if (map == NULL)
+		return -1;
+
+	rec = (flash_rec_t *) ((const flash_head_t *) flash_ram_map[sector_N] + 1);
+
+	/* Records are applied in order so the last one wins. Damaged records
+	 * (e.g. on power loss during write) are skipped as well as the names
+	 * that are no longer in the register table.
+	 * */
+	while (rec < flash_index.tail) {
+
+		if (crc32b(rec, offsetof(flash_rec_t, crc32)) == rec->crc32) {
+
+			ID = flash_tag_search(map, rec->key);
+			reg = (ID >= 0) ? regfile + ID : NULL;
+
+			if (reg != NULL && (reg->mode & REG_CONFIG)) {
+
+				value = rec->value;
+
+				if (reg->mode & REG_LINKED) {
+
+					/* Linked register keeps the name
+					 * tag of the target register.
+					 * */
+					N = flash_tag_search(map, value);
+					value = (N >= 0) ? N : ID_NULL;
+				}
+
+				* (unsigned long *) reg->link = value;
+				flash_index.stored[ID] = value;
+			}
+		}
+
+		rec += 1;
+	}
+
+	vPortFree(map);
+
+	return 0;
+}
+
+static int
+flash_legacy_replay(const flash_block_t *block)
+{
+	const flash_legacy_t	*legacy;
+	const unsigned long	*content;
+	const reg_t		*reg;
+	flash_tag_t		*map;
+	unsigned long		value;
+	int			ID, N;
+
+	map = flash_tag_map();
+
+	if (map == NULL)
+		return -1;
+
+	content = block->content;
+
+	/* Values are stored in order of the config registers of frozen
+	 * table. Linked register keeps the ID of target in this table.
+	 * */
+	for (legacy = flash_legacy_v54; legacy->sym != NULL; ++legacy) {
+
+		if ((legacy->mode & REG_CONFIG) == 0)
+			continue;
+
+		value = *content++;
+
+		ID = flash_tag_search(map, flash_tag_sym(legacy->sym));
+		reg = (ID >= 0) ? regfile + ID : NULL;
+
+		if (reg != NULL && (reg->mode & REG_CONFIG)) {
+
+			if (legacy->mode & REG_LINKED) {
+
+				N = (value < FLASH_LEGACY_MAX) ? flash_tag_search(map,
+						flash_tag_sym(flash_legacy_v54[value].sym)) : -1;
+				value = (N >= 0) ? N : ID_NULL;
+			}
+
+			* (unsigned long *) reg->link = value;
+		}
 	}
-	while (1);
 
-	return last;
+	vPortFree(map);
+
+	return 0;
 }
 
 int flash_block_load()
 {
 	const reg_t		*reg;
-	flash_block_t		*block;
 	unsigned long		*content;
 	int			rc = -1;
 
-	block = flash_block_scan();
+	flash_index_build();
 
-	if (block != NULL) {
+	if (flash_index.sector_N >= 0) {
+
+		/* Journal of another config version is loaded by caller
+		 * over the defaults.
+		 * */
+		rc = (flash_index.version == REG_CONFIG_VERSION)
+			? flash_journal_replay(flash_index.sector_N) : 1;
+	}
+	else if (		flash_index.block != NULL
+			&& flash_index.block->version == REG_CONFIG_VERSION) {
 
-		content = block->content;
+		/* Fall back to the legacy full block.
+		 * */
+		content = flash_index.block->content;
 
 		for (reg = regfile; reg->sym != NULL; ++reg) {
 
@@ -73,101 +726,168 @@ int flash_block_load()
 
 		rc = 0;
 	}
+	else if (flash_index.block != NULL) {
+
+		/* Legacy block of the last legacy version is loaded by caller
+		 * over the defaults.
+		 * */
+		rc = 1;
+	}
+
+	return rc;
+}
+
+int flash_block_migrate()
+{
+	int			rc = -1;
+
+	if (flash_index.sector_N >= 0) {
+
+		rc = flash_journal_replay(flash_index.sector_N);
+	}
+	else if (flash_index.block != NULL) {
+
+		rc = flash_legacy_replay(flash_index.block);
+	}
 
 	return rc;
 }
 
 static int
-flash_is_block_dirty(const flash_block_t *block)
+flash_journal_append(flash_rec_t *rec, int ID)
 {
-	const unsigned long	*lsrc, *lend;
-	int			dirty = 0;
+	flash_rec_t		temp;
+	unsigned long		value;
 
-	lsrc = (const unsigned long *) block;
-	lend = (const unsigned long *) (block + 1);
+	value = * (unsigned long *) regfile[ID].link;
 
-	while (lsrc < lend) {
+	temp.key = flash_tag(ID);
+	temp.value = value;
 
-		if (*lsrc++ != 0xFFFFFFFFUL) {
+	if (regfile[ID].mode & REG_LINKED) {
 
-			dirty = 1;
-			break;
-		}
+		temp.value = flash_tag((value < REG_ID_MAX) ? value : ID_NULL);
 	}
 
-	return dirty;
+	temp.crc32 = crc32b(&temp, offsetof(flash_rec_t, crc32));
+
+	FLASH_write(rec, &temp, sizeof(flash_rec_t));
+
+	flash_index.stored[ID] = value;
+
+	return (rec->crc32 == temp.crc32 && rec->value == temp.value) ? 0 : -1;
 }
 
 static int
-flash_block_write()
+flash_journal_compact()
 {
-	const reg_t		*reg;
-	flash_block_t		*block, *temp;
-	unsigned int		number;
-	int			n, rc;
-
-	block = flash_block_scan();
+	flash_head_t		head, *dest;
+	flash_rec_t		*rec;
+	int			ID, sector_N, rc = 0;
 
-	if (block != NULL) {
+	if (flash_index.sector_N >= 0) {
 
-		number = block->number + 1;
-		block += 1;
+		sector_N = flash_index.sector_N + 1;
+	}
+	else if (flash_index.block != NULL) {
 
-		if ((unsigned long) block >= flash_ram_map[FLASH_SECTOR_MAX])
-			block = (void *) flash_ram_map[0];
+		/* Keep the sector with legacy block until the journal is
+		 * written.
+		 * */
+		sector_N = flash_sector_of(flash_index.block) + 1;
 	}
 	else {
-		number = 1;
-		block = (void *) flash_ram_map[0];
+		sector_N = 0;
 	}
 
-	temp = block;
+	sector_N = (sector_N < FLASH_SECTOR_MAX) ? sector_N : 0;
 
-	do {
-		if (flash_is_block_dirty(block) == 0) {
+	if (		flash_index.block != NULL
+			&& flash_sector_of(flash_index.block) == sector_N)
+		flash_index.block = NULL;
 
-			break;
+	dest = FLASH_sector_erase((void *) flash_ram_map[sector_N]);
+	rec = (flash_rec_t *) (dest + 1);
+
+	/* Write a full snapshot of the configuration first then the header
+	 * that makes the sector valid.
+	 * */
+	for (ID = 0; ID < REG_ID_MAX; ++ID) {
+
+		if (regfile[ID].mode & REG_CONFIG) {
+
+			rc |= flash_journal_append(rec++, ID);
 		}
+	}
 
-		block += 1;
+	head.magic = FLASH_JOURNAL_MAGIC;
+	head.version = REG_CONFIG_VERSION;
+	head.number = flash_index.number + 1;
+	head.crc32 = crc32b(&head, offsetof(flash_head_t, crc32));
 
-		if ((unsigned long) block >= flash_ram_map[FLASH_SECTOR_MAX])
-			block = (void *) flash_ram_map[0];
+	FLASH_write(dest, &head, sizeof(flash_head_t));
 
-		if (block == temp) {
+	flash_index.base[sector_N] = 0;
+	flash_index.fill[sector_N] = (unsigned long) rec - flash_ram_map[sector_N];
 
-			block = FLASH_sector_erase(block);
-			break;
-		}
+	if (rc == 0 && flash_is_head_valid(dest) != 0) {
+
+		flash_index.sector_N = sector_N;
+		flash_index.number = head.number;
+		flash_index.version = head.version;
+		flash_index.tail = rec;
+	}
+	else {
+		flash_index.sector_N = -1;
+		rc = -1;
 	}
-	while (1);
 
-	temp = pvPortMalloc(sizeof(flash_block_t));
+	return rc;
+}
 
-	if (temp != NULL) {
+static int
+flash_journal_write()
+{
+	flash_rec_t		*rec;
+	int			ID, N = 0, rc = 0;
 
-		temp->number = number;
-		temp->version = REG_CONFIG_VERSION;
+	/* Journal of another config version is rewritten with the current
+	 * names at the first save.
+	 * */
+	if (		flash_index.sector_N < 0
+			|| flash_index.version != REG_CONFIG_VERSION)
+		return flash_journal_compact();
 
-		for (reg = regfile, n = 0; reg->sym != NULL; ++reg) {
+	for (ID = 0; ID < REG_ID_MAX; ++ID) {
 
-			if (reg->mode & REG_CONFIG) {
+		if (		(regfile[ID].mode & REG_CONFIG)
+				&& * (unsigned long *) regfile[ID].link
+				!= flash_index.stored[ID]) {
 
-				temp->content[n++] = * (unsigned long *) reg->link;
-			}
+			N++;
 		}
+	}
+
+	rec = flash_index.tail;
 
-		for (; n < sizeof(temp->content) / sizeof(unsigned long); ++n)
-			temp->content[n] = 0xFFFFFFFFUL;
+	if (rec + N > flash_journal_end(flash_index.sector_N))
+		return flash_journal_compact();
 
-		temp->crc32 = crc32b(temp, sizeof(flash_block_t) - 4);
+	/* Append only the registers that were changed.
+	 * */
+	for (ID = 0; ID < REG_ID_MAX; ++ID) {
 
-		FLASH_write(block, temp, sizeof(flash_block_t));
+		if (		(regfile[ID].mode & REG_CONFIG)
+				&& * (unsigned long *) regfile[ID].link
+				!= flash_index.stored[ID]) {
 
-		vPortFree(temp);
+			rc |= flash_journal_append(rec++, ID);
+		}
 	}
 
-	rc = (crc32b(block, sizeof(flash_block_t) - 4) == block->crc32) ? 0 : -1;
+	flash_index.tail = rec;
+	flash_index.fill[flash_index.sector_N] = (unsigned long) rec
+		- flash_ram_map[flash_index.sector_N];
 
 	return rc;
 }
@@ -184,7 +904,7 @@ SH_DEF(flash_write)
 
 	printf("Flash ... ");
 
-	rc = flash_block_write();
+	rc = flash_journal_write();
 
 	printf("%s" EOL, (rc == 0) ? "Done" : "Failed");
 }
@@ -192,66 +912,91 @@ SH_DEF(flash_write)
 SH_DEF(flash_info_map)
 {
 	flash_block_t			*block;
-	int				sector_N, info_sym;
+	unsigned long			offset;
+	int				N, info_sym, journal;
 
-	block = (void *) flash_ram_map[0];
-	sector_N = 0;
+	for (N = 0; N < FLASH_SECTOR_MAX; ++N) {
 
-	do {
-		if (flash_is_block_dirty(block) != 0) {
+		block = (flash_block_t *) flash_ram_map[N];
 
-			info_sym = 'x';
+		/* Do not touch the flash beyond the used space.
+		 * */
+		journal = (flash_index.fill[N] != 0) ? flash_is_head_valid(
+				(const flash_head_t *) block) : 0;
 
-			if (block->version == REG_CONFIG_VERSION) {
+		while ((unsigned long) block < flash_ram_map[N + 1]) {
 
-				if (crc32b(block, sizeof(flash_block_t) - 4) == block->crc32) {
+			offset = (unsigned long) (block + 1) - flash_ram_map[N];
 
-					info_sym = 'a';
-				}
+			if (		offset <= flash_index.base[N]
+					|| offset - sizeof(flash_block_t) >= flash_index.fill[N]) {
+
+				info_sym = '.';
 			}
-		}
-		else {
-			info_sym = '.';
-		}
+			else if (journal != 0) {
 
-		iodef->putc(info_sym);
+				info_sym = (N == flash_index.sector_N) ? 'J' : 'j';
+			}
+			else if (flash_is_block_valid(block) != 0) {
+
+				info_sym = 'a';
+			}
+			else {
+				info_sym = (flash_is_block_dirty(block) != 0) ? 'x' : '.';
+			}
 
-		block += 1;
+			iodef->putc(info_sym);
 
-		if ((unsigned long) block >= flash_ram_map[sector_N + 1]) {
+			block += 1;
+		}
 
-			puts(EOL);
+		puts(EOL);
+	}
 
-			sector_N += 1;
+	if (flash_index.sector_N >= 0) {
 
-			if (sector_N >= FLASH_SECTOR_MAX)
-				break;
-		}
+		printf("journal %i records %i free" EOL,
+				(int) (flash_index.tail - (flash_rec_t *)
+				((const flash_head_t *) flash_ram_map[flash_index.sector_N] + 1)),
+				(int) (flash_journal_end(flash_index.sector_N)
+				- flash_index.tail));
 	}
-	while (1);
 }
 
 SH_DEF(flash_cleanup)
 {
 	flash_block_t			*block;
+	flash_head_t			*head;
 	unsigned long			lz = 0;
+	int				N;
 
-	block = (void *) flash_ram_map[0];
+	for (N = 0; N < FLASH_SECTOR_MAX; ++N) {
 
-	do {
-		if (block->version == REG_CONFIG_VERSION) {
+		head = (flash_head_t *) flash_ram_map[N];
 
-			if (crc32b(block, sizeof(flash_block_t) - 4) == block->crc32) {
+		if (flash_index.fill[N] == 0)
+			continue;
 
-				FLASH_write(&block->crc32, &lz, sizeof(unsigned long));
-			}
+		if (flash_is_head_valid(head) != 0) {
+
+			FLASH_write(&head->magic, &lz, sizeof(unsigned long));
+			continue;
 		}
 
-		block += 1;
+		block = (flash_block_t *) (flash_ram_map[N] + flash_index.base[N]);
 
-		if ((unsigned long) block >= flash_ram_map[FLASH_SECTOR_MAX])
-			break;
+		while ((unsigned long) block - flash_ram_map[N] < flash_index.fill[N]) {
+
+			if (flash_is_block_valid(block) != 0) {
+
+				FLASH_write(&block->crc32, &lz, sizeof(unsigned long));
+			}
+
+			block += 1;
+		}
 	}
-	while (1);
+
+	flash_index.block = NULL;
+	flash_index.sector_N = -1;
 }
 
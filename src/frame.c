@@ -0,0 +1,145 @@
+#include <stddef.h>
+
+#include "crc32.h"
+#include "frame.h"
+#include "libc.h"
+
+#define FRAME_CHUNK_SZ		80
+
+typedef struct {
+
+	char		s[FRAME_CHUNK_SZ + 1];
+	int		n;
+}
+frame_chunk_t;
+
+static void
+frame_chunk_put(frame_chunk_t *ch, int c)
+{
+	ch->s[ch->n++] = (char) c;
+
+	if (ch->n >= FRAME_CHUNK_SZ) {
+
+		/* Encoded bytes are never zero so we send the chunk as
+		 * string.
+		 * */
+		ch->s[ch->n] = 0;
+		puts(ch->s);
+
+		ch->n = 0;
+	}
+}
+
+void frame_send(unsigned char *frame, int len)
+{
+	const unsigned char	*run, *end;
+	unsigned long		crc;
+	frame_chunk_t		ch;
+	int			code;
+
+	crc = crc32b(frame, len);
+
+	/* Caller leaves four bytes of space after the frame.
+	 * */
+	frame[len + 0] = (unsigned char) (crc);
+	frame[len + 1] = (unsigned char) (crc >> 8);
+	frame[len + 2] = (unsigned char) (crc >> 16);
+	frame[len + 3] = (unsigned char) (crc >> 24);
+
+	run = frame;
+	end = frame + len + 4;
+
+	ch.n = 0;
+
+	do {
+		for (code = 0; run + code < end && run[code] != 0
+				&& code < 0xFE; ++code) ;
+
+		frame_chunk_put(&ch, code + 1);
+
+		for (len = 0; len < code; ++len)
+			frame_chunk_put(&ch, *run++);
+
+		if (code < 0xFE && run < end) {
+
+			/* Skip the zero byte that is encoded implicitly.
+			 * */
+			run++;
+
+			if (run == end) {
+
+				frame_chunk_put(&ch, 1);
+			}
+		}
+	}
+	while (run < end);
+
+	ch.s[ch.n] = 0;
+	puts(ch.s);
+
+	putc(0);
+}
+
+int frame_recv(unsigned char *frame, int max)
+{
+	unsigned long		crc;
+	int			c, code = 0, rem = 0, len = 0, lost = 0;
+
+	do {
+		c = getc();
+
+		if (c == 0) {
+
+			if (len == 0 && lost == 0) {
+
+				/* Skip empty frames.
+				 * */
+				continue;
+			}
+
+			if (lost != 0 || rem != 0)
+				return -1;
+
+			/* Drop the trailing implicit zero.
+			 * */
+			len -= (code < 0xFF) ? 1 : 0;
+
+			break;
+		}
+		else if (lost != 0) {
+
+			continue;
+		}
+		else if (len + 2 >= max) {
+
+			lost = 1;
+		}
+		else {
+			if (rem == 0) {
+
+				code = c;
+				rem = c;
+			}
+			else {
+				frame[len++] = (unsigned char) c;
+			}
+
+			if (--rem == 0 && code < 0xFF) {
+
+				frame[len++] = 0;
+			}
+		}
+	}
+	while (1);
+
+	if (len < 5)
+		return -1;
+
+	len -= 4;
+
+	crc = frame[len] | (frame[len + 1] << 8) | (frame[len + 2] << 16)
+		| ((unsigned long) frame[len + 3] << 24);
+
+	return (crc32b(frame, len) == crc) ? len : -1;
+}
+
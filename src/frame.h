@@ -0,0 +1,12 @@
+#ifndef _H_FRAME_
+#define _H_FRAME_
+
+/* Binary frames are protected by CRC32 (little-endian) and sent with COBS
+ * encoding so zero byte is used as frame delimiter only.
+ * */
+
+void frame_send(unsigned char *frame, int len);
+int frame_recv(unsigned char *frame, int max);
+
+#endif /* _H_FRAME_ */
+
@@ -51,7 +51,7 @@
 #define configMAX_TASK_NAME_LEN			16
 #define configUSE_16_BIT_TICKS			0
 #define configIDLE_SHOULD_YIELD			1
-#define configUSE_TASK_NOTIFICATIONS		0
+#define configUSE_TASK_NOTIFICATIONS		1
 #define configUSE_MUTEXES			1
 #define configUSE_RECURSIVE_MUTEXES		0
 #define configUSE_COUNTING_SEMAPHORES		0
@@ -67,7 +67,7 @@
 #define configCHECK_FOR_STACK_OVERFLOW		1
 #define configUSE_MALLOC_FAILED_HOOK		1
 
-#define configGENERATE_RUN_TIME_STATS		0
+#define configGENERATE_RUN_TIME_STATS		1
 #define configUSE_TRACE_FACILITY		1
 
 #define INCLUDE_vTaskDelete			1
@@ -83,6 +83,14 @@
 
 //#define configASSERT(x)		if ((x) == pdFALSE) vAssertCalled(__FILE__, __LINE__)
 
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()	prof_clock()
+
+#define traceTASK_CREATE(xTCB)		rtos_trace_create((void *) (xTCB))
+#define traceTASK_DELETE(xTCB)		rtos_trace_delete((void *) (xTCB))
+#define traceTASK_SWITCHED_IN()		rtos_trace_switched_in()
+#define traceTASK_SWITCHED_OUT()	rtos_trace_switched_out((void *) pxCurrentTCB)
+
 #define vPortSVCHandler		irq_SVCall
 #define xPortPendSVHandler	irq_PendSV
 #define xPortSysTickHandler	irq_SysTick
@@ -90,5 +98,12 @@
 extern unsigned long clock_cpu_hz;
 extern void vAssertCalled(const char *file, int line);
 
+extern unsigned long prof_clock();
+
+extern void rtos_trace_create(void *xTCB);
+extern void rtos_trace_delete(void *xTCB);
+extern void rtos_trace_switched_in();
+extern void rtos_trace_switched_out(void *xTCB);
+
 #endif /* FREERTOS_CONFIG_H */
 
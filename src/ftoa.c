@@ -0,0 +1,420 @@
+#include "ftoa.h"
+
+typedef struct {
+
+	unsigned long long	f;
+	int			e;
+}
+ftoa_diy_t;
+
+static const unsigned int	ftoa_POW10[10] = {
+
+	1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U,
+	10000000U, 100000000U, 1000000000U
+};
+
+static const unsigned long long	ftoa_POW5[28] = {
+
+	1ULL, 5ULL, 25ULL, 125ULL, 625ULL, 3125ULL, 15625ULL, 78125ULL,
+	390625ULL, 1953125ULL, 9765625ULL, 48828125ULL, 244140625ULL,
+	1220703125ULL, 6103515625ULL, 30517578125ULL, 152587890625ULL,
+	762939453125ULL, 3814697265625ULL, 19073486328125ULL,
+	95367431640625ULL, 476837158203125ULL, 2384185791015625ULL,
+	11920928955078125ULL, 59604644775390625ULL, 298023223876953125ULL,
+	1490116119384765625ULL, 7450580596923828125ULL
+};
+
+/* Normalized 64-bit approximations of 10^(2^j) and 10^(-2^j).
+ * */
+static const ftoa_diy_t		ftoa_POW10_POS[6] = {
+
+	{ 0xA000000000000000ULL, -60 },
+	{ 0xC800000000000000ULL, -57 },
+	{ 0x9C40000000000000ULL, -50 },
+	{ 0xBEBC200000000000ULL, -37 },
+	{ 0x8E1BC9BF04000000ULL, -10 },
+	{ 0x9DC5ADA82B70B59EULL, 43 }
+};
+
+static const ftoa_diy_t		ftoa_POW10_NEG[6] = {
+
+	{ 0xCCCCCCCCCCCCCCCDULL, -67 },
+	{ 0xA3D70A3D70A3D70AULL, -70 },
+	{ 0xD1B71758E219652CULL, -77 },
+	{ 0xABCC77118461CEFDULL, -90 },
+	{ 0xE69594BEC44DE15BULL, -117 },
+	{ 0xCFB11EAD453994BAULL, -170 }
+};
+
+static char *
+ftoa_str(char *p, const char *s)
+{
+	while (*s) *p++ = *s++;
+
+	return p;
+}
+
+static char *
+ftoa_uint(char *p, unsigned int x)
+{
+	char		s[12], *t = s + 12;
+
+	do {
+		*--t = '0' + x % 10U;
+		x /= 10U;
+	}
+	while (x);
+
+	while (t < s + 12) *p++ = *t++;
+
+	return p;
+}
+
+static char *
+ftoa_digits(char *p, unsigned int x, int n)
+{
+	int		k;
+
+	for (k = n - 1; k >= 0; --k) {
+
+		p[k] = '0' + x % 10U;
+		x /= 10U;
+	}
+
+	return p + n;
+}
+
+static int
+ftoa_split(char **s, float x, unsigned int *m, int *e)
+{
+	union {
+		float		f;
+		unsigned int	i;
+	}
+	u = { x };
+
+	char		*p = *s;
+	int		be;
+
+	be = (int) ((u.i >> 23) & 0xFFU);
+	*m = u.i & 0x7FFFFFU;
+
+	if ((u.i >> 31) != 0 && (be != 0xFF || *m == 0))
+		*p++ = '-';
+
+	if (be == 0xFF) {
+
+		p = ftoa_str(p, (*m != 0) ? "NaN" : "Inf");
+		*p = 0;
+		*s = p;
+
+		return 0;
+	}
+
+	/* We have x = m * 2^e.
+	 * */
+	if (be != 0) {
+
+		*m |= 0x800000U;
+		*e = be - 150;
+	}
+	else {
+		*e = -149;
+	}
+
+	*s = p;
+
+	return 1;
+}
+
+int ftoa_fixed(char *s, float x, int n)
+{
+	unsigned long long	P, R, H;
+	unsigned int		m, I, F, Q, lsb;
+	int			e, k;
+	char			*p = s;
+
+	if (ftoa_split(&p, x, &m, &e) == 0)
+		return (int) (p - s);
+
+	n = (n < 0) ? 0 : (n > 9) ? 9 : n;
+
+	if (e > 7) {
+
+		p = ftoa_str(p, "MAX");
+		*p = 0;
+
+		return (int) (p - s);
+	}
+
+	if (e >= 0) {
+
+		I = m << e;
+		Q = 0;
+	}
+	else {
+		k = - e;
+
+		if (k < 32) {
+
+			I = m >> k;
+			F = m & ((1U << k) - 1U);
+		}
+		else {
+			I = 0;
+			F = m;
+		}
+
+		/* Fraction digits are F * 10^n / 2^k rounded half to even,
+		 * the product fits in 54 bits.
+		 * */
+		P = (unsigned long long) F * ftoa_POW10[n];
+
+		if (k < 64) {
+
+			Q = (unsigned int) (P >> k);
+			R = P & ((1ULL << k) - 1ULL);
+			H = 1ULL << (k - 1);
+
+			lsb = (n != 0) ? Q : I;
+
+			if (R > H || (R == H && (lsb & 1U) != 0))
+				Q++;
+		}
+		else {
+			Q = 0;
+		}
+
+		if (Q >= ftoa_POW10[n]) {
+
+			Q -= ftoa_POW10[n];
+			I++;
+		}
+	}
+
+	p = ftoa_uint(p, I);
+
+	if (n > 0) {
+
+		*p++ = '.';
+		p = ftoa_digits(p, Q, n);
+	}
+
+	*p = 0;
+
+	return (int) (p - s);
+}
+
+static unsigned long long
+ftoa_scale_exact(unsigned int m, int e, int k)
+{
+	unsigned long long	hi, lo, q, rh, rl, hh, hl;
+	int			t;
+
+	/* The product m * 5^k is the 96-bit number (hi:lo).
+	 * */
+	lo = (unsigned long long) m * (unsigned int) ftoa_POW5[k];
+	hi = (unsigned long long) m * (unsigned int) (ftoa_POW5[k] >> 32) + (lo >> 32);
+	lo &= 0xFFFFFFFFULL;
+
+	t = - (e + k);
+
+	if (t <= 0) {
+
+		return ((hi << 32) | lo) << - t;
+	}
+	else if (t < 32) {
+
+		q = (hi << (32 - t)) | (lo >> t);
+
+		rh = 0;
+		rl = lo & ((1ULL << t) - 1ULL);
+		hh = 0;
+		hl = 1ULL << (t - 1);
+	}
+	else if (t < 96) {
+
+		q = hi >> (t - 32);
+
+		rh = hi & ((1ULL << (t - 32)) - 1ULL);
+		rl = lo;
+		hh = (t > 32) ? 1ULL << (t - 33) : 0;
+		hl = (t > 32) ? 0 : 1ULL << 31;
+	}
+	else {
+		return 0;
+	}
+
+	if (rh > hh || (rh == hh && (rl > hl || (rl == hl && (q & 1U) != 0))))
+		q++;
+
+	return q;
+}
+
+static ftoa_diy_t
+ftoa_diy_mul(ftoa_diy_t x, ftoa_diy_t y)
+{
+	unsigned long long	a, b, c, d, ac, bc, ad, bd, tmp;
+	ftoa_diy_t		r;
+
+	a = x.f >> 32;
+	b = x.f & 0xFFFFFFFFULL;
+	c = y.f >> 32;
+	d = y.f & 0xFFFFFFFFULL;
+
+	ac = a * c;
+	bc = b * c;
+	ad = a * d;
+	bd = b * d;
+
+	tmp = (bd >> 32) + (ad & 0xFFFFFFFFULL) + (bc & 0xFFFFFFFFULL) + (1ULL << 31);
+
+	r.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+	r.e = x.e + y.e + 64;
+
+	if ((r.f >> 63) == 0) {
+
+		r.f <<= 1;
+		r.e -= 1;
+	}
+
+	return r;
+}
+
+static unsigned long long
+ftoa_scale_diy(unsigned int m, int e, int k)
+{
+	const ftoa_diy_t	*pow = (k < 0) ? ftoa_POW10_NEG : ftoa_POW10_POS;
+	ftoa_diy_t		v;
+	int			j, a, t;
+
+	v.f = (unsigned long long) m << 40;
+	v.e = e - 40;
+
+	a = (k < 0) ? - k : k;
+
+	for (j = 0; j < 6; ++j) {
+
+		if (a & (1 << j))
+			v = ftoa_diy_mul(v, pow[j]);
+	}
+
+	t = - v.e;
+
+	if (t <= 0)
+		return v.f << - t;
+	else if (t >= 64)
+		return 0;
+
+	return (v.f >> t) + ((v.f >> (t - 1)) & 1ULL);
+}
+
+static unsigned long long
+ftoa_scale(unsigned int m, int e, int k)
+{
+	unsigned int		X, D;
+
+	/* Get m * 2^e * 10^k rounded to integer. Exact paths cover all the
+	 * cases where the tie is possible, otherwise 64-bit approximation is
+	 * used.
+	 * */
+	if (k >= 0 && k < 28)
+		return ftoa_scale_exact(m, e, k);
+
+	if (k < 0 && k > -10) {
+
+		if (e >= 0 && e <= 8) {
+
+			X = m << e;
+		}
+		else if (e < 0 && e > -24 && (m & ((1U << - e) - 1U)) == 0) {
+
+			X = m >> - e;
+		}
+		else {
+			return ftoa_scale_diy(m, e, k);
+		}
+
+		D = ftoa_POW10[- k];
+
+		if (2U * (X % D) > D || (2U * (X % D) == D && ((X / D) & 1U) != 0))
+			return X / D + 1U;
+		else
+			return X / D;
+	}
+
+	return ftoa_scale_diy(m, e, k);
+}
+
+int ftoa_fexp(char *s, float x, int n)
+{
+	unsigned long long	q;
+	unsigned int		m;
+	int			e, e10, j;
+	char			*p = s;
+
+	if (ftoa_split(&p, x, &m, &e) == 0)
+		return (int) (p - s);
+
+	n = (n < 0) ? 0 : (n > 8) ? 8 : n;
+
+	if (m == 0) {
+
+		q = 0;
+		e10 = 0;
+	}
+	else {
+		while (m < 0x800000U) {
+
+			m <<= 1;
+			e -= 1;
+		}
+
+		/* Estimate decimal exponent as floor((e + 23) * log10(2)) then
+		 * correct it by the magnitude of the scaled value.
+		 * */
+		e10 = ((e + 23) * 78913) >> 18;
+
+		for (j = 0; j < 3; ++j) {
+
+			q = ftoa_scale(m, e, n - e10);
+
+			if (q >= ftoa_POW10[n + 1])
+				e10++;
+			else if (q < ftoa_POW10[n])
+				e10--;
+			else
+				break;
+		}
+	}
+
+	ftoa_digits(p + 1, (unsigned int) q, n + 1);
+
+	p[0] = p[1];
+
+	if (n > 0) {
+
+		p[1] = '.';
+		p += n + 2;
+	}
+	else {
+		p += 1;
+	}
+
+	*p++ = 'E';
+
+	if (e10 < 0) {
+
+		*p++ = '-';
+		e10 = - e10;
+	}
+	else {
+		*p++ = '+';
+	}
+
+	p = ftoa_uint(p, (unsigned int) e10);
+	*p = 0;
+
+	return (int) (p - s);
+}
+
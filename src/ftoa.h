@@ -0,0 +1,16 @@
+#ifndef _H_FTOA_
+#define _H_FTOA_
+
+#define FTOA_STRING_MAX			24
+
+/* Exact conversion of float to decimal text. The result is correctly rounded
+ * (half to even) for the fixed format with up to 9 digits and for the
+ * exponential format with up to 8 digits. No floating point operations and no
+ * 64-bit division are used.
+ * */
+
+int ftoa_fixed(char *s, float x, int n);
+int ftoa_fexp(char *s, float x, int n);
+
+#endif /* _H_FTOA_ */
+
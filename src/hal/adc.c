@@ -111,6 +111,15 @@ void ADC_startup()
 	 * */
 	ADC2->CR1 = ADC_CR1_SCAN | ADC_CR1_JEOCIE;
 	ADC2->CR2 = ADC_CR2_JEXTEN_0;
+
+	if (hal.PWM_dual != 0) {
+
+		/* Trigger on both edges of TIM1 OC4REF. The compare value
+		 * alternates in TIM1 update IRQ so that conversion starts
+		 * ADVANCE ticks before both the peak and the valley.
+		 * */
+		ADC2->CR2 |= ADC_CR2_JEXTEN_1;
+	}
 	ADC2->SMPR1 = ADC_SMPR1_SMP18_0 | ADC_SMPR1_SMP17_0 | ADC_SMPR1_SMP16_0
 		| ADC_SMPR1_SMP15_0 | ADC_SMPR1_SMP14_0 | ADC_SMPR1_SMP13_0
 		| ADC_SMPR1_SMP12_0 | ADC_SMPR1_SMP11_0 | ADC_SMPR1_SMP10_0;
@@ -126,7 +135,7 @@ void ADC_startup()
 	/* Configure ADC3.
 	 * */
 	ADC3->CR1 = ADC_CR1_SCAN;
-	ADC3->CR2 = ADC_CR2_JEXTEN_0;
+	ADC3->CR2 = ADC2->CR2;
 	ADC3->SMPR1 = ADC_SMPR1_SMP18_0 | ADC_SMPR1_SMP17_0 | ADC_SMPR1_SMP16_0
 		| ADC_SMPR1_SMP15_0 | ADC_SMPR1_SMP14_0 | ADC_SMPR1_SMP13_0
 		| ADC_SMPR1_SMP12_0 | ADC_SMPR1_SMP11_0 | ADC_SMPR1_SMP10_0;
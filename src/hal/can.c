@@ -1,36 +1,113 @@
+#include <stddef.h>
+
 #include "cmsis/stm32f4xx.h"
 #include "hal.h"
 
 #define GPIO_CAN_RX			XGPIO_DEF4('B', 8, 0, 9)
 #define GPIO_CAN_TX			XGPIO_DEF4('B', 9, 0, 9)
 
-void irq_CAN1_TX() { }
+static const int	CAN_TX_DEPTH[CAN_TX_PRIO_MAX] = { 8, 16, 32 };
+
+static void
+CAN_tx_mailbox(int mailbox, const can_msg_t *msg)
+{
+	const unsigned char	*payload = msg->payload;
+
+	CAN1->sTxMailBox[mailbox].TIR = (msg->ID << 21);
+	CAN1->sTxMailBox[mailbox].TDTR = msg->len;
+
+	CAN1->sTxMailBox[mailbox].TDLR =
+		((unsigned long) payload[0])
+		| ((unsigned long) payload[1] << 8)
+		| ((unsigned long) payload[2] << 16)
+		| ((unsigned long) payload[3] << 24);
+
+	if (msg->len > 4) {
+
+		CAN1->sTxMailBox[mailbox].TDHR =
+			((unsigned long) payload[4])
+			| ((unsigned long) payload[5] << 8)
+			| ((unsigned long) payload[6] << 16)
+			| ((unsigned long) payload[7] << 24);
+	}
+
+	CAN1->sTxMailBox[mailbox].TIR |= CAN_TI0R_TXRQ;
+}
+
+void irq_CAN1_TX()
+{
+	can_msg_t		msg;
+	int			mailbox, prio;
+
+	/* Clear the request completed flags.
+	 * */
+	CAN1->TSR = CAN_TSR_RQCP0 | CAN_TSR_RQCP1 | CAN_TSR_RQCP2;
+
+	for (mailbox = 0; mailbox < 3; ++mailbox) {
+
+		if ((CAN1->TSR & (CAN_TSR_TME0 << mailbox)) == 0)
+			continue;
+
+		/* Take the frame of the highest priority queued.
+		 * */
+		for (prio = 0; prio < CAN_TX_PRIO_MAX; ++prio) {
+
+			if (canring_pop(&hal.CAN_tx_ring[prio], &msg) != 0)
+				break;
+		}
+
+		if (prio >= CAN_TX_PRIO_MAX)
+			break;
+
+		CAN_tx_mailbox(mailbox, &msg);
+	}
+}
 
 static void
 irq_CAN1_RX(int fifo)
 {
+	can_msg_t		*msg;
 	unsigned long		temp;
 
-	hal.CAN_msg_ID = (unsigned long) (CAN1->sFIFOMailBox[fifo].RIR >> 21);
-	hal.CAN_msg_len = (int) (CAN1->sFIFOMailBox[fifo].RDTR & 0xFUL);
+	msg = canring_alloc(&hal.CAN_ring);
+
+	if (msg != NULL) {
+
+		msg->ID = (unsigned long) (CAN1->sFIFOMailBox[fifo].RIR >> 21);
+		msg->len = (int) (CAN1->sFIFOMailBox[fifo].RDTR & 0xFUL);
+
+		/* DLC of 9 to 15 is valid and means 8 bytes.
+		 * */
+		msg->len = (msg->len > 8) ? 8 : msg->len;
 
-	temp = CAN1->sFIFOMailBox[fifo].RDLR;
+		temp = CAN1->sFIFOMailBox[fifo].RDLR;
 
-	hal.CAN_msg_payload[0] = (unsigned char) (temp & 0xFFUL);
-	hal.CAN_msg_payload[1] = (unsigned char) ((temp >> 8) & 0xFFUL);
-	hal.CAN_msg_payload[2] = (unsigned char) ((temp >> 16) & 0xFFUL);
-	hal.CAN_msg_payload[3] = (unsigned char) ((temp >> 24) & 0xFFUL);
+		msg->payload[0] = (unsigned char) (temp & 0xFFUL);
+		msg->payload[1] = (unsigned char) ((temp >> 8) & 0xFFUL);
+		msg->payload[2] = (unsigned char) ((temp >> 16) & 0xFFUL);
+		msg->payload[3] = (unsigned char) ((temp >> 24) & 0xFFUL);
 
-	if (hal.CAN_msg_len > 4) {
+		if (msg->len > 4) {
 
-		temp = CAN1->sFIFOMailBox[fifo].RDHR;
+			temp = CAN1->sFIFOMailBox[fifo].RDHR;
 
-		hal.CAN_msg_payload[4] = (unsigned char) (temp & 0xFFUL);
-		hal.CAN_msg_payload[5] = (unsigned char) ((temp >> 8) & 0xFFUL);
-		hal.CAN_msg_payload[6] = (unsigned char) ((temp >> 16) & 0xFFUL);
-		hal.CAN_msg_payload[7] = (unsigned char) ((temp >> 24) & 0xFFUL);
+			msg->payload[4] = (unsigned char) (temp & 0xFFUL);
+			msg->payload[5] = (unsigned char) ((temp >> 8) & 0xFFUL);
+			msg->payload[6] = (unsigned char) ((temp >> 16) & 0xFFUL);
+			msg->payload[7] = (unsigned char) ((temp >> 24) & 0xFFUL);
+		}
+
+		canring_commit(&hal.CAN_ring);
 	}
 
+	/* FOVR bit has the same position in both FIFO registers, it is
+	 * cleared by the write back along with the FIFO release.
+	 * */
+	temp = (fifo == 0) ? CAN1->RF0R : CAN1->RF1R;
+
+	if (temp & CAN_RF0R_FOVR0)
+		hal.CAN_overrun_N++;
+
 	if (fifo == 0) CAN1->RF0R |= CAN_RF0R_RFOM0;
 	else CAN1->RF1R |= CAN_RF1R_RFOM1;
 
@@ -54,9 +131,10 @@ void CAN_startup()
 	GPIO_set_mode_FUNCTION(GPIO_CAN_RX);
 	GPIO_set_mode_FUNCTION(GPIO_CAN_TX);
 
-	/* Mode Initialization.
+	/* Mode Initialization. Mailboxes are sent in the order of request
+	 * to keep the frame order of the queue.
 	 * */
-	CAN1->MCR = CAN_MCR_ABOM | CAN_MCR_NART | CAN_MCR_INRQ;
+	CAN1->MCR = CAN_MCR_ABOM | CAN_MCR_TXFP | CAN_MCR_INRQ;
 
 	do {
 		INAK = CAN1->MSR & CAN_MSR_INAK;
@@ -64,14 +142,19 @@ void CAN_startup()
 	}
 	while (INAK == 0 && N < 70000UL);
 
-	CAN1->IER = CAN_IER_FMPIE0 | CAN_IER_FMPIE1;
+	for (N = 0; N < CAN_TX_PRIO_MAX; ++N)
+		hal.CAN_tx_ring[N].depth = CAN_TX_DEPTH[N];
+
+	CAN1->IER = CAN_IER_TMEIE | CAN_IER_FMPIE0 | CAN_IER_FMPIE1;
 	CAN1->BTR = (5UL << 20) | (6UL << 16) | (2UL);
 
 	/* Enable IRQs.
 	 * */
+	NVIC_SetPriority(CAN1_TX_IRQn, 7);
 	NVIC_SetPriority(CAN1_RX0_IRQn, 7);
 	NVIC_SetPriority(CAN1_RX1_IRQn, 7);
 	NVIC_SetPriority(CAN1_SCE_IRQn, 7);
+	NVIC_EnableIRQ(CAN1_TX_IRQn);
 	NVIC_EnableIRQ(CAN1_RX0_IRQn);
 	NVIC_EnableIRQ(CAN1_RX1_IRQn);
 	NVIC_EnableIRQ(CAN1_SCE_IRQn);
@@ -98,43 +181,51 @@ void CAN_set_filter(int nfilt, int fifo, unsigned long ID, unsigned long mID)
 
 	CAN1->FA1R |= bfilt;
 
-	CAN1->MCR &= ~CAN_MCR_INRQ;
+	CAN1->FMR &= ~CAN_FMR_FINIT;
 }
 
-void CAN_send_msg(unsigned long ID, int len, const unsigned char payload[8])
+int CAN_send_burst(int prio, const can_msg_t *msg, int N)
 {
-	int		mailbox;
-
-	if (CAN1->TSR & CAN_TSR_TME0)
-		mailbox = 0;
-	else if (CAN1->TSR & CAN_TSR_TME1)
-		mailbox = 1;
-	else if (CAN1->TSR & CAN_TSR_TME2)
-		mailbox = 2;
-	else {
-		/* Message is discarded.
+	canring_t	*ring = &hal.CAN_tx_ring[prio];
+	can_msg_t	*slot;
+	int		j;
+
+	if (canring_space(ring) < N) {
+
+		/* Burst is discarded as a whole.
 		 * */
-		return ;
+		ring->overflow_N += N;
+
+		return -1;
 	}
 
-	CAN1->sTxMailBox[mailbox].TIR = (ID << 21);
-	CAN1->sTxMailBox[mailbox].TDTR = len;
+	for (j = 0; j < N; ++j) {
 
-	CAN1->sTxMailBox[mailbox].TDLR =
-		((unsigned long) payload[0])
-		| ((unsigned long) payload[1] << 8)
-		| ((unsigned long) payload[2] << 16)
-		| ((unsigned long) payload[3] << 24);
+		slot = canring_alloc(ring);
 
-	if (len > 4) {
+		*slot = msg[j];
 
-		CAN1->sTxMailBox[mailbox].TDHR =
-			((unsigned long) payload[4])
-			| ((unsigned long) payload[5] << 8)
-			| ((unsigned long) payload[6] << 16)
-			| ((unsigned long) payload[7] << 24);
+		canring_commit(ring);
 	}
 
-	CAN1->sTxMailBox[mailbox].TIR |= CAN_TI0R_TXRQ;
+	/* TX interrupt takes the frames into free mailboxes.
+	 * */
+	NVIC_SetPendingIRQ(CAN1_TX_IRQn);
+
+	return 0;
+}
+
+int CAN_send_msg(unsigned long ID, int len, const unsigned char payload[8])
+{
+	can_msg_t	msg;
+	int		j;
+
+	msg.ID = ID;
+	msg.len = len;
+
+	for (j = 0; j < len; ++j)
+		msg.payload[j] = payload[j];
+
+	return CAN_send_burst(CAN_TX_NORMAL, &msg, 1);
 }
 
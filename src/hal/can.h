@@ -1,9 +1,23 @@
 #ifndef _H_CAN_
 #define _H_CAN_
 
+#include "canring.h"
+
+enum {
+	CAN_TX_URGENT		= 0,
+	CAN_TX_NORMAL,
+	CAN_TX_BULK,
+	CAN_TX_PRIO_MAX
+};
+
+/* Frames to send are queued by priority and taken into TX mailboxes by
+ * interrupt. Queues are filled by single task only.
+ * */
+
 void CAN_startup();
 void CAN_set_filter(int nfilt, int fifo, unsigned long ID, unsigned long mID);
-void CAN_send_msg(unsigned long ID, int len, const unsigned char payload[8]);
+int CAN_send_burst(int prio, const can_msg_t *msg, int N);
+int CAN_send_msg(unsigned long ID, int len, const unsigned char payload[8]);
 
 extern void CAN_IRQ();
 
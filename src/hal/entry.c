@@ -22,6 +22,8 @@ void irq_PendSV();
 void irq_SysTick();
 
 void irq_EXTI0();
+void irq_DMA1_Stream1();
+void irq_DMA1_Stream3();
 void irq_ADC();
 void irq_CAN1_TX();
 void irq_CAN1_RX0();
@@ -63,9 +65,9 @@ __attribute__ (( section(".vectors"), used )) void * vectors[] = {
 	irq_Default,
 	irq_Default,
 	irq_Default,
+	irq_DMA1_Stream1,
 	irq_Default,
-	irq_Default,
-	irq_Default,
+	irq_DMA1_Stream3,
 	irq_Default,
 	irq_Default,
 	irq_Default,
@@ -2,6 +2,7 @@
 #include "hal.h"
 
 #include "libc.h"
+#include "prof.h"
 
 #define CLOCK_CRYSTAL_HZ		12000000UL
 #define CLOCK_CPU_TARGET_HZ		168000000UL
@@ -69,6 +70,12 @@ base_startup()
 	/* Configure priority grouping.
 	 * */
 	NVIC_SetPriorityGrouping(0UL);
+
+	/* Enable DWT cycle counter.
+	 * */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0UL;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 }
 
 static void
@@ -194,6 +201,12 @@ periph_startup()
 	RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN | RCC_AHB1ENR_GPIOBEN
 		| RCC_AHB1ENR_GPIOCEN;
 
+#ifdef _HW_CRC32
+	/* Enable CRC clock.
+	 * */
+	RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN;
+#endif /* _HW_CRC32 */
+
 	/* Check for reset reason.
 	 * */
 	if (RCC->CSR & RCC_CSR_WDGRSTF) {
@@ -271,6 +284,29 @@ void hal_fence()
 	__DMB();
 }
 
+unsigned long prof_clock()
+{
+	return DWT->CYCCNT;
+}
+
+int hal_lock_irq()
+{
+	int		irq;
+
+	irq = __get_PRIMASK();
+
+	__disable_irq();
+	__DSB();
+	__ISB();
+
+	return irq;
+}
+
+void hal_unlock_irq(int irq)
+{
+	__set_PRIMASK(irq);
+}
+
 void log_putc(int c)
 {
 	if (log.finit != INIT_SIGNATURE) {
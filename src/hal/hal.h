@@ -62,6 +62,7 @@ typedef struct {
 	float		PWM_frequency;
 	int		PWM_resolution;
 	float		PWM_deadtime;
+	int		PWM_dual;
 
 	float		ADC_reference_voltage;
 	float		ADC_shunt_resistance;
@@ -89,9 +90,9 @@ typedef struct {
 
 	int		TIM_mode;
 
-	unsigned long	CAN_msg_ID;
-	int		CAN_msg_len;
-	unsigned char	CAN_msg_payload[8];
+	canring_t	CAN_ring;
+	canring_t	CAN_tx_ring[CAN_TX_PRIO_MAX];
+	int		CAN_overrun_N;
 
 	int		PPM_mode;
 	int		PPM_timebase;
@@ -120,6 +121,9 @@ void hal_bootload_jump();
 void hal_sleep();
 void hal_fence();
 
+int hal_lock_irq();
+void hal_unlock_irq(int irq);
+
 void log_putc(int c);
 int log_validate();
 
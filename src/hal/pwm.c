@@ -11,7 +11,20 @@
 #define CLOCK_TIM1_HZ			(CLOCK_APB2_HZ * 2UL)
 #define TIM_ADC_ADVANCE			60
 
-void irq_TIM1_UP_TIM10() { }
+void irq_TIM1_UP_TIM10()
+{
+	int		R;
+
+	TIM1->SR = ~TIM_SR_UIF;
+
+	R = TIM1->ARR;
+
+	/* In the double update mode we arm the ADC trigger for the half
+	 * period that follows the next update. OC4REF rises ADVANCE ticks
+	 * before the peak and falls ADVANCE ticks before the valley.
+	 * */
+	TIM1->CCR4 = (TIM1->CR1 & TIM_CR1_DIR) ? R - TIM_ADC_ADVANCE : TIM_ADC_ADVANCE;
+}
 
 static int
 PWM_calculate_R()
@@ -73,7 +86,21 @@ void PWM_startup()
 	 * */
 	TIM1->EGR |= TIM_EGR_COMG | TIM_EGR_UG;
 	TIM1->CR1 |= TIM_CR1_CEN;
-	TIM1->RCR = 1;
+
+	/* In the double update mode the preload is transferred both at the
+	 * peak and at the valley so we get two control updates per period.
+	 * */
+	TIM1->RCR = (hal.PWM_dual != 0) ? 0 : 1;
+
+	if (hal.PWM_dual != 0) {
+
+		/* Enable update IRQ to alternate the ADC trigger.
+		 * */
+		TIM1->DIER = TIM_DIER_UIE;
+
+		NVIC_SetPriority(TIM1_UP_TIM10_IRQn, 0);
+		NVIC_EnableIRQ(TIM1_UP_TIM10_IRQn);
+	}
 
 	/* Enable TIM1 pins.
 	 * */
@@ -99,11 +126,34 @@ void PWM_configure()
 	D = PWM_calculate_D();
 
 	TIM1->ARR = R;
-	TIM1->CCR4 = R - TIM_ADC_ADVANCE;
+
+	if (hal.PWM_dual == 0) {
+
+		TIM1->CCR4 = R - TIM_ADC_ADVANCE;
+	}
 
 	MODIFY_REG(TIM1->BDTR, 0xFF, D);
 }
 
+int PWM_set_FREQ(float freq)
+{
+	int		R;
+
+	/* Runtime change of the switching frequency. We do not touch the
+	 * configured PWM_frequency here.
+	 * */
+	R = (int) ((float) CLOCK_TIM1_HZ / 2.f / freq + .5f);
+
+	TIM1->ARR = R;
+
+	if (hal.PWM_dual == 0) {
+
+		TIM1->CCR4 = R - TIM_ADC_ADVANCE;
+	}
+
+	return R;
+}
+
 void PWM_set_DC(int A, int B, int C)
 {
 	TIM1->CCR1 = A;
@@ -146,3 +196,10 @@ void PWM_halt_Z()
 	TIM1->EGR |= TIM_EGR_COMG;
 }
 
+
+int PWM_get_VALLEY()
+{
+	/* After the underflow TIM1 is counting up.
+	 * */
+	return (TIM1->CR1 & TIM_CR1_DIR) ? 0 : 1;
+}
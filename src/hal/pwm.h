@@ -4,9 +4,12 @@
 void PWM_startup();
 void PWM_configure();
 
+int PWM_set_FREQ(float freq);
 void PWM_set_DC(int A, int B, int C);
 void PWM_set_Z(int Z);
 void PWM_halt_Z();
 
+int PWM_get_VALLEY();
+
 #endif /* _H_PWM_ */
 
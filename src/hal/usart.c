@@ -1,42 +1,100 @@
 #include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "cmsis/stm32f4xx.h"
 #include "hal.h"
 
 #define GPIO_USART3_TX			XGPIO_DEF4('C', 10, 0, 7)
 #define GPIO_USART3_RX			XGPIO_DEF4('C', 11, 0, 7)
 
+#define USART_RX_SZ			128
+#define USART_TX_SZ			128
+
 typedef struct {
 
-	QueueHandle_t		xRX;
-	QueueHandle_t		xTX;
+	SemaphoreHandle_t	xRX;
+	SemaphoreHandle_t	xTX;
+
+	char			rx_buf[USART_RX_SZ];
+	int			rx_N;
+
+	char			tx_buf[2][USART_TX_SZ];
+	int			tx_N;
+	int			tx_len;
+	int			tx_busy;
 }
 HAL_USART_t;
 
 static HAL_USART_t		hal_USART;
 
+static void
+USART_tx_kick()
+{
+	if (hal_USART.tx_busy == 0 && hal_USART.tx_len > 0) {
+
+		/* Start DMA on the filled buffer and switch to another one.
+		 * */
+		DMA1->LIFCR = DMA_LIFCR_CTCIF3 | DMA_LIFCR_CHTIF3
+			| DMA_LIFCR_CTEIF3 | DMA_LIFCR_CDMEIF3 | DMA_LIFCR_CFEIF3;
+
+		DMA1_Stream3->M0AR = (unsigned int) hal_USART.tx_buf[hal_USART.tx_N];
+		DMA1_Stream3->NDTR = hal_USART.tx_len;
+		DMA1_Stream3->CR |= DMA_SxCR_EN;
+
+		hal_USART.tx_busy = 1;
+		hal_USART.tx_N ^= 1;
+		hal_USART.tx_len = 0;
+
+		GPIO_set_HIGH(GPIO_LED);
+	}
+}
+
 void irq_USART3()
 {
 	BaseType_t		xWoken = pdFALSE;
 	unsigned int 		SR;
-	char			xC;
 
 	SR = USART3->SR;
 
-	if (SR & USART_SR_RXNE) {
+	if (SR & USART_SR_IDLE) {
+
+		/* Clear IDLE flag by the read sequence.
+		 * */
+		SR = USART3->DR;
 
-		xC = USART3->DR;
-		xQueueSendToBackFromISR(hal_USART.xRX, &xC, &xWoken);
+		xSemaphoreGiveFromISR(hal_USART.xRX, &xWoken);
 	}
 
-	if (SR & USART_SR_TXE) {
+	portYIELD_FROM_ISR(xWoken);
+}
 
-		if (xQueueReceiveFromISR(hal_USART.xTX, &xC, &xWoken) == pdTRUE) {
+void irq_DMA1_Stream1()
+{
+	BaseType_t		xWoken = pdFALSE;
 
-			USART3->DR = xC;
-		}
-		else {
-			USART3->CR1 &= ~USART_CR1_TXEIE;
-		}
+	DMA1->LIFCR = DMA_LIFCR_CTCIF1 | DMA_LIFCR_CHTIF1;
+
+	xSemaphoreGiveFromISR(hal_USART.xRX, &xWoken);
+
+	portYIELD_FROM_ISR(xWoken);
+}
+
+void irq_DMA1_Stream3()
+{
+	BaseType_t		xWoken = pdFALSE;
+
+	if (DMA1->LISR & DMA_LISR_TCIF3) {
+
+		DMA1->LIFCR = DMA_LIFCR_CTCIF3;
+
+		hal_USART.tx_busy = 0;
+
+		GPIO_set_LOW(GPIO_LED);
+
+		/* Chain the next buffer if anything was written.
+		 * */
+		USART_tx_kick();
+
+		xSemaphoreGiveFromISR(hal_USART.xTX, &xWoken);
 	}
 
 	portYIELD_FROM_ISR(xWoken);
@@ -44,55 +102,130 @@ void irq_USART3()
 
 void USART_startup()
 {
-	/* Enable USART3 clock.
+	/* Enable USART3 and DMA1 clock.
 	 * */
 	RCC->APB1ENR |= RCC_APB1ENR_USART3EN;
+	RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
 
 	/* Enable USART3 pins.
 	 * */
 	GPIO_set_mode_FUNCTION(GPIO_USART3_TX);
 	GPIO_set_mode_FUNCTION(GPIO_USART3_RX);
 
-	/* Alloc queues.
+	/* Alloc semaphores.
 	 * */
-	hal_USART.xRX = xQueueCreate(40, sizeof(char));
-	hal_USART.xTX = xQueueCreate(80, sizeof(char));
+	hal_USART.xRX = xSemaphoreCreateBinary();
+	hal_USART.xTX = xSemaphoreCreateBinary();
+
+	hal_USART.rx_N = 0;
+	hal_USART.tx_N = 0;
+	hal_USART.tx_len = 0;
+	hal_USART.tx_busy = 0;
 
 	/* Configure USART.
 	 * */
 	USART3->BRR = CLOCK_APB1_HZ / hal.USART_baud_rate;
 	USART3->CR1 = USART_CR1_UE | USART_CR1_M | USART_CR1_PCE
-		| USART_CR1_RXNEIE | USART_CR1_TE | USART_CR1_RE;
+		| USART_CR1_IDLEIE | USART_CR1_TE | USART_CR1_RE;
 	USART3->CR2 = 0;
-	USART3->CR3 = 0;
+	USART3->CR3 = USART_CR3_DMAT | USART_CR3_DMAR;
+
+	/* Configure DMA1 Stream1 (channel 4) to receive into the circular
+	 * buffer.
+	 * */
+	DMA1_Stream1->CR = DMA_SxCR_CHSEL_2 | DMA_SxCR_MINC | DMA_SxCR_CIRC
+		| DMA_SxCR_HTIE | DMA_SxCR_TCIE;
+	DMA1_Stream1->PAR = (unsigned int) &USART3->DR;
+	DMA1_Stream1->M0AR = (unsigned int) hal_USART.rx_buf;
+	DMA1_Stream1->NDTR = USART_RX_SZ;
+	DMA1_Stream1->FCR = 0;
+	DMA1_Stream1->CR |= DMA_SxCR_EN;
+
+	/* Configure DMA1 Stream3 (channel 4) to transmit.
+	 * */
+	DMA1_Stream3->CR = DMA_SxCR_CHSEL_2 | DMA_SxCR_MINC | DMA_SxCR_DIR_0
+		| DMA_SxCR_TCIE;
+	DMA1_Stream3->PAR = (unsigned int) &USART3->DR;
+	DMA1_Stream3->FCR = 0;
 
 	/* Enable IRQ.
 	 * */
 	NVIC_SetPriority(USART3_IRQn, 11);
+	NVIC_SetPriority(DMA1_Stream1_IRQn, 11);
+	NVIC_SetPriority(DMA1_Stream3_IRQn, 11);
 	NVIC_EnableIRQ(USART3_IRQn);
+	NVIC_EnableIRQ(DMA1_Stream1_IRQn);
+	NVIC_EnableIRQ(DMA1_Stream3_IRQn);
 }
 
 int USART_getc()
 {
-	char		xC;
+	int		rx_W, xC;
+
+	do {
+		/* Write position of DMA in the circular buffer.
+		 * */
+		rx_W = USART_RX_SZ - DMA1_Stream1->NDTR;
+		rx_W = (rx_W < USART_RX_SZ) ? rx_W : 0;
+
+		if (hal_USART.rx_N != rx_W) {
 
-	xQueueReceive(hal_USART.xRX, &xC, portMAX_DELAY);
+			xC = hal_USART.rx_buf[hal_USART.rx_N];
+			hal_USART.rx_N = (hal_USART.rx_N < USART_RX_SZ - 1)
+				? hal_USART.rx_N + 1 : 0;
 
-	return (int) xC;
+			break;
+		}
+
+		xSemaphoreTake(hal_USART.xRX, portMAX_DELAY);
+	}
+	while (1);
+
+	return xC;
 }
 
-void USART_putc(int c)
+void USART_write(const void *s, int n)
 {
-	char		xC = (char) c;
+	const char		*xs = (const char *) s;
+	char			*xd;
+	int			len;
+
+	while (n > 0) {
 
-	GPIO_set_HIGH(GPIO_LED);
+		taskENTER_CRITICAL();
 
-	if (xQueueSendToBack(hal_USART.xTX, &xC, portMAX_DELAY) == pdTRUE) {
+		len = USART_TX_SZ - hal_USART.tx_len;
+		len = (len < n) ? len : n;
 
-		USART3->CR1 |= USART_CR1_TXEIE;
+		xd = hal_USART.tx_buf[hal_USART.tx_N] + hal_USART.tx_len;
+
+		hal_USART.tx_len += len;
+		n -= len;
+
+		while (len > 0) {
+
+			*xd++ = *xs++;
+			len--;
+		}
+
+		USART_tx_kick();
+
+		taskEXIT_CRITICAL();
+
+		if (n > 0) {
+
+			/* Wait for DMA to release the buffer.
+			 * */
+			xSemaphoreTake(hal_USART.xTX, portMAX_DELAY);
+		}
 	}
+}
+
+void USART_putc(int c)
+{
+	char		xC = (char) c;
 
-	GPIO_set_LOW(GPIO_LED);
+	USART_write(&xC, 1);
 }
 
 void USART_debug_putc(int c)
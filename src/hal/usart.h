@@ -3,6 +3,7 @@
 
 void USART_startup();
 int USART_getc();
+void USART_write(const void *s, int n);
 void USART_putc(int c);
 void USART_debug_putc(int c);
 
@@ -1,16 +1,155 @@
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "hal/hal.h"
 
+#include "canproto.h"
 #include "libc.h"
 #include "main.h"
+#include "regbin.h"
 #include "regfile.h"
 #include "shell.h"
 
+#define IFCAN_BATCH_MAX			8
+
+static canproto_t		ifcan;
+static regbin_t			ifcan_regbin;
+static TaskHandle_t		ifcan_xTask;
+
 void CAN_IRQ()
 {
+	BaseType_t		xWoken = pdFALSE;
+
+	/* Frame is already in the ring so we just wake up the task.
+	 * */
+	vTaskNotifyGiveFromISR(ifcan_xTask, &xWoken);
+
+	portYIELD_FROM_ISR(xWoken);
+}
+
+static void
+ifcan_send(void *bus, const can_msg_t *msg, int N)
+{
+	int		prio;
+
+	/* Register responses go behind the state broadcast.
+	 * */
+	prio = (CANPROTO_FUNC(msg->ID) == CANPROTO_REG_RESP)
+		? CAN_TX_BULK : CAN_TX_NORMAL;
+
+	CAN_send_burst(prio, msg, N);
+}
+
+static void
+ifcan_lock(int lock)
+{
+	if (lock != 0) {
+
+		taskENTER_CRITICAL();
+		ADC_irq_lock();
+	}
+	else {
+		ADC_irq_unlock();
+		taskEXIT_CRITICAL();
+	}
+}
+
+static int
+ifcan_reg(void *reg, const unsigned char *req, int len,
+		unsigned char *resp, int max)
+{
+	return regbin_call((regbin_t *) reg, req, len, resp, max);
+}
+
+static void
+ifcan_filter()
+{
+	ifcan.node_ID = ap.can_node_ID;
+
+	/* Frames addressed to our node go to FIFO0 and the broadcast
+	 * frames to FIFO1.
+	 * */
+	CAN_set_filter(0, 0, ifcan.node_ID, 0x7FUL);
+	CAN_set_filter(1, 1, 0UL, 0x7FUL);
+}
+
+void task_CAN(void *pData)
+{
+	can_msg_t		msg;
+	TickType_t		xWait, xGone;
+	int			N;
+
+	do {
+		if (ap.can_node_ID != ifcan.node_ID)
+			ifcan_filter();
+
+		if (ap.can_state_rate > 0) {
+
+			ifcan.state_ms = (ap.can_state_rate < 1000)
+				? 1000 / ap.can_state_rate : 1;
+
+			/* Sleep until the next broadcast if nothing received.
+			 * */
+			xGone = xTaskGetTickCount() - (TickType_t) ifcan.state_clock;
+			xWait = (xGone < (TickType_t) ifcan.state_ms)
+				? (TickType_t) ifcan.state_ms - xGone : (TickType_t) 0;
+		}
+		else {
+			ifcan.state_ms = 0;
+			xWait = (TickType_t) 100;
+		}
+
+		if (canring_count(&hal.CAN_ring) == 0) {
+
+			ulTaskNotifyTake(pdTRUE, xWait);
+		}
+
+		/* Dispatch the frames received so far but not too many at
+		 * once to keep the broadcast in time.
+		 * */
+		for (N = 0; N < IFCAN_BATCH_MAX; ++N) {
+
+			if (canring_pop(&hal.CAN_ring, &msg) == 0)
+				break;
+
+			canproto_input(&ifcan, &msg);
+		}
+
+		canproto_periodic(&ifcan, (unsigned long) xTaskGetTickCount());
+	}
+	while (1);
 }
 
 void ifcan_startup()
 {
+	if (ap.can_node_ID < 1 || ap.can_node_ID > CANPROTO_NODE_MAX)
+		return ;
+
+	ifcan.pm = &pm;
+	ifcan.proc_send = &ifcan_send;
+	ifcan.proc_lock = &ifcan_lock;
+	ifcan.reg = &ifcan_regbin;
+	ifcan.proc_reg = &ifcan_reg;
+
+	xTaskCreate(task_CAN, "CAN", 300, NULL, 3, &ifcan_xTask);
+
+	CAN_startup();
+	ifcan_filter();
+}
+
+SH_DEF(ifcan_info)
+{
+	int		N;
+
+	printf("node %i rx %i tx %i" EOL, ifcan.node_ID, ifcan.rx_N, ifcan.tx_N);
+	printf("ring overflow %i peak %i overrun %i" EOL, hal.CAN_ring.overflow_N,
+			hal.CAN_ring.peak_N, hal.CAN_overrun_N);
+
+	for (N = 0; N < CAN_TX_PRIO_MAX; ++N) {
+
+		printf("tx %i drop %i peak %i depth %i" EOL, N,
+				hal.CAN_tx_ring[N].overflow_N,
+				hal.CAN_tx_ring[N].peak_N,
+				hal.CAN_tx_ring[N].depth);
+	}
 }
 
@@ -1,6 +1,7 @@
 #include <stddef.h>
 #include <stdarg.h>
 
+#include "ftoa.h"
 #include "libc.h"
 
 io_ops_t		*iodef;
@@ -77,10 +78,10 @@ void *memcpy(void *d, const void *s, int n)
 
 int strcmp(const char *s, const char *p)
 {
-	char		c;
+	int		c;
 
 	do {
-		c = *s - *p;
+		c = (int) (unsigned char) *s - (int) (unsigned char) *p;
 
 		if (c || !*s)
 			break;
@@ -235,7 +236,13 @@ const char *strchr(const char *s, int c)
 
 void xputs(io_ops_t *_io, const char *s)
 {
-	while (*s) _io->putc(*s++);
+	if (_io->write != NULL) {
+
+		_io->write(s, strlen(s));
+	}
+	else {
+		while (*s) _io->putc(*s++);
+	}
 }
 
 static void
@@ -289,148 +296,19 @@ fmt_int(io_ops_t *_io, int x)
 static void
 fmt_float(io_ops_t *_io, float x, int n)
 {
-	union {
-		float		f;
-		unsigned long	i;
-	}
-	u = { x };
-
-	int		i;
-	float		h;
-
-	if (x < 0.f) {
-
-		_io->putc('-');
-		x = - x;
-	}
-
-	if ((0xFFUL & (u.i >> 23)) == 0xFFUL) {
-
-		if ((u.i & 0x7FFFFFUL) != 0)
-
-			xputs(_io, "NaN");
-		else
-			xputs(_io, "Inf");
-
-		return ;
-	}
-
-	h = .5f;
-	for (i = 0; i < n; ++i)
-		h /= 10.f;
-
-	x += h;
-
-	if (x < (float) (1UL << 31)) {
+	char		s[FTOA_STRING_MAX];
 
-		i = (int) x;
-		fmt_int(_io, i);
-		x -= i;
-	}
-	else {
-		xputs(_io, "MAX");
-
-		return ;
-	}
-
-	if (x < 1.f) {
-
-		_io->putc('.');
-
-		while (n > 0) {
-
-			x *= 10.f;
-			i = (int) x;
-			x -= i;
-
-			_io->putc('0' + i);
-			n--;
-		}
-	}
+	ftoa_fixed(s, x, n);
+	xputs(_io, s);
 }
 
 static void
 fmt_fexp(io_ops_t *_io, float x, int n)
 {
-	union {
-		float		f;
-		unsigned long	i;
-	}
-	u = { x };
-
-	int		i, e;
-	float		h;
-
-	if (x < 0) {
-
-		_io->putc('-');
-		x = - x;
-	}
-
-	if ((0xFFUL & (u.i >> 23)) == 0xFFUL) {
+	char		s[FTOA_STRING_MAX];
 
-		if ((u.i & 0x7FFFFFUL) != 0)
-
-			xputs(_io, "NaN");
-		else
-			xputs(_io, "Inf");
-
-		return ;
-	}
-	else {
-		e = 0;
-
-		do {
-			if (x > 0.f && x < 1.f) {
-
-				x *= 10.f;
-				e--;
-			}
-			else if (x >= 10.f) {
-
-				x /= 10.f;
-				e++;
-			}
-			else
-				break;
-		}
-		while (1);
-	}
-
-	h = .5f;
-	for (i = 0; i < n; ++i)
-		h /= 10.f;
-
-	x += h;
-
-	if (x >= 10.f) {
-
-		x /= 10.f;
-		e++;
-	}
-
-	i = (int) x;
-	x -= i;
-
-	_io->putc('0' + i);
-	_io->putc('.');
-
-	while (n > 0) {
-
-		x *= 10.f;
-		i = (int) x;
-		x -= i;
-
-		_io->putc('0' + i);
-		n--;
-	}
-
-	_io->putc('E');
-
-	if (e >= 0)
-		_io->putc('+');
-
-	fmt_int(_io, e);
+	ftoa_fexp(s, x, n);
+	xputs(_io, s);
 }
 
 void xvprintf(io_ops_t *_io, const char *fmt, va_list ap)
@@ -628,28 +506,3 @@ const char *stof(float *x, const char *s)
 	return s;
 }
 
-unsigned long crc32b(const void *s, int n)
-{
-        const char              *xs = (const char *) s;
-        unsigned long           crc, b, m;
-        int                     j;
-
-	crc = 0xFFFFFFFF;
-
-	while (n >= 1) {
-
-		b = *xs++;
-		n--;
-
-		crc = crc ^ b;
-
-		for (j = 7; j >= 0; j--) {
-
-			m = -(crc & 1);
-			crc = (crc >> 1) ^ (0xEDB88320UL & m);
-		}
-	}
-
-	return ~crc;
-}
-
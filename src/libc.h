@@ -7,6 +7,7 @@ typedef struct {
 
 	int		(* getc) ();
 	void		(* putc) (int c);
+	void		(* write) (const void *s, int n);
 }
 io_ops_t;
 
@@ -35,7 +36,5 @@ void printf(const char *fmt, ...);
 const char *stoi(int *x, const char *s);
 const char *stof(float *x, const char *s);
 
-unsigned long crc32b(const void *s, int n);
-
 #endif /* _H_LIBC_ */
 
@@ -8,6 +8,7 @@
 #include "shell.h"
 
 #define LOAD_COUNT_DELAY		((TickType_t) 100)
+#define RTOS_WINDOW_N			10
 
 application_t			ap;
 pmc_t 				pm	LD_CCMRAM;
@@ -53,6 +54,118 @@ void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
 	hal_system_reset();
 }
 
+/* Run time of each task is sampled at 10 Hz into two rings so we get the
+ * load over the last 1 second and over the last 10 seconds.
+ * */
+static struct {
+
+	void		*xTCB[RTOS_TASK_MAX];
+
+	unsigned long	clock;
+	unsigned long	run[RTOS_TASK_MAX];
+
+	struct {
+
+		unsigned long	clock[RTOS_WINDOW_N];
+		unsigned long	run[RTOS_WINDOW_N][RTOS_TASK_MAX];
+	}
+	win[2];
+
+	int		head[2];
+	int		tick;
+}
+rtos_stat;
+
+static void
+rtos_stat_window(int W)
+{
+	unsigned long	dT;
+	float		load;
+	int		J, N;
+
+	/* Oldest sample is replaced by the new one so the load is taken
+	 * over the whole window.
+	 * */
+	J = rtos_stat.head[W];
+	dT = rtos_stat.clock - rtos_stat.win[W].clock[J];
+
+	for (N = 0; N < RTOS_TASK_MAX; ++N) {
+
+		if (rtos_stat.xTCB[N] == NULL)
+			continue;
+
+		load = (dT != 0) ? 100.f * (float) (rtos_stat.run[N]
+			- rtos_stat.win[W].run[J][N]) / (float) dT : 0.f;
+
+		if (W == 0) {
+
+			ap.task[N].load_1s = load;
+		}
+		else {
+			ap.task[N].load_10s = load;
+		}
+
+		rtos_stat.win[W].run[J][N] = rtos_stat.run[N];
+	}
+
+	rtos_stat.win[W].clock[J] = rtos_stat.clock;
+	rtos_stat.head[W] = (J < RTOS_WINDOW_N - 1) ? J + 1 : 0;
+}
+
+static void
+rtos_stat_update()
+{
+	TaskStatus_t	xStat;
+	int		W, J, N, stack;
+
+	/* Long window takes every tenth sample.
+	 * */
+	stack = (rtos_stat.tick == 0) ? pdTRUE : pdFALSE;
+
+	vTaskSuspendAll();
+
+	rtos_stat.clock = prof_clock();
+
+	for (N = 0; N < RTOS_TASK_MAX; ++N) {
+
+		if (ap.task[N].xTCB == NULL) {
+
+			rtos_stat.xTCB[N] = NULL;
+			continue;
+		}
+
+		vTaskGetInfo((TaskHandle_t) ap.task[N].xTCB, &xStat, stack, eRunning);
+
+		rtos_stat.run[N] = xStat.ulRunTimeCounter;
+
+		if (stack != pdFALSE)
+			ap.task[N].stack_free = (int) xStat.usStackHighWaterMark;
+
+		if (rtos_stat.xTCB[N] != ap.task[N].xTCB) {
+
+			rtos_stat.xTCB[N] = ap.task[N].xTCB;
+
+			/* Slot is taken by the new task so we forget the
+			 * previous run time.
+			 * */
+			for (W = 0; W < 2; ++W) {
+
+				for (J = 0; J < RTOS_WINDOW_N; ++J)
+					rtos_stat.win[W].run[J][N] = rtos_stat.run[N];
+			}
+		}
+	}
+
+	xTaskResumeAll();
+
+	rtos_stat_window(0);
+
+	if (rtos_stat.tick == 0)
+		rtos_stat_window(1);
+
+	rtos_stat.tick = (rtos_stat.tick < RTOS_WINDOW_N - 1) ? rtos_stat.tick + 1 : 0;
+}
+
 void task_TERM(void *pData)
 {
 	TickType_t		xWake;
@@ -71,6 +184,8 @@ void task_TERM(void *pData)
 		 * */
 		vTaskDelayUntil(&xWake, (TickType_t) 100);
 
+		rtos_stat_update();
+
 		ap.temp_PCB = ntc_temperature(&ap.ntc_PCB, ADC_get_VALUE(GPIO_ADC_PCB_NTC));
 		ap.temp_EXT = ntc_temperature(&ap.ntc_EXT, ADC_get_VALUE(GPIO_ADC_EXT_NTC));
 		ap.temp_INT = ADC_get_VALUE(GPIO_ADC_INTERNAL_TEMP);
@@ -314,6 +429,41 @@ void task_ANALOG(void *pData)
 	while (1);
 }
 
+static void
+prof_pm_mark(int stage)
+{
+	prof_t			*pf;
+	unsigned long		clock;
+
+	clock = prof_clock();
+
+	switch (stage) {
+
+		case PM_MARK_INPUT:
+			pf = &ap.prof.pm_input;
+			break;
+
+		case PM_MARK_FSM:
+			pf = &ap.prof.pm_FSM;
+			break;
+
+		case PM_MARK_OBSERVER:
+			pf = &ap.prof.pm_observer;
+			break;
+
+		case PM_MARK_LOOP:
+		default:
+			pf = &ap.prof.pm_loop;
+			break;
+	}
+
+	/* Stage takes the time since the previous mark.
+	 * */
+	prof_add(pf, clock - ap.prof.stamp);
+
+	ap.prof.stamp = clock;
+}
+
 void task_INIT(void *pData)
 {
 	int			rc_flash;
@@ -338,6 +488,7 @@ void task_INIT(void *pData)
 
 	ap.io_USART.getc = &USART_getc;
 	ap.io_USART.putc = &USART_putc;
+	ap.io_USART.write = &USART_write;
 	iodef = &ap.io_USART;
 
 	if (log_validate() != 0) {
@@ -349,7 +500,7 @@ void task_INIT(void *pData)
 
 	rc_flash = flash_block_load();
 
-	if (rc_flash < 0) {
+	if (rc_flash != 0) {
 
 		/* Resistor values in the voltage measurement circuits.
 		 * */
@@ -363,6 +514,7 @@ void task_INIT(void *pData)
 		/* Default.
 		 * */
 		hal.USART_baud_rate = 57600;
+		hal.PWM_dual = 0;
 
 #ifdef _HW_REV4B
 
@@ -403,6 +555,9 @@ void task_INIT(void *pData)
 		hal.PPM_mode = PPM_DISABLED;
 		hal.PPM_timebase = 2000000UL;
 
+		ap.can_node_ID = 0;
+		ap.can_state_rate = 100;
+
 		ap.ppm_reg_ID = ID_PM_S_SETPOINT_PC;
 		ap.ppm_pulse_range[0] = 1000.f;
 		ap.ppm_pulse_range[1] = 1500.f;
@@ -457,6 +612,14 @@ void task_INIT(void *pData)
 		ap.pull_ad[1] = 4.545E-3f;
 	}
 
+	if (rc_flash > 0) {
+
+		/* Configuration of another version is put over the defaults
+		 * by register names.
+		 * */
+		flash_block_migrate();
+	}
+
 	USART_startup();
 	ADC_startup();
 	PWM_startup();
@@ -464,10 +627,13 @@ void task_INIT(void *pData)
 	pm.freq_hz = hal.PWM_frequency;
 	pm.dT = 1.f / pm.freq_hz;
 	pm.dc_resolution = hal.PWM_resolution;
+	pm.vsf_K = 1.f;
 	pm.proc_set_DC = &PWM_set_DC;
 	pm.proc_set_Z = &PWM_set_Z;
+	pm.proc_set_FREQ = &PWM_set_FREQ;
+	pm.proc_mark = &prof_pm_mark;
 
-	if (rc_flash < 0) {
+	if (rc_flash != 0) {
 
 		/* Default.
 		 * */
@@ -483,17 +649,33 @@ void task_INIT(void *pData)
 
 	}
 
+	if (rc_flash > 0) {
+
+		/* Once again as PM defaults are set after PWM startup.
+		 * */
+		flash_block_migrate();
+	}
+
 	if (hal.PPM_mode != PPM_DISABLED) {
 
 		PPM_startup();
 	}
 
+	ifcan_startup();
+
 	WD_startup();
 
 	ADC_irq_unlock();
 	GPIO_set_LOW(GPIO_LED);
 
-	pm.fsm_req = PM_STATE_ZERO_DRIFT;
+	if (rc_flash < 0 || pm.config_DRIFT != PM_ENABLED) {
+
+		/* Offsets restored from flash are kept up to date by the
+		 * online drift tracker so we do not need ZERO_DRIFT here.
+		 * Tracker requests ZERO_DRIFT itself if they are far off.
+		 * */
+		pm.fsm_req = PM_STATE_ZERO_DRIFT;
+	}
 
 	xTaskCreate(task_TERM, "TERM", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
 	xTaskCreate(task_ERROR, "ERROR", configMINIMAL_STACK_SIZE, NULL, 1, NULL);
@@ -591,11 +773,22 @@ input_CONTROL_QEP()
 void ADC_IRQ()
 {
 	pmfb_t		fb;
+	unsigned long	clock, tel;
+
+	clock = prof_clock();
 
 	fb.current_A = hal.ADC_current_A;
 	fb.current_B = hal.ADC_current_B;
 	fb.voltage_U = hal.ADC_voltage_U;
 
+	if (hal.PWM_dual != 0 && PWM_get_VALLEY() != 0) {
+
+		/* Only the current loop runs at the valley.
+		 * */
+		pm_feedback_valley(&pm, &fb);
+		return ;
+	}
+
 	fb.voltage_A = hal.ADC_voltage_A;
 	fb.voltage_B = hal.ADC_voltage_B;
 	fb.voltage_C = hal.ADC_voltage_C;
@@ -622,10 +815,24 @@ void ADC_IRQ()
 		input_CONTROL_QEP();
 	}
 
+	ap.prof.stamp = prof_clock();
+
 	pm_feedback(&pm, &fb);
+
+	reg_mark_state();
+
+	tel = prof_clock();
+
 	tel_reg_grab(&ti);
 
+	prof_add(&ap.prof.tel_grab, prof_clock() - tel);
+
 	WD_kick();
+
+	/* Only the full period is profiled, the valley is too short to
+	 * limit the PWM frequency.
+	 * */
+	prof_add(&ap.prof.ADC_IRQ, prof_clock() - clock);
 }
 
 void app_MAIN()
@@ -682,61 +889,281 @@ SH_DEF(rtos_cpu_usage)
 	printf("%1f (%%)" EOL, &pc);
 }
 
+void rtos_trace_create(void *xTCB)
+{
+	rtos_task_t	*task;
+	int		N;
+
+	for (N = 0; N < RTOS_TASK_MAX; ++N) {
+
+		if (ap.task[N].xTCB == NULL)
+			break;
+	}
+
+	/* Task number is used to find the statistics slot, zero means the
+	 * task is not tracked.
+	 * */
+	if (N < RTOS_TASK_MAX) {
+
+		task = &ap.task[N];
+
+		task->name = pcTaskGetName((TaskHandle_t) xTCB);
+		task->xTCB = xTCB;
+
+		prof_reset(&task->prof);
+
+		task->switch_N = 0;
+		task->stack_free = 0;
+		task->load_1s = 0.f;
+		task->load_10s = 0.f;
+
+		/* Let the sampler know the slot is reused.
+		 * */
+		rtos_stat.xTCB[N] = NULL;
+
+		vTaskSetTaskNumber((TaskHandle_t) xTCB, (UBaseType_t) (N + 1));
+	}
+	else {
+		vTaskSetTaskNumber((TaskHandle_t) xTCB, (UBaseType_t) 0);
+	}
+}
+
+void rtos_trace_delete(void *xTCB)
+{
+	int		N;
+
+	N = (int) uxTaskGetTaskNumber((TaskHandle_t) xTCB);
+
+	if (N >= 1 && N <= RTOS_TASK_MAX) {
+
+		ap.task[N - 1].name = NULL;
+		ap.task[N - 1].xTCB = NULL;
+
+		vTaskSetTaskNumber((TaskHandle_t) xTCB, (UBaseType_t) 0);
+	}
+}
+
+void rtos_trace_switched_in()
+{
+	ap.task_stamp = prof_clock();
+}
+
+void rtos_trace_switched_out(void *xTCB)
+{
+	rtos_task_t	*task;
+	int		N;
+
+	N = (int) uxTaskGetTaskNumber((TaskHandle_t) xTCB);
+
+	if (N >= 1 && N <= RTOS_TASK_MAX) {
+
+		task = &ap.task[N - 1];
+
+		/* Time slice also includes the interrupts taken while the
+		 * task was running.
+		 * */
+		prof_add(&task->prof, prof_clock() - ap.task_stamp);
+
+		task->switch_N++;
+	}
+}
+
+static const struct {
+
+	const char	*name;
+	prof_t		*pf;
+}
+prof_list[] = {
+
+	{ "ADC_IRQ",		&ap.prof.ADC_IRQ },
+	{ "pm_input",		&ap.prof.pm_input },
+	{ "pm_FSM",		&ap.prof.pm_FSM },
+	{ "pm_observer",	&ap.prof.pm_observer },
+	{ "pm_loop",		&ap.prof.pm_loop },
+	{ "tel_grab",		&ap.prof.tel_grab },
+};
+
+static float
+prof_us(unsigned long ticks)
+{
+	return (float) ticks * (1000000.f / (float) clock_cpu_hz);
+}
+
+static void
+prof_print(const char *name, const prof_t *pf)
+{
+	float		min, mean, max;
+
+	min = prof_us(pf->min);
+	mean = prof_us(prof_mean(pf));
+	max = prof_us(pf->max);
+
+	printf("%s %i %2f %2f %2f" EOL, name, pf->N, &min, &mean, &max);
+}
+
+static const prof_t *
+prof_search(const char *name)
+{
+	int		N;
+
+	for (N = 0; N < sizeof(prof_list) / sizeof(prof_list[0]); ++N) {
+
+		if (strcmp(prof_list[N].name, name) == 0)
+			return prof_list[N].pf;
+	}
+
+	for (N = 0; N < RTOS_TASK_MAX; ++N) {
+
+		if (		ap.task[N].name != NULL
+				&& strcmp(ap.task[N].name, name) == 0)
+			return &ap.task[N].prof;
+	}
+
+	return NULL;
+}
+
+SH_DEF(rtos_prof)
+{
+	float		period, mean, max;
+	int		N;
+
+	printf("Name N Min Mean Max (us)" EOL);
+
+	for (N = 0; N < sizeof(prof_list) / sizeof(prof_list[0]); ++N)
+		prof_print(prof_list[N].name, prof_list[N].pf);
+
+	for (N = 0; N < RTOS_TASK_MAX; ++N) {
+
+		if (ap.task[N].name != NULL)
+			prof_print(ap.task[N].name, &ap.task[N].prof);
+	}
+
+	/* Headroom of the control interrupt within the PWM period.
+	 * */
+	period = 1000000.f / pm.freq_hz;
+	mean = 100.f * prof_us(prof_mean(&ap.prof.ADC_IRQ)) / period;
+	max = 100.f * prof_us(ap.prof.ADC_IRQ.max) / period;
+
+	printf("ADC_IRQ load %1f peak %1f (%%)" EOL, &mean, &max);
+}
+
+SH_DEF(rtos_prof_hist)
+{
+	const prof_t	*pf;
+	float		bound;
+	int		N;
+
+	pf = prof_search(s);
+
+	if (pf == NULL) {
+
+		printf("No such profile" EOL);
+		return ;
+	}
+
+	for (N = 0; N < PROF_HIST_MAX; ++N) {
+
+		if (pf->hist[N] == 0)
+			continue;
+
+		bound = prof_us(prof_hist_bound(N));
+
+		if (N < PROF_HIST_MAX - 1) {
+
+			printf("< %2f (us) %i" EOL, &bound, pf->hist[N]);
+		}
+		else {
+			bound *= .5f;
+
+			printf(">= %2f (us) %i" EOL, &bound, pf->hist[N]);
+		}
+	}
+}
+
+SH_DEF(rtos_prof_reset)
+{
+	int		N;
+
+	taskENTER_CRITICAL();
+	ADC_irq_lock();
+
+	for (N = 0; N < sizeof(prof_list) / sizeof(prof_list[0]); ++N)
+		prof_reset(prof_list[N].pf);
+
+	for (N = 0; N < RTOS_TASK_MAX; ++N)
+		prof_reset(&ap.task[N].prof);
+
+	ADC_irq_unlock();
+	taskEXIT_CRITICAL();
+}
+
 SH_DEF(rtos_list)
 {
-	TaskStatus_t		*pLIST;
-	int			xSIZE, xState, N;
+	TaskStatus_t		xStat;
+	rtos_task_t		xTask;
+	char			xName[configMAX_TASK_NAME_LEN];
+	int			xState, N;
 
-	xSIZE = uxTaskGetNumberOfTasks();
-	pLIST = pvPortMalloc(xSIZE * sizeof(TaskStatus_t));
+	printf("TCB ID Name Stat Prio Stack Free Load1s Load10s Switch" EOL);
 
-	if (pLIST != NULL) {
+	for (N = 0; N < RTOS_TASK_MAX; ++N) {
 
-		xSIZE = uxTaskGetSystemState(pLIST, xSIZE, NULL);
+		vTaskSuspendAll();
 
-		printf("TCB ID Name Stat Prio Stack Free" EOL);
+		/* Take a copy of the slot as the task may be deleted as
+		 * soon as the scheduler resumes.
+		 * */
+		xTask = ap.task[N];
 
-		for (N = 0; N < xSIZE; ++N) {
+		if (xTask.xTCB != NULL) {
 
-			switch (pLIST[N].eCurrentState) {
+			vTaskGetInfo((TaskHandle_t) xTask.xTCB, &xStat, pdTRUE, eInvalid);
+			strcpyn(xName, xStat.pcTaskName, sizeof(xName) - 1);
+		}
 
-				case eRunning:
-					xState = 'R';
-					break;
+		xTaskResumeAll();
 
-				case eReady:
-					xState = 'E';
-					break;
+		if (xTask.xTCB == NULL)
+			continue;
 
-				case eBlocked:
-					xState = 'B';
-					break;
+		switch (xStat.eCurrentState) {
 
-				case eSuspended:
-					xState = 'S';
-					break;
+			case eRunning:
+				xState = 'R';
+				break;
 
-				case eDeleted:
-					xState = 'D';
-					break;
+			case eReady:
+				xState = 'E';
+				break;
 
-				case eInvalid:
-				default:
-					xState = 'N';
-					break;
-			}
+			case eBlocked:
+				xState = 'B';
+				break;
+
+			case eSuspended:
+				xState = 'S';
+				break;
+
+			case eDeleted:
+				xState = 'D';
+				break;
 
-			printf("%8x %i %s %c %i %8x %i" EOL,
-					(unsigned long) pLIST[N].xHandle,
-					(int) pLIST[N].xTaskNumber,
-					(const char *) pLIST[N].pcTaskName,
-					(int) xState,
-					(int) pLIST[N].uxCurrentPriority,
-					(unsigned long) pLIST[N].pxStackBase,
-					(int) pLIST[N].usStackHighWaterMark);
+			case eInvalid:
+			default:
+				xState = 'N';
+				break;
 		}
 
-		vPortFree(pLIST);
+		printf("%8x %i %s %c %i %8x %i %1f %1f %i" EOL,
+				(unsigned long) xStat.xHandle,
+				(int) xStat.xTaskNumber,
+				(const char *) xName,
+				(int) xState,
+				(int) xStat.uxCurrentPriority,
+				(unsigned long) xStat.pxStackBase,
+				(int) xStat.usStackHighWaterMark,
+				&xTask.load_1s, &xTask.load_10s,
+				xTask.switch_N);
 	}
 }
 
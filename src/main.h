@@ -6,8 +6,25 @@
 
 #include "libc.h"
 #include "ntc.h"
+#include "prof.h"
 #include "tel.h"
 
+#define RTOS_TASK_MAX			12
+
+typedef struct {
+
+	const char		*name;
+	void			*xTCB;
+
+	prof_t			prof;
+
+	int			switch_N;
+	int			stack_free;
+	float			load_1s;
+	float			load_10s;
+}
+rtos_task_t;
+
 typedef struct {
 
 	/* Serial IO interfaces.
@@ -18,6 +35,7 @@ typedef struct {
 	/* CAN interface.
 	 * */
 	int			can_node_ID;
+	int			can_state_rate;
 
 	/* PPM interface.
 	 * */
@@ -49,6 +67,26 @@ typedef struct {
 	int			lc_tick;
 	int			lc_idle;
 
+	/* Execution time profile.
+	 * */
+	struct {
+
+		prof_t			ADC_IRQ;
+		prof_t			pm_input;
+		prof_t			pm_FSM;
+		prof_t			pm_observer;
+		prof_t			pm_loop;
+		prof_t			tel_grab;
+
+		unsigned long		stamp;
+	}
+	prof;
+
+	/* Task statistics.
+	 * */
+	rtos_task_t		task[RTOS_TASK_MAX];
+	unsigned long		task_stamp;
+
 	/* NTC constants.
 	 * */
 	ntc_t			ntc_PCB;
@@ -81,8 +119,11 @@ extern pmc_t			pm;
 extern tel_t			ti;
 
 extern int flash_block_load();
+extern int flash_block_migrate();
 extern int pm_wait_for_IDLE();
 
+void ifcan_startup();
+
 float ADC_get_ANALOG();
 float ADC_get_BRAKE();
 
@@ -1,17 +1,25 @@
+#include <stddef.h>
+
 #include "libm.h"
 #include "pm.h"
 
 void pm_default(pmc_t *pm)
 {
+	int		N;
+
 	pm->dc_minimal = 21;
 	pm->dc_clearance = 420;
 	pm->dc_tm_hold = 240;
 
 	pm->config_NOP = PM_NOP_THREE_PHASE;
 	pm->config_TVM = PM_ENABLED;
+	pm->config_DRIFT = PM_ENABLED;
+	pm->config_VSF = PM_DISABLED;
 	pm->config_HFI = PM_DISABLED;
+	pm->config_EKF = PM_DISABLED;
 	pm->config_SENSOR = PM_SENSOR_DISABLED;
 	pm->config_WEAK = PM_DISABLED;
+	pm->config_COGG = PM_COGG_DISABLED;
 	pm->config_DRIVE = PM_DRIVE_SPEED;
 	pm->config_SERVO = PM_DISABLED;
 	pm->config_STAT	= PM_ENABLED;
@@ -38,6 +46,14 @@ void pm_default(pmc_t *pm)
 	pm->ad_UC[0] = 0.f;
 	pm->ad_UC[1] = 1.f;
 
+	pm->drift_slew = .1f;
+	pm->drift_gain_LP = 2E-4f;
+
+	pm->vsf_freq_low = pm->freq_hz / 2.f;
+	pm->vsf_K = 1.f;
+	pm->vsf_rev_N = 40.f;
+	pm->vsf_load_i = 40.f;
+
 	pm->probe_current_hold = 10.f;
 	pm->probe_current_bias_Q = 0.f;
 	pm->probe_current_sine = 2.f;
@@ -83,6 +99,11 @@ void pm_default(pmc_t *pm)
 	pm->flux_gain_LP_E = 2E-5f;
 	pm->flux_gain_SF = 5E-2f;
 
+	pm->ekf_gain_QI = 1E-3f;
+	pm->ekf_gain_QS = 1E+0f;
+	pm->ekf_gain_QF = 1E-6f;
+	pm->ekf_gain_R = 5E-2f;
+
 	pm->inject_bias_U = 1.f;
 	pm->inject_ratio_D = .5f;
 
@@ -118,6 +139,12 @@ void pm_default(pmc_t *pm)
 	pm->weak_bias_U = 2.f;
 	pm->weak_gain_EU = 7E-3f;
 
+	for (N = 0; N < PM_COGG_MAX; N++)
+		pm->cogg_T[N] = 0.f;
+
+	pm->cogg_gain_LP = 1E-3f;
+	pm->cogg_gain_LE = 1E-1f;
+
 	pm->v_maximal = PM_UMAX(pm) * 60.f;
 	pm->v_reverse = - pm->v_maximal;
 
@@ -133,6 +160,30 @@ void pm_default(pmc_t *pm)
 	pm->x_gain_N = 50.f;
 }
 
+static float
+pm_vsf_gain(const pmc_t *pm, float G)
+{
+	/* Gains are kept at the base switching frequency. We scale the
+	 * per-sample gain by the sampling period ratio where it is used.
+	 * */
+	return G * pm->vsf_K;
+}
+
+static float
+pm_vsf_gain_LP(const pmc_t *pm, float G)
+{
+	float		K = pm->vsf_K, LP;
+
+	/* Keep the time constant of the first-order filter. We use the
+	 * second-order approximation of 1 - (1 - G) ^ K that is exact for
+	 * twice lowered frequency.
+	 * */
+	LP = G * K * (1.f - (K - 1.f) * G * .5f);
+	LP = (LP < G) ? G : (LP > 1.f) ? 1.f : LP;
+
+	return LP;
+}
+
 static void
 pm_forced(pmc_t *pm)
 {
@@ -174,7 +225,7 @@ pm_forced(pmc_t *pm)
 static void
 pm_estimate_FLUX(pmc_t *pm)
 {
-	float		EX, EY, UX, UY, LX, LY, IE, IQ, DX, DY, E, F;
+	float		EX, EY, UX, UY, LX, LY, IE, IQ, DX, DY, E, F, G;
 	int		N, H;
 
 	/* Get the actual voltage.
@@ -218,7 +269,8 @@ pm_estimate_FLUX(pmc_t *pm)
 
 		/* Adaptive observer GAIN.
 		 * */
-		F = (pm->flux_gain_LO + E * pm->flux_gain_HI) * IE;
+		F = pm_vsf_gain(pm, pm->flux_gain_LO + E * pm->flux_gain_HI) * IE;
+		G = pm_vsf_gain_LP(pm, pm->flux_gain_LP_E);
 
 		for (N = 0, H = 0; N < pm->flux_N; N++) {
 
@@ -235,7 +287,7 @@ pm_estimate_FLUX(pmc_t *pm)
 			pm->flux[N].X += EX * E * F;
 			pm->flux[N].Y += EY * E * F;
 
-			pm->flux[N].lpf_E += (E * E - pm->flux[N].lpf_E) * pm->flux_gain_LP_E;
+			pm->flux[N].lpf_E += (E * E - pm->flux[N].lpf_E) * G;
 			H = (pm->flux[N].lpf_E < pm->flux[H].lpf_E) ? N : H;
 
 			UX += DX;
@@ -255,7 +307,7 @@ pm_estimate_FLUX(pmc_t *pm)
 		if (DX > (M_EPS_F * M_EPS_F)) {
 
 			E = DY / DX * pm->freq_hz;
-			pm->flux_wS += - E * pm->flux_gain_SF;
+			pm->flux_wS += - E * pm_vsf_gain_LP(pm, pm->flux_gain_SF);
 		}
 	}
 	else {
@@ -269,8 +321,10 @@ pm_estimate_FLUX(pmc_t *pm)
 		EX = pm->flux[H].X - LX;
 		EY = pm->flux[H].Y - LY;
 
-		pm->flux[H].X += - EX * pm->flux_gain_IN;
-		pm->flux[H].Y += - EY * pm->flux_gain_IN;
+		G = pm_vsf_gain(pm, pm->flux_gain_IN);
+
+		pm->flux[H].X += - EX * G;
+		pm->flux[H].Y += - EY * G;
 
 		pm->flux_wS = pm->forced_wS;
 	}
@@ -291,9 +345,155 @@ pm_estimate_FLUX(pmc_t *pm)
 		pm->flux_F[1] = EY / E;
 	}
 
+	if (pm->lu_mode != PM_LU_ESTIMATE_EKF) {
+
+		/* Under EKF the speed filter is fed by EKF estimate.
+		 * */
+		pm->lu_lpf_wS += (pm->flux_wS - pm->lu_lpf_wS)
+			* pm_vsf_gain_LP(pm, pm->lu_gain_LP_S);
+	}
+}
+
+static void
+pm_estimate_EKF(pmc_t *pm)
+{
+	float		*P = pm->ekf_P;
+	float		UX, UY, iX, iY, dTL, wS, EF, a, b0, b1, c0, c1;
+	float		M00, M02, M03, M10, M11, M12, M13, M32, M33;
+	float		S00, S01, S11, D, K[8], eX, eY, dF, QI;
+
+	/* Get the actual voltage.
+	 * */
+	UX = pm->vsi_X;
+	UY = pm->vsi_Y;
+
+	if (PM_CONFIG_TVM(pm) == PM_ENABLED) {
+
+		UX += pm->tvm_DX - pm->vsi_DX;
+		UY += pm->tvm_DY - pm->vsi_DY;
+	}
+
+	/* With Q axis inductance the model is written for active flux that
+	 * is aligned to D axis regardless of saliency.
+	 * */
+	dTL = (pm->const_im_LQ > M_EPS_F) ? pm->const_im_LQ : pm->const_L;
+	dTL = pm->dT / dTL;
+	wS = pm->ekf_wS;
+	EF = pm->const_E * dTL;
+
+	/* BEMF is taken at the middle of the sampling period, otherwise the
+	 * position estimate lags by half of the angle increment per period.
+	 * */
+	m_rotf(pm->ekf_F, wS * pm->dT * .5f, pm->ekf_F);
+
+	/* Jacobian of the state transition. The state vector is (iX, iY,
+	 * wS, F) where F is an angle increment over the estimated position.
+	 * */
+	a = 1.f - pm->const_R * dTL;
+	b0 = EF * pm->ekf_F[1];
+	b1 = - EF * pm->ekf_F[0];
+	c0 = EF * wS * pm->ekf_F[0];
+	c1 = EF * wS * pm->ekf_F[1];
+
+	/* Predict the state.
+	 * */
+	iX = pm->ekf_iX + (UX - pm->const_R * pm->ekf_iX) * dTL + b0 * wS;
+	iY = pm->ekf_iY + (UY - pm->const_R * pm->ekf_iY) * dTL + b1 * wS;
+
+	m_rotf(pm->ekf_F, wS * pm->dT * .5f, pm->ekf_F);
+
+	/* Predict the covariance P = A * P * A' + Q. The lower triangle of
+	 * symmetric P is packed into 10 elements by rows.
+	 * */
+	M00 = a * P[0] + b0 * P[3] + c0 * P[6];
+	M02 = a * P[3] + b0 * P[5] + c0 * P[8];
+	M03 = a * P[6] + b0 * P[8] + c0 * P[9];
+	M10 = a * P[1] + b1 * P[3] + c1 * P[6];
+	M11 = a * P[2] + b1 * P[4] + c1 * P[7];
+	M12 = a * P[4] + b1 * P[5] + c1 * P[8];
+	M13 = a * P[7] + b1 * P[8] + c1 * P[9];
+	M32 = P[8] + pm->dT * P[5];
+	M33 = P[9] + pm->dT * P[8];
+
+	QI = pm_vsf_gain(pm, pm->ekf_gain_QI);
+
+	P[0] = a * M00 + b0 * M02 + c0 * M03 + QI;
+	P[1] = a * M10 + b0 * M12 + c0 * M13;
+	P[2] = a * M11 + b1 * M12 + c1 * M13 + QI;
+	P[3] = M02;
+	P[4] = M12;
+	P[5] = P[5] + pm_vsf_gain(pm, pm->ekf_gain_QS);
+	P[6] = M03 + pm->dT * M02;
+	P[7] = M13 + pm->dT * M12;
+	P[8] = M32;
+	P[9] = M33 + pm->dT * M32 + pm_vsf_gain(pm, pm->ekf_gain_QF);
+
+	if ((pm->vsi_IF & 2) == 0) {
+
+		/* Get the Kalman gain K = P * H' * inv(H * P * H' + R).
+		 * */
+		S00 = P[0] + pm->ekf_gain_R;
+		S01 = P[1];
+		S11 = P[2] + pm->ekf_gain_R;
+
+		D = 1.f / (S00 * S11 - S01 * S01);
+
+		S00 *= D;
+		S01 *= D;
+		S11 *= D;
+
+		K[0] = P[0] * S11 - P[1] * S01;
+		K[1] = P[1] * S00 - P[0] * S01;
+		K[2] = P[1] * S11 - P[2] * S01;
+		K[3] = P[2] * S00 - P[1] * S01;
+		K[4] = P[3] * S11 - P[4] * S01;
+		K[5] = P[4] * S00 - P[3] * S01;
+		K[6] = P[6] * S11 - P[7] * S01;
+		K[7] = P[7] * S00 - P[6] * S01;
+
+		/* Update the state.
+		 * */
+		eX = pm->lu_iX - iX;
+		eY = pm->lu_iY - iY;
+
+		iX += K[0] * eX + K[1] * eY;
+		iY += K[2] * eX + K[3] * eY;
+		wS += K[4] * eX + K[5] * eY;
+		dF = K[6] * eX + K[7] * eY;
+		dF = (dF < - 1.f) ? - 1.f : (dF > 1.f) ? 1.f : dF;
+
+		m_rotf(pm->ekf_F, dF, pm->ekf_F);
+
+		/* Update the covariance P = (I - K * H) * P.
+		 * */
+		M00 = P[0];
+		M10 = P[1];
+		M11 = P[2];
+		M02 = P[3];
+		M12 = P[4];
+		M03 = P[6];
+		M13 = P[7];
+
+		P[0] += - K[0] * M00 - K[1] * M10;
+		P[1] += - K[2] * M00 - K[3] * M10;
+		P[2] += - K[2] * M10 - K[3] * M11;
+		P[3] += - K[4] * M00 - K[5] * M10;
+		P[4] += - K[4] * M10 - K[5] * M11;
+		P[5] += - K[4] * M02 - K[5] * M12;
+		P[6] += - K[6] * M00 - K[7] * M10;
+		P[7] += - K[6] * M10 - K[7] * M11;
+		P[8] += - K[6] * M02 - K[7] * M12;
+		P[9] += - K[6] * M03 - K[7] * M13;
+	}
+
+	pm->ekf_iX = iX;
+	pm->ekf_iY = iY;
+	pm->ekf_wS = wS;
+
 	/*
 	 * */
-	pm->lu_lpf_wS += (pm->flux_wS - pm->lu_lpf_wS) * pm->lu_gain_LP_S;
+	pm->lu_lpf_wS += (pm->ekf_wS - pm->lu_lpf_wS)
+		* pm_vsf_gain_LP(pm, pm->lu_gain_LP_S);
 }
 
 static void
@@ -422,6 +622,8 @@ pm_instant_BEMF(pmc_t *pm)
 static void
 pm_lu_FSM(pmc_t *pm)
 {
+	int		N;
+
 	if (pm->lu_mode == PM_LU_DETACHED) {
 
 		pm->lu_iX = 0.f;
@@ -493,6 +695,48 @@ pm_lu_FSM(pmc_t *pm)
 				pm->forced_wS = pm->flux_wS;
 			}
 		}
+		else if (pm->config_EKF == PM_ENABLED) {
+
+			if (m_fabsf(pm->lu_lpf_wS * pm->const_E) > pm->lu_lock_S) {
+
+				pm->lu_mode = PM_LU_ESTIMATE_EKF;
+
+				pm->ekf_iX = pm->lu_iX;
+				pm->ekf_iY = pm->lu_iY;
+				pm->ekf_F[0] = pm->flux_F[0];
+				pm->ekf_F[1] = pm->flux_F[1];
+				pm->ekf_wS = pm->flux_wS;
+
+				for (N = 0; N < 10; N++)
+					pm->ekf_P[N] = 0.f;
+
+				pm->ekf_P[0] = pm->ekf_gain_R;
+				pm->ekf_P[2] = pm->ekf_gain_R;
+				pm->ekf_P[5] = pm_vsf_gain(pm, pm->ekf_gain_QS) * pm->freq_hz;
+				pm->ekf_P[9] = pm_vsf_gain(pm, pm->ekf_gain_QF) * pm->freq_hz;
+			}
+		}
+	}
+	else if (pm->lu_mode == PM_LU_ESTIMATE_EKF) {
+
+		/* FLUX observer runs in background so its estimate is
+		 * valid for the handover and other consumers.
+		 * */
+		pm_estimate_FLUX(pm);
+		pm_estimate_EKF(pm);
+
+		pm->lu_F[0] = pm->ekf_F[0];
+		pm->lu_F[1] = pm->ekf_F[1];
+		pm->lu_wS = pm->ekf_wS;
+
+		if (		m_fabsf(pm->lu_lpf_wS * pm->const_E) < pm->lu_unlock_S
+				|| pm->config_EKF != PM_ENABLED) {
+
+			/* Hand over to the FLUX observer that will choose the
+			 * low speed estimate.
+			 * */
+			pm->lu_mode = PM_LU_ESTIMATE_FLUX;
+		}
 	}
 	else if (pm->lu_mode == PM_LU_ESTIMATE_HFI) {
 
@@ -538,7 +782,7 @@ void pm_voltage(pmc_t *pm, float uX, float uY)
 	float		uA, uB, uC;
 	float		uMIN, uMAX, uQ;
 	int		xA, xB, xC;
-	int		xMIN, xMAX;
+	int		xMIN, xMAX, xHOLD;
 
 	uX /= pm->const_lpf_U;
 	uY /= pm->const_lpf_U;
@@ -632,15 +876,19 @@ void pm_voltage(pmc_t *pm, float uX, float uY)
 		xC = (xC > xMAX) ? pm->dc_resolution : xC;
 	}
 
-	if (pm->dc_tm_hold != 0) {
+	/* Hold time is counted in PWM periods so we advance it in the peak
+	 * update only and the valley update keeps the counters as is.
+	 * */
+	if (pm->dc_tm_hold != 0 && pm->i_valley == 0) {
 
 		xMAX = pm->dc_resolution - pm->dc_clearance;
+		xHOLD = (int) (pm->dc_tm_hold / pm->vsf_K + .5f);
 
 		if (xA == pm->dc_resolution) {
 
 			pm->vsi_tm_A++;
 
-			if (pm->vsi_tm_A > pm->dc_tm_hold) {
+			if (pm->vsi_tm_A > xHOLD) {
 
 				xA = xMAX;
 				pm->vsi_tm_A = 0;
@@ -654,7 +902,7 @@ void pm_voltage(pmc_t *pm, float uX, float uY)
 
 			pm->vsi_tm_B++;
 
-			if (pm->vsi_tm_B > pm->dc_tm_hold) {
+			if (pm->vsi_tm_B > xHOLD) {
 
 				xB = xMAX;
 				pm->vsi_tm_B = 0;
@@ -668,7 +916,7 @@ void pm_voltage(pmc_t *pm, float uX, float uY)
 
 			pm->vsi_tm_C++;
 
-			if (pm->vsi_tm_C > pm->dc_tm_hold) {
+			if (pm->vsi_tm_C > xHOLD) {
 
 				xC = xMAX;
 				pm->vsi_tm_C = 0;
@@ -731,11 +979,48 @@ void pm_voltage(pmc_t *pm, float uX, float uY)
 	}
 }
 
+static void
+pm_cogging_bin(pmc_t *pm)
+{
+	float		F;
+	int		N, J;
+
+	/* Get the table position from electrical angle.
+	 * */
+	F = m_atan2f(pm->lu_F[1], pm->lu_F[0]) * (PM_COGG_MAX / (2.f * M_PI_F));
+	F += (F < 0.f) ? PM_COGG_MAX : 0.f;
+
+	N = (int) F;
+
+	if (N >= PM_COGG_MAX) {
+
+		N = 0;
+		F = 0.f;
+	}
+
+	if (N == 0 && pm->cogg_bin != 0) {
+
+		/* Keep the table zero-mean, DC current is up to the speed
+		 * loop.
+		 * */
+		F = pm->cogg_DC * (1.f / PM_COGG_MAX);
+
+		for (J = 0; J < PM_COGG_MAX; J++)
+			pm->cogg_T[J] += - F;
+
+		pm->cogg_DC = 0.f;
+	}
+
+	pm->cogg_bin = N;
+	pm->cogg_frac = F - N;
+}
+
 static void
 pm_loop_current(pmc_t *pm)
 {
 	float		sD, sQ, eD, eQ, uD, uQ, uX, uY, wP, wS;
-	float		iMAX, iREV, uMAX, wMAX, wREV, E;
+	float		iMAX, iREV, uMAX, wMAX, wREV, gI, E;
+	int		N, J;
 
 	if (pm->lu_mode == PM_LU_FORCED) {
 
@@ -766,7 +1051,7 @@ pm_loop_current(pmc_t *pm)
 
 			E = pm->vsi_EU * pm->const_lpf_U - pm->weak_bias_U;
 
-			pm->weak_D += E * pm->weak_gain_EU;
+			pm->weak_D += E * pm_vsf_gain(pm, pm->weak_gain_EU);
 			pm->weak_D = (pm->weak_D < - pm->weak_maximal) ? - pm->weak_maximal :
 				(pm->weak_D > 0.f) ? 0.f : pm->weak_D;
 
@@ -777,6 +1062,16 @@ pm_loop_current(pmc_t *pm)
 				sD = pm->weak_D;
 			}
 		}
+
+		if (pm->config_COGG != PM_COGG_DISABLED) {
+
+			N = pm->cogg_bin;
+			J = (N < PM_COGG_MAX - 1) ? N + 1 : 0;
+
+			/* Cogging torque compensation.
+			 * */
+			sQ += pm->cogg_T[N] + (pm->cogg_T[J] - pm->cogg_T[N]) * pm->cogg_frac;
+		}
 	}
 
 	/* Get VSI voltages on DQ-axes.
@@ -786,13 +1081,15 @@ pm_loop_current(pmc_t *pm)
 
 	/* LPF is necessary to ensure the stability of POWER limiting loop.
 	 * */
-	pm->watt_lpf_D += (uD - pm->watt_lpf_D) * pm->watt_gain_LP_F;
-	pm->watt_lpf_Q += (uQ - pm->watt_lpf_Q) * pm->watt_gain_LP_F;
+	E = pm_vsf_gain_LP(pm, pm->watt_gain_LP_F);
+
+	pm->watt_lpf_D += (uD - pm->watt_lpf_D) * E;
+	pm->watt_lpf_Q += (uQ - pm->watt_lpf_Q) * E;
 
 	/* Operating POWER is a scalar product of voltage and current.
 	 * */
 	wP = PM_KWAT(pm) * (pm->lu_iD * pm->watt_lpf_D + pm->lu_iQ * pm->watt_lpf_Q);
-	pm->watt_lpf_wP += (wP - pm->watt_lpf_wP) * pm->watt_gain_LP_P;
+	pm->watt_lpf_wP += (wP - pm->watt_lpf_wP) * pm_vsf_gain_LP(pm, pm->watt_gain_LP_P);
 
 	/* Maximal CURRENT constraint.
 	 * */
@@ -871,6 +1168,11 @@ pm_loop_current(pmc_t *pm)
 		}
 	}
 
+	/* Keep the constrained setpoint for the valley update.
+	 * */
+	pm->i_track_D = sD;
+	pm->i_track_Q = sQ;
+
 	/* Obtain discrepancy.
 	 * */
 	eD = sD - pm->lu_iD;
@@ -896,12 +1198,19 @@ pm_loop_current(pmc_t *pm)
 
 	uMAX = PM_UMAX(pm) * pm->const_lpf_U;
 
-	pm->i_integral_D += pm->i_gain_I * eD;
+	/* Integral gain is defined per PWM period. When the valley update
+	 * took the first half of the period we integrate only the second.
+	 * */
+	gI = pm_vsf_gain(pm, pm->i_gain_I);
+	gI = (pm->i_valley != 0) ? gI * .5f : gI;
+	pm->i_valley = 0;
+
+	pm->i_integral_D += gI * eD;
 	pm->i_integral_D = (pm->i_integral_D > uMAX) ? uMAX :
 		(pm->i_integral_D < - uMAX) ? - uMAX : pm->i_integral_D;
 	uD += pm->i_integral_D;
 
-	pm->i_integral_Q += pm->i_gain_I * eQ;
+	pm->i_integral_Q += gI * eQ;
 	pm->i_integral_Q = (pm->i_integral_Q > uMAX) ? uMAX :
 		(pm->i_integral_Q < - uMAX) ? - uMAX : pm->i_integral_Q;
 	uQ += pm->i_integral_Q;
@@ -931,7 +1240,8 @@ pm_loop_current(pmc_t *pm)
 static void
 pm_loop_speed(pmc_t *pm)
 {
-	float		iSP, wSP, eS, dS;
+	float		iSP, wSP, eS, dS, eX, eY;
+	int		N, J;
 
 	if (pm->lu_mode == PM_LU_FORCED) {
 
@@ -968,7 +1278,55 @@ pm_loop_speed(pmc_t *pm)
 		 * */
 		iSP = pm->s_gain_P * eS;
 
-		pm->s_integral += (pm->lu_iQ - pm->s_integral) * pm->s_gain_LP_I;
+		if (		pm->config_COGG == PM_COGG_LEARN
+				&& pm->lu_mode != PM_LU_ESTIMATE_HFI
+				&& pm->s_track == wSP) {
+
+			/* Uniformly rotating reference position.
+			 * */
+			m_rotf(pm->cogg_F, pm->s_track * pm->dT, pm->cogg_F);
+
+			eX = pm->cogg_F[0] * pm->lu_F[0] + pm->cogg_F[1] * pm->lu_F[1];
+			eY = pm->cogg_F[0] * pm->lu_F[1] - pm->cogg_F[1] * pm->lu_F[0];
+
+			if (eX > .5f) {
+
+				m_rotf(pm->cogg_F, eY * pm_vsf_gain_LP(pm, pm->cogg_gain_LP), pm->cogg_F);
+
+				if (pm->const_im_LQ > M_EPS_F) {
+
+					/* Remove the position error that
+					 * observer gets from saliency.
+					 * */
+					eY += - (pm->const_im_LQ - pm->const_L) / pm->const_E
+						* (pm->lu_iQ - pm->s_integral);
+				}
+
+				N = pm->cogg_bin;
+				J = (N < PM_COGG_MAX - 1) ? N + 1 : 0;
+
+				/* Learn the cogging table from position ripple
+				 * at constant speed. Position deviation is in
+				 * antiphase with cogging torque.
+				 * */
+				eY *= pm_vsf_gain(pm, pm->cogg_gain_LE);
+
+				pm->cogg_T[N] += eY * (1.f - pm->cogg_frac);
+				pm->cogg_T[J] += eY * pm->cogg_frac;
+
+				pm->cogg_DC += eY;
+			}
+			else {
+				pm->cogg_F[0] = pm->lu_F[0];
+				pm->cogg_F[1] = pm->lu_F[1];
+			}
+		}
+		else {
+			pm->cogg_F[0] = pm->lu_F[0];
+			pm->cogg_F[1] = pm->lu_F[1];
+		}
+
+		pm->s_integral += (pm->lu_iQ - pm->s_integral) * pm_vsf_gain_LP(pm, pm->s_gain_LP_I);
 		iSP += pm->s_integral;
 
 		/* Output clamp.
@@ -1117,6 +1475,166 @@ pm_statistics(pmc_t *pm)
 
 }
 
+static void
+pm_offset_drift(pmc_t *pm, const pmfb_t *fb)
+{
+	float		iA, iB, dA, dB, dMAX, G;
+
+	/* Only in IDLE the bridge is surely in Z state. In DETACHED mode
+	 * the machine BEMF can drive the current through the diodes.
+	 * */
+	if (		pm->lu_mode == PM_LU_DISABLED
+			&& pm->fsm_state == PM_STATE_IDLE) {
+
+		/* Wait until the inductive current decays.
+		 * */
+		if (pm->drift_TIM < pm->freq_hz * pm->tm_transient_slow) {
+
+			pm->drift_lpf_A = 0.f;
+			pm->drift_lpf_B = 0.f;
+
+			pm->drift_TIM++;
+		}
+		else {
+			iA = pm->ad_IA[1] * fb->current_A + pm->ad_IA[0];
+			iB = pm->ad_IB[1] * fb->current_B + pm->ad_IB[0];
+
+			if (		m_fabsf(iA) < pm->fault_current_tol
+					&& m_fabsf(iB) < pm->fault_current_tol) {
+
+				/* Bridge is in Z state so the true current is zero.
+				 * */
+				G = pm_vsf_gain_LP(pm, pm->drift_gain_LP);
+
+				pm->drift_lpf_A += (iA - pm->drift_lpf_A) * G;
+				pm->drift_lpf_B += (iB - pm->drift_lpf_B) * G;
+
+				/* Refine the offsets with bounded slew.
+				 * */
+				dMAX = pm->drift_slew * pm->dT;
+
+				dA = - pm->drift_lpf_A;
+				dA = (dA > dMAX) ? dMAX : (dA < - dMAX) ? - dMAX : dA;
+
+				dB = - pm->drift_lpf_B;
+				dB = (dB > dMAX) ? dMAX : (dB < - dMAX) ? - dMAX : dB;
+
+				pm->ad_IA[0] += dA;
+				pm->ad_IB[0] += dB;
+
+				pm->drift_lpf_A += dA;
+				pm->drift_lpf_B += dB;
+
+				pm->drift_IA += dA;
+				pm->drift_IB += dB;
+			}
+			else if (	pm->fail_reason == PM_OK
+					&& pm->fsm_req == PM_STATE_IDLE) {
+
+				/* Offsets restored from flash are far off so
+				 * we run the complete ZERO_DRIFT.
+				 * */
+				pm->fsm_req = PM_STATE_ZERO_DRIFT;
+			}
+		}
+	}
+	else {
+		pm->drift_TIM = 0;
+	}
+}
+
+static void
+pm_vsf_FIR(float FIR[3], float K)
+{
+	float		A, G;
+
+	if (FIR[0] > M_EPS_F) {
+
+		/* Assume the first-order sensor filter.
+		 * */
+		A = - FIR[1] / FIR[0];
+
+		if (A > M_EPS_F && A < 1.f) {
+
+			G = FIR[0] + FIR[1];
+			A = m_expf(m_logf(A) * K);
+
+			FIR[0] = G / (1.f - A);
+			FIR[1] = - G * A / (1.f - A);
+		}
+	}
+}
+
+static void
+pm_vsf_rescale(pmc_t *pm, int R)
+{
+	float		F, K;
+
+	/* Timer clock is fixed so the frequency is inverse to resolution.
+	 * */
+	F = pm->freq_hz * (float) pm->dc_resolution / (float) R;
+	K = pm->freq_hz / F;
+
+	pm->tm_value = (int) (pm->tm_value / K);
+	pm->tm_end = (int) (pm->tm_end / K);
+
+	pm_vsf_FIR(pm->tvm_FIR_A, K);
+	pm_vsf_FIR(pm->tvm_FIR_B, K);
+	pm_vsf_FIR(pm->tvm_FIR_C, K);
+
+	/* Configured gains are not touched, they are scaled with the ratio
+	 * to the base frequency where they are used.
+	 * */
+	pm->vsf_K = (F < pm->vsf_freq_base) ? pm->vsf_freq_base / F : 1.f;
+
+	pm->freq_hz = F;
+	pm->dT = 1.f / F;
+	pm->dc_resolution = R;
+}
+
+static void
+pm_vsf_schedule(pmc_t *pm)
+{
+	float		F, iA, tol;
+
+	if (		pm->fsm_state == PM_STATE_IDLE
+			&& (pm->lu_mode == PM_LU_ESTIMATE_FLUX
+				|| pm->lu_mode == PM_LU_ESTIMATE_EKF
+				|| pm->lu_mode == PM_LU_SENSOR_HALL
+				|| pm->lu_mode == PM_LU_SENSOR_QEP)) {
+
+		/* We need enough PWM periods per electrical revolution.
+		 * */
+		F = m_fabsf(pm->lu_wS) * pm->vsf_rev_N * (1.f / (2.f * M_PI_F));
+
+		/* Light load does not need high switching frequency.
+		 * */
+		iA = m_sqrtf(pm->lu_iD * pm->lu_iD + pm->lu_iQ * pm->lu_iQ) / pm->vsf_load_i;
+		iA = (iA > 1.f) ? 1.f : iA;
+		iA = pm->vsf_freq_low + (pm->vsf_freq_base - pm->vsf_freq_low) * iA;
+
+		F = (F < iA) ? iA : F;
+		F = (F > pm->vsf_freq_base) ? pm->vsf_freq_base : F;
+
+		/* Do not retune too often.
+		 * */
+		tol = (pm->vsf_TIM < pm->freq_hz * pm->tm_transient_slow) ? PM_INFINITY : .1f;
+		pm->vsf_TIM++;
+	}
+	else {
+		/* Go back to the base frequency in any other case.
+		 * */
+		F = pm->vsf_freq_base;
+		tol = 1E-3f;
+	}
+
+	if (m_fabsf(F - pm->freq_hz) > tol * pm->freq_hz) {
+
+		pm_vsf_rescale(pm, pm->proc_set_FREQ(F));
+		pm->vsf_TIM = 0;
+	}
+}
+
 void pm_feedback(pmc_t *pm, pmfb_t *fb)
 {
 	float		vA, vB, vC, U, Q;
@@ -1156,7 +1674,7 @@ void pm_feedback(pmc_t *pm, pmfb_t *fb)
 	/* Get DC link voltage.
 	 * */
 	U = pm->ad_US[1] * fb->voltage_U + pm->ad_US[0];
-	pm->const_lpf_U += (U - pm->const_lpf_U) * pm->const_gain_LP_U;
+	pm->const_lpf_U += (U - pm->const_lpf_U) * pm_vsf_gain_LP(pm, pm->const_gain_LP_U);
 
 	if (pm->const_lpf_U > pm->fault_voltage_halt) {
 
@@ -1231,23 +1749,57 @@ void pm_feedback(pmc_t *pm, pmfb_t *fb)
 		}
 	}
 
+	if (pm->config_DRIFT == PM_ENABLED) {
+
+		pm_offset_drift(pm, fb);
+	}
+
 	/* Get SENSOR values.
 	 * */
 	pm->fb_HS = fb->pulse_HS;
 	pm->fb_EP = fb->pulse_EP;
 
+	if (pm->proc_mark != NULL)
+		pm->proc_mark(PM_MARK_INPUT);
+
+	if (pm->lu_mode == PM_LU_DISABLED) {
+
+		/* No valley update is made without the observer.
+		 * */
+		pm->i_valley = 0;
+	}
+
 	/* Main FSM is used to execute external commands.
 	 * */
 	pm_FSM(pm);
 
+	if (pm->proc_mark != NULL)
+		pm->proc_mark(PM_MARK_FSM);
+
 	if (pm->lu_mode != PM_LU_DISABLED) {
 
 		/* The observer FSM.
 		 * */
 		pm_lu_FSM(pm);
 
+		if (pm->config_VSF == PM_ENABLED) {
+
+			/* Switching frequency can be changed here as the
+			 * observer is done with the past period.
+			 * */
+			pm_vsf_schedule(pm);
+		}
+
+		if (pm->proc_mark != NULL)
+			pm->proc_mark(PM_MARK_OBSERVER);
+
 		if (pm->lu_mode != PM_LU_DETACHED) {
 
+			if (pm->config_COGG != PM_COGG_DISABLED) {
+
+				pm_cogging_bin(pm);
+			}
+
 			if (pm->config_DRIVE == PM_DRIVE_SPEED) {
 
 				pm_loop_speed(pm);
@@ -1263,6 +1815,9 @@ void pm_feedback(pmc_t *pm, pmfb_t *fb)
 			pm_loop_current(pm);
 		}
 
+		if (pm->proc_mark != NULL)
+			pm->proc_mark(PM_MARK_LOOP);
+
 		if (pm->config_STAT == PM_ENABLED) {
 
 			pm_statistics(pm);
@@ -1282,3 +1837,110 @@ void pm_feedback(pmc_t *pm, pmfb_t *fb)
 	}
 }
 
+
+void pm_feedback_valley(pmc_t *pm, pmfb_t *fb)
+{
+	float		iA, iB, iX, iY, iD, iQ, eD, eQ, uD, uQ, uMAX, gI;
+	float		F[2], vX, vY, vDX, vDY;
+	int		IF, UF, AZ, BZ, CZ;
+
+	if (		pm->lu_mode != PM_LU_DISABLED
+			&& pm->lu_mode != PM_LU_DETACHED
+			&& pm->lu_mode != PM_LU_ESTIMATE_HFI) {
+
+		/* Get inline currents.
+		 * */
+		iA = pm->ad_IA[1] * fb->current_A + pm->ad_IA[0];
+		iB = pm->ad_IB[1] * fb->current_B + pm->ad_IB[0];
+
+		if (		m_fabsf(iA) > pm->fault_current_halt
+				|| m_fabsf(iB) > pm->fault_current_halt) {
+
+			pm->fail_reason = PM_ERROR_INLINE_OVER_CURRENT;
+			pm->fsm_req = PM_STATE_HALT;
+		}
+
+		if (PM_CONFIG_NOP(pm) == PM_NOP_THREE_PHASE) {
+
+			iX = iA;
+			iY = .57735027f * iA + 1.1547005f * iB;
+		}
+		else {
+			iX = iA;
+			iY = iB;
+		}
+
+		/* Rotor position is extrapolated to the valley as the
+		 * observer runs only once per PWM period.
+		 * */
+		m_rotf(F, pm->lu_wS * pm->dT * .5f, pm->lu_F);
+
+		iD = F[0] * iX + F[1] * iY;
+		iQ = F[0] * iY - F[1] * iX;
+
+		/* Obtain discrepancy.
+		 * */
+		eD = pm->i_track_D - iD;
+		eQ = pm->i_track_Q - iQ;
+
+		uD = pm->i_gain_P * eD;
+		uQ = pm->i_gain_P * eQ;
+
+		/* Feed forward compensation.
+		 * */
+		uD += - pm->lu_wS * pm->const_L * pm->i_track_Q;
+		uQ += pm->lu_wS * pm->const_L * pm->i_track_D;
+
+		uMAX = PM_UMAX(pm) * pm->const_lpf_U;
+
+		/* Integrate over the half period only.
+		 * */
+		gI = pm_vsf_gain(pm, pm->i_gain_I) * .5f;
+
+		pm->i_integral_D += gI * eD;
+		pm->i_integral_D = (pm->i_integral_D > uMAX) ? uMAX :
+			(pm->i_integral_D < - uMAX) ? - uMAX : pm->i_integral_D;
+		uD += pm->i_integral_D;
+
+		pm->i_integral_Q += gI * eQ;
+		pm->i_integral_Q = (pm->i_integral_Q > uMAX) ? uMAX :
+			(pm->i_integral_Q < - uMAX) ? - uMAX : pm->i_integral_Q;
+		uQ += pm->i_integral_Q;
+
+		pm->i_valley = 1;
+
+		/* Output voltage CLAMP.
+		 * */
+		uD = (uD > pm->v_maximal) ? pm->v_maximal :
+			(uD < - pm->v_maximal) ? - pm->v_maximal : uD;
+		uQ = (uQ > pm->v_maximal) ? pm->v_maximal :
+			(uQ < pm->v_reverse) ? pm->v_reverse : uQ;
+
+		vX = pm->vsi_X;
+		vY = pm->vsi_Y;
+		vDX = pm->vsi_DX;
+		vDY = pm->vsi_DY;
+
+		IF = pm->vsi_IF;
+		UF = pm->vsi_UF;
+		AZ = pm->vsi_AZ;
+		BZ = pm->vsi_BZ;
+		CZ = pm->vsi_CZ;
+
+		pm_voltage(pm, F[0] * uD - F[1] * uQ, F[1] * uD + F[0] * uQ);
+
+		/* The observer sees the average voltage over the whole PWM
+		 * period, and the VSI flags are merged from both halves.
+		 * */
+		pm->vsi_X = (vX + pm->vsi_X) * .5f;
+		pm->vsi_Y = (vY + pm->vsi_Y) * .5f;
+		pm->vsi_DX = vDX;
+		pm->vsi_DY = vDY;
+
+		pm->vsi_IF = IF | (pm->vsi_IF & 1);
+		pm->vsi_UF = UF | (pm->vsi_UF & 1);
+		pm->vsi_AZ = AZ & (pm->vsi_AZ | 2);
+		pm->vsi_BZ = BZ & (pm->vsi_BZ | 2);
+		pm->vsi_CZ = CZ & (pm->vsi_CZ | 2);
+	}
+}
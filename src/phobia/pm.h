@@ -9,6 +9,7 @@
 #define PM_KWAT(pm)			((PM_CONFIG_NOP(pm) == 0) ? 1.5f : 1.f)
 
 #define PM_FLUX_MAX			25
+#define PM_COGG_MAX			64
 #define PM_INFINITY			7E+27f
 #define PM_UNDEFINED			16777216
 #define PM_SFI(s)			#s
@@ -24,6 +25,12 @@ enum {
 	PM_SENSOR_QEP,
 };
 
+enum {
+	PM_COGG_DISABLED			= 0,
+	PM_COGG_APPLY,
+	PM_COGG_LEARN,
+};
+
 enum {
 	PM_DISABLED				= 0,
 	PM_ENABLED
@@ -42,6 +49,7 @@ enum {
 	PM_LU_ESTIMATE_HFI,
 	PM_LU_SENSOR_HALL,
 	PM_LU_SENSOR_QEP,
+	PM_LU_ESTIMATE_EKF,
 };
 
 enum {
@@ -79,6 +87,14 @@ enum {
 	PM_ERROR_SENSOR_QEP_FAULT,
 };
 
+enum {
+	PM_MARK_INPUT				= 0,
+	PM_MARK_FSM,
+	PM_MARK_OBSERVER,
+	PM_MARK_LOOP,
+	PM_MARK_MAX
+};
+
 typedef struct {
 
 	float		current_A;
@@ -110,9 +126,13 @@ typedef struct {
 
 	int		config_NOP;
 	int		config_TVM;
+	int		config_DRIFT;
+	int		config_VSF;
 	int		config_HFI;
+	int		config_EKF;
 	int		config_SENSOR;
 	int		config_WEAK;
+	int		config_COGG;
 	int		config_DRIVE;
 	int		config_SERVO;
 	int		config_STAT;
@@ -141,6 +161,21 @@ typedef struct {
 	float		ad_UB[2];
 	float		ad_UC[2];
 
+	float		drift_IA;
+	float		drift_IB;
+	float		drift_lpf_A;
+	float		drift_lpf_B;
+	float		drift_slew;
+	float		drift_gain_LP;
+	int		drift_TIM;
+
+	float		vsf_freq_base;
+	float		vsf_freq_low;
+	float		vsf_rev_N;
+	float		vsf_load_i;
+	float		vsf_K;
+	int		vsf_TIM;
+
 	float		fb_iA;
 	float		fb_iB;
 	float		fb_uA;
@@ -235,6 +270,16 @@ typedef struct {
 	float		flux_gain_LP_E;
 	float		flux_gain_SF;
 
+	float		ekf_iX;
+	float		ekf_iY;
+	float		ekf_F[2];
+	float		ekf_wS;
+	float		ekf_P[10];
+	float		ekf_gain_QI;
+	float		ekf_gain_QS;
+	float		ekf_gain_QF;
+	float		ekf_gain_R;
+
 	float		inject_bias_U;
 	float		inject_ratio_D;
 
@@ -300,16 +345,27 @@ typedef struct {
 	float		i_derated_1;
 	float		i_setpoint_D;
 	float		i_setpoint_Q;
+	float		i_track_D;
+	float		i_track_Q;
 	float		i_integral_D;
 	float		i_integral_Q;
 	float		i_gain_P;
 	float		i_gain_I;
+	int		i_valley;
 
 	float		weak_maximal;
 	float		weak_bias_U;
 	float		weak_D;
 	float		weak_gain_EU;
 
+	float		cogg_T[PM_COGG_MAX];
+	int		cogg_bin;
+	float		cogg_frac;
+	float		cogg_F[2];
+	float		cogg_DC;
+	float		cogg_gain_LP;
+	float		cogg_gain_LE;
+
 	float		v_maximal;
 	float		v_reverse;
 
@@ -351,6 +407,12 @@ typedef struct {
 
 	void 		(* proc_set_DC) (int, int, int);
 	void 		(* proc_set_Z) (int);
+	int 		(* proc_set_FREQ) (float);
+
+	/* Optional hook called at the end of each stage of feedback
+	 * processing to profile the execution time.
+	 * */
+	void		(* proc_mark) (int);
 }
 pmc_t;
 
@@ -358,6 +420,7 @@ void pm_default(pmc_t *pm);
 
 void pm_voltage(pmc_t *pm, float uX, float uY);
 void pm_feedback(pmc_t *pm, pmfb_t *fb);
+void pm_feedback_valley(pmc_t *pm, pmfb_t *fb);
 
 void pm_ADD(float *S, float *C, float X);
 void pm_FSM(pmc_t *pm);
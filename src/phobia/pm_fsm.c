@@ -202,6 +202,9 @@ pm_fsm_state_zero_drift(pmc_t *pm)
 			pm->ad_IA[0] += - pm->probe_DFT[0];
 			pm->ad_IB[0] += - pm->probe_DFT[1];
 
+			pm->drift_IA = 0.f;
+			pm->drift_IB = 0.f;
+
 			if (		m_fabsf(pm->ad_IA[0]) > pm->fault_current_tol
 					|| m_fabsf(pm->ad_IB[0]) > pm->fault_current_tol) {
 
@@ -1161,6 +1164,15 @@ pm_fsm_state_lu_startup(pmc_t *pm)
 				pm->flux_F[1] = 0.f;
 				pm->flux_wS = 0.f;
 
+				pm->vsf_freq_base = pm->freq_hz;
+				pm->vsf_TIM = 0;
+
+				pm->ekf_iX = 0.f;
+				pm->ekf_iY = 0.f;
+				pm->ekf_F[0] = 1.f;
+				pm->ekf_F[1] = 0.f;
+				pm->ekf_wS = 0.f;
+
 				pm->hfi_iD = 0.f;
 				pm->hfi_iQ = 0.f;
 				pm->hfi_F[0] = 1.f;
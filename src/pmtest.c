@@ -166,8 +166,8 @@ SH_DEF(hal_PWM_set_DC)
 
 	if (stoi(&xDC, s) != NULL) {
 
-		xDC = (xDC < 0) ? 0 : (xDC > hal.PWM_resolution)
-			? hal.PWM_resolution : xDC;
+		xDC = (xDC < 0) ? 0 : (xDC > pm.dc_resolution)
+			? pm.dc_resolution : xDC;
 
 		PWM_set_DC(xDC, xDC, xDC);
 	}
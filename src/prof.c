@@ -0,0 +1,68 @@
+#include <stddef.h>
+
+#include "prof.h"
+
+#define PROF_SUM_LIMIT			0x7FFFFFFFUL
+#define PROF_WINDOW_N			0x10000UL
+
+static int
+prof_hist_bin(unsigned long dT)
+{
+	int		bin;
+
+	dT >>= PROF_HIST_SHIFT;
+
+	bin = (dT != 0) ? (int) (sizeof(dT) * 8) - __builtin_clzl(dT) : 0;
+
+	return (bin < PROF_HIST_MAX) ? bin : PROF_HIST_MAX - 1;
+}
+
+void prof_add(prof_t *pf, unsigned long dT)
+{
+	if (pf->N == 0 || dT < pf->min)
+		pf->min = dT;
+
+	if (dT > pf->max)
+		pf->max = dT;
+
+	if (pf->sum > PROF_SUM_LIMIT - dT || pf->sum_N >= PROF_WINDOW_N) {
+
+		/* Forget the older half of the window.
+		 * */
+		pf->sum >>= 1;
+		pf->sum_N >>= 1;
+	}
+
+	pf->sum += dT;
+	pf->sum_N++;
+
+	pf->N++;
+	pf->hist[prof_hist_bin(dT)]++;
+}
+
+void prof_reset(prof_t *pf)
+{
+	int		bin;
+
+	pf->min = 0;
+	pf->max = 0;
+	pf->sum = 0;
+	pf->sum_N = 0;
+	pf->N = 0;
+
+	for (bin = 0; bin < PROF_HIST_MAX; ++bin)
+		pf->hist[bin] = 0;
+}
+
+unsigned long prof_mean(const prof_t *pf)
+{
+	return (pf->sum_N != 0) ? pf->sum / pf->sum_N : 0;
+}
+
+unsigned long prof_hist_bound(int bin)
+{
+	/* Upper bound of the bin in ticks.
+	 * */
+	return 1UL << (PROF_HIST_SHIFT + bin);
+}
+
@@ -0,0 +1,37 @@
+#ifndef _H_PROF_
+#define _H_PROF_
+
+#define PROF_HIST_MAX			16
+#define PROF_HIST_SHIFT			6
+
+/* Execution time profile of the code fragment. Time is measured in ticks of
+ * the platform clock that is DWT cycle counter on target and nanoseconds of
+ * the monotonic clock in simulator. Mean is kept over the sliding window as
+ * the sum is halved together with the count before it overflows. Histogram
+ * is logarithmic, bin 0 counts the time below 2^PROF_HIST_SHIFT ticks and
+ * each next bin is twice as wide, the last bin takes everything above.
+ * */
+
+typedef struct {
+
+	unsigned long		min;
+	unsigned long		max;
+
+	unsigned long		sum;
+	unsigned long		sum_N;
+
+	int			N;
+	int			hist[PROF_HIST_MAX];
+}
+prof_t;
+
+unsigned long prof_clock();
+
+void prof_add(prof_t *pf, unsigned long dT);
+void prof_reset(prof_t *pf);
+
+unsigned long prof_mean(const prof_t *pf);
+unsigned long prof_hist_bound(int bin);
+
+#endif /* _H_PROF_ */
+
@@ -0,0 +1,232 @@
+#include <stddef.h>
+
+#include "frame.h"
+#include "libc.h"
+#include "regbin.h"
+#include "regfile.h"
+
+static unsigned char		regbin_req[REGBIN_FRAME_MAX];
+static unsigned char		regbin_resp[REGBIN_FRAME_MAX + 4];
+
+static regbin_t			regbin_usart;
+
+static int
+regbin_get_ID(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static unsigned char *
+regbin_put_val(unsigned char *p, const reg_val_t *val)
+{
+	unsigned int		u = (unsigned int) val->i;
+
+	p[0] = (unsigned char) (u);
+	p[1] = (unsigned char) (u >> 8);
+	p[2] = (unsigned char) (u >> 16);
+	p[3] = (unsigned char) (u >> 24);
+
+	return p + 4;
+}
+
+static void
+regbin_get_val(const unsigned char *p, reg_val_t *val)
+{
+	val->i = (int) (p[0] | (p[1] << 8) | (p[2] << 16)
+			| ((unsigned int) p[3] << 24));
+}
+
+static unsigned char *
+regbin_put_str(unsigned char *p, const unsigned char *end, const char *s)
+{
+	do {
+		if (p >= end)
+			return NULL;
+
+		*p++ = (unsigned char) *s;
+	}
+	while (*s++ != 0);
+
+	return p;
+}
+
+static unsigned char *
+regbin_desc(unsigned char *p, const unsigned char *end, const reg_t *reg)
+{
+	if (p + 3 > end)
+		return NULL;
+
+	*p++ = REGBIN_OK;
+	*p++ = (unsigned char) reg->fmt[1];
+	*p++ = (unsigned char) reg->mode;
+
+	p = regbin_put_str(p, end, reg->sym);
+
+	if (p != NULL) {
+
+		/* Unit is placed after the symbol.
+		 * */
+		p = regbin_put_str(p, end, reg->sym + strlen(reg->sym) + 1);
+	}
+
+	return p;
+}
+
+int regbin_call(regbin_t *rb, const unsigned char *req, int len,
+		unsigned char *resp, int max)
+{
+	const unsigned char	*end = req + len;
+	unsigned char		*p, *next, *rend = resp + max;
+	const reg_t		*reg;
+	reg_val_t		val;
+	int			op, ID, step;
+
+	if (len < 2 || max < 2)
+		return 0;
+
+	op = req[0];
+
+	resp[0] = (unsigned char) op;
+	resp[1] = req[1];
+
+	step = (op == REGBIN_WRITE) ? 6 : 2;
+
+	p = resp + 2;
+	req += 2;
+
+	if (op == REGBIN_SUBSCRIBE) {
+
+		if (rb->started == 0) {
+
+			rb->started = reg_subscribe(&rb->sub);
+		}
+
+		for (; req + 2 <= end && p < rend; req += 2) {
+
+			ID = regbin_get_ID(req);
+
+			*p++ = (rb->started == 0) ? REGBIN_NO_SPACE
+				: (ID < REG_ID_MAX) ? REGBIN_OK : REGBIN_INVALID;
+
+			reg_sub_add(&rb->sub, ID);
+		}
+
+		return (int) (p - resp);
+	}
+	else if (op == REGBIN_UNSUBSCRIBE) {
+
+		if (rb->started != 0) {
+
+			reg_unsubscribe(&rb->sub);
+			rb->started = 0;
+		}
+
+		return 2;
+	}
+	else if (op == REGBIN_CHANGES) {
+
+		if (rb->started != 0) {
+
+			reg_sub_scan(&rb->sub);
+
+			while (p + 6 <= rend && (ID = reg_sub_next(&rb->sub)) >= 0) {
+
+				reg_getval(regfile + ID, &val);
+
+				*p++ = (unsigned char) (ID);
+				*p++ = (unsigned char) (ID >> 8);
+
+				p = regbin_put_val(p, &val);
+			}
+		}
+
+		return (int) (p - resp);
+	}
+	else if (	   op != REGBIN_READ
+			&& op != REGBIN_WRITE
+			&& op != REGBIN_DESC) {
+
+		resp[0] = REGBIN_UNKNOWN;
+
+		return 2;
+	}
+
+	for (; req + step <= end; req += step) {
+
+		ID = regbin_get_ID(req);
+		reg = (ID < REG_ID_MAX) ? regfile + ID : NULL;
+
+		if (op == REGBIN_DESC) {
+
+			if (reg != NULL) {
+
+				next = regbin_desc(p, rend, reg);
+			}
+			else {
+				next = (p < rend) ? p + 1 : NULL;
+
+				if (next != NULL)
+					*p = REGBIN_INVALID;
+			}
+		}
+		else if (p + 5 <= rend) {
+
+			val.i = 0;
+
+			if (reg == NULL) {
+
+				*p = REGBIN_INVALID;
+			}
+			else {
+				*p = REGBIN_OK;
+
+				if (op == REGBIN_WRITE) {
+
+					if (reg->mode & REG_READ_ONLY) {
+
+						*p = REGBIN_READ_ONLY;
+					}
+					else {
+						regbin_get_val(req + 2, &val);
+						reg_setval(reg, &val);
+					}
+				}
+
+				/* We go through proc as shell does.
+				 * */
+				reg_getval(reg, &val);
+			}
+
+			next = regbin_put_val(p + 1, &val);
+		}
+		else {
+			next = NULL;
+		}
+
+		if (next == NULL)
+			break;
+
+		p = next;
+	}
+
+	return (int) (p - resp);
+}
+
+void regbin_frame()
+{
+	int			len;
+
+	len = frame_recv(regbin_req, sizeof(regbin_req));
+
+	if (len > 0) {
+
+		len = regbin_call(&regbin_usart, regbin_req, len,
+				regbin_resp, REGBIN_FRAME_MAX);
+
+		if (len > 0) {
+
+			frame_send(regbin_resp, len);
+		}
+	}
+}
+
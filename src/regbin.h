@@ -0,0 +1,58 @@
+#ifndef _H_REGBIN_
+#define _H_REGBIN_
+
+#include "regfile.h"
+
+#define REGBIN_FRAME_MAX		260
+
+/* Binary register protocol. Request begins with operation code and sequence
+ * number that are returned back in response. Values are 32-bit little-endian
+ * of integer or float as the register format says.
+ *
+ * 'R' [ID16]...             ->  'R' [status8][value32]...
+ * 'W' [ID16][value32]...    ->  'W' [status8][value32]...
+ * 'D' [ID16]...             ->  'D' [status8][type8][mode8][sym]\0[unit]\0...
+ * 'S' [ID16]...             ->  'S' [status8]...
+ * 'U'                       ->  'U'
+ * 'C'                       ->  'C' [ID16][value32]...
+ *
+ * Write response has the value that was read back after write. The items
+ * that do not fit into the response are dropped. Subscribe adds registers to
+ * the subscription, then changes request returns only the registers that
+ * were changed since the previous one. Changes that do not fit are kept for
+ * the next request.
+ *
+ * Subscription is kept in the context of each transport so the serial and
+ * CAN clients do not see the changes of each other.
+ * */
+
+enum {
+	REGBIN_READ		= 'R',
+	REGBIN_WRITE		= 'W',
+	REGBIN_DESC		= 'D',
+	REGBIN_SUBSCRIBE	= 'S',
+	REGBIN_UNSUBSCRIBE	= 'U',
+	REGBIN_CHANGES		= 'C',
+	REGBIN_UNKNOWN		= '?'
+};
+
+enum {
+	REGBIN_OK		= 0,
+	REGBIN_INVALID,
+	REGBIN_READ_ONLY,
+	REGBIN_NO_SPACE
+};
+
+typedef struct {
+
+	reg_sub_t		sub;
+	int			started;
+}
+regbin_t;
+
+int regbin_call(regbin_t *rb, const unsigned char *req, int len,
+		unsigned char *resp, int max);
+void regbin_frame();
+
+#endif /* _H_REGBIN_ */
+
@@ -3,6 +3,7 @@ ID_HAL_HSE_CRYSTAL_CLOCK,
 ID_HAL_USART_BAUD_RATE,
 ID_HAL_PWM_FREQUENCY,
 ID_HAL_PWM_DEADTIME,
+ID_HAL_PWM_DUAL,
 ID_HAL_ADC_REFERENCE_VOLTAGE,
 ID_HAL_ADC_SHUNT_RESISTANCE,
 ID_HAL_ADC_AMPLIFIER_GAIN,
@@ -10,9 +11,20 @@ ID_HAL_ADC_VOLTAGE_RATIO,
 ID_HAL_ADC_TERMINAL_RATIO,
 ID_HAL_ADC_TERMINAL_BIAS,
 ID_HAL_TIM_MODE,
+ID_HAL_CAN_RING_OVERFLOW_N,
+ID_HAL_CAN_RING_PEAK_N,
+ID_HAL_CAN_OVERRUN_N,
+ID_HAL_CAN_TX_RING_0_OVERFLOW_N,
+ID_HAL_CAN_TX_RING_1_OVERFLOW_N,
+ID_HAL_CAN_TX_RING_2_OVERFLOW_N,
+ID_HAL_CAN_TX_RING_0_PEAK_N,
+ID_HAL_CAN_TX_RING_1_PEAK_N,
+ID_HAL_CAN_TX_RING_2_PEAK_N,
 ID_HAL_PPM_MODE,
 ID_HAL_PPM_TIMEBASE,
 ID_HAL_PPM_SIGNAL_CAUGHT,
+ID_AP_CAN_NODE_ID,
+ID_AP_CAN_STATE_RATE,
 ID_AP_PPM_REG_ID,
 ID_AP_PPM_PULSE_RANGE_0,
 ID_AP_PPM_PULSE_RANGE_1,
@@ -64,6 +76,73 @@ ID_AP_HEAT_GAP,
 ID_AP_PULL_G,
 ID_AP_PULL_AD_0,
 ID_AP_PULL_AD_1,
+ID_AP_PROF_ADC_IRQ_MIN,
+ID_AP_PROF_ADC_IRQ_MEAN,
+ID_AP_PROF_ADC_IRQ_MAX,
+ID_AP_PROF_ADC_IRQ_PC,
+ID_AP_PROF_PM_INPUT_MIN,
+ID_AP_PROF_PM_INPUT_MEAN,
+ID_AP_PROF_PM_INPUT_MAX,
+ID_AP_PROF_PM_FSM_MIN,
+ID_AP_PROF_PM_FSM_MEAN,
+ID_AP_PROF_PM_FSM_MAX,
+ID_AP_PROF_PM_OBSERVER_MIN,
+ID_AP_PROF_PM_OBSERVER_MEAN,
+ID_AP_PROF_PM_OBSERVER_MAX,
+ID_AP_PROF_PM_LOOP_MIN,
+ID_AP_PROF_PM_LOOP_MEAN,
+ID_AP_PROF_PM_LOOP_MAX,
+ID_AP_PROF_TEL_GRAB_MIN,
+ID_AP_PROF_TEL_GRAB_MEAN,
+ID_AP_PROF_TEL_GRAB_MAX,
+ID_AP_TASK_0_LOAD_1S,
+ID_AP_TASK_1_LOAD_1S,
+ID_AP_TASK_2_LOAD_1S,
+ID_AP_TASK_3_LOAD_1S,
+ID_AP_TASK_4_LOAD_1S,
+ID_AP_TASK_5_LOAD_1S,
+ID_AP_TASK_6_LOAD_1S,
+ID_AP_TASK_7_LOAD_1S,
+ID_AP_TASK_8_LOAD_1S,
+ID_AP_TASK_9_LOAD_1S,
+ID_AP_TASK_10_LOAD_1S,
+ID_AP_TASK_11_LOAD_1S,
+ID_AP_TASK_0_LOAD_10S,
+ID_AP_TASK_1_LOAD_10S,
+ID_AP_TASK_2_LOAD_10S,
+ID_AP_TASK_3_LOAD_10S,
+ID_AP_TASK_4_LOAD_10S,
+ID_AP_TASK_5_LOAD_10S,
+ID_AP_TASK_6_LOAD_10S,
+ID_AP_TASK_7_LOAD_10S,
+ID_AP_TASK_8_LOAD_10S,
+ID_AP_TASK_9_LOAD_10S,
+ID_AP_TASK_10_LOAD_10S,
+ID_AP_TASK_11_LOAD_10S,
+ID_AP_TASK_0_SWITCH_N,
+ID_AP_TASK_1_SWITCH_N,
+ID_AP_TASK_2_SWITCH_N,
+ID_AP_TASK_3_SWITCH_N,
+ID_AP_TASK_4_SWITCH_N,
+ID_AP_TASK_5_SWITCH_N,
+ID_AP_TASK_6_SWITCH_N,
+ID_AP_TASK_7_SWITCH_N,
+ID_AP_TASK_8_SWITCH_N,
+ID_AP_TASK_9_SWITCH_N,
+ID_AP_TASK_10_SWITCH_N,
+ID_AP_TASK_11_SWITCH_N,
+ID_AP_TASK_0_STACK_FREE,
+ID_AP_TASK_1_STACK_FREE,
+ID_AP_TASK_2_STACK_FREE,
+ID_AP_TASK_3_STACK_FREE,
+ID_AP_TASK_4_STACK_FREE,
+ID_AP_TASK_5_STACK_FREE,
+ID_AP_TASK_6_STACK_FREE,
+ID_AP_TASK_7_STACK_FREE,
+ID_AP_TASK_8_STACK_FREE,
+ID_AP_TASK_9_STACK_FREE,
+ID_AP_TASK_10_STACK_FREE,
+ID_AP_TASK_11_STACK_FREE,
 ID_PM_DC_RESOLUTION,
 ID_PM_DC_MINIMAL,
 ID_PM_DC_CLEARANCE,
@@ -73,9 +152,13 @@ ID_PM_SELF_BM,
 ID_PM_SELF_RMS,
 ID_PM_CONFIG_NOP,
 ID_PM_CONFIG_TVM,
+ID_PM_CONFIG_DRIFT,
+ID_PM_CONFIG_VSF,
 ID_PM_CONFIG_HFI,
+ID_PM_CONFIG_EKF,
 ID_PM_CONFIG_SENSOR,
 ID_PM_CONFIG_WEAK,
+ID_PM_CONFIG_COGG,
 ID_PM_CONFIG_DRIVE,
 ID_PM_CONFIG_SERVO,
 ID_PM_CONFIG_STAT,
@@ -102,6 +185,14 @@ ID_PM_AD_UB_0,
 ID_PM_AD_UB_1,
 ID_PM_AD_UC_0,
 ID_PM_AD_UC_1,
+ID_PM_DRIFT_IA,
+ID_PM_DRIFT_IB,
+ID_PM_DRIFT_SLEW,
+ID_PM_DRIFT_GAIN_LP,
+ID_PM_VSF_FREQ_BASE,
+ID_PM_VSF_FREQ_LOW,
+ID_PM_VSF_REV_N,
+ID_PM_VSF_LOAD_I,
 ID_PM_FB_IA,
 ID_PM_FB_IB,
 ID_PM_FB_UA,
@@ -179,6 +270,16 @@ ID_PM_FLUX_GAIN_LO,
 ID_PM_FLUX_GAIN_HI,
 ID_PM_FLUX_GAIN_LP_E,
 ID_PM_FLUX_GAIN_SF,
+ID_PM_EKF_F_0,
+ID_PM_EKF_F_1,
+ID_PM_EKF_FG,
+ID_PM_EKF_WS,
+ID_PM_EKF_WS_RPM,
+ID_PM_EKF_WS_KMH,
+ID_PM_EKF_GAIN_QI,
+ID_PM_EKF_GAIN_QS,
+ID_PM_EKF_GAIN_QF,
+ID_PM_EKF_GAIN_R,
 ID_PM_INJECT_BIAS_U,
 ID_PM_INJECT_RATIO_D,
 ID_PM_HFI_FREQ_HZ,
@@ -243,6 +344,72 @@ ID_PM_WEAK_MAXIMAL,
 ID_PM_WEAK_BIAS_U,
 ID_PM_WEAK_D,
 ID_PM_WEAK_GAIN_EU,
+ID_PM_COGG_T_0,
+ID_PM_COGG_T_1,
+ID_PM_COGG_T_2,
+ID_PM_COGG_T_3,
+ID_PM_COGG_T_4,
+ID_PM_COGG_T_5,
+ID_PM_COGG_T_6,
+ID_PM_COGG_T_7,
+ID_PM_COGG_T_8,
+ID_PM_COGG_T_9,
+ID_PM_COGG_T_10,
+ID_PM_COGG_T_11,
+ID_PM_COGG_T_12,
+ID_PM_COGG_T_13,
+ID_PM_COGG_T_14,
+ID_PM_COGG_T_15,
+ID_PM_COGG_T_16,
+ID_PM_COGG_T_17,
+ID_PM_COGG_T_18,
+ID_PM_COGG_T_19,
+ID_PM_COGG_T_20,
+ID_PM_COGG_T_21,
+ID_PM_COGG_T_22,
+ID_PM_COGG_T_23,
+ID_PM_COGG_T_24,
+ID_PM_COGG_T_25,
+ID_PM_COGG_T_26,
+ID_PM_COGG_T_27,
+ID_PM_COGG_T_28,
+ID_PM_COGG_T_29,
+ID_PM_COGG_T_30,
+ID_PM_COGG_T_31,
+ID_PM_COGG_T_32,
+ID_PM_COGG_T_33,
+ID_PM_COGG_T_34,
+ID_PM_COGG_T_35,
+ID_PM_COGG_T_36,
+ID_PM_COGG_T_37,
+ID_PM_COGG_T_38,
+ID_PM_COGG_T_39,
+ID_PM_COGG_T_40,
+ID_PM_COGG_T_41,
+ID_PM_COGG_T_42,
+ID_PM_COGG_T_43,
+ID_PM_COGG_T_44,
+ID_PM_COGG_T_45,
+ID_PM_COGG_T_46,
+ID_PM_COGG_T_47,
+ID_PM_COGG_T_48,
+ID_PM_COGG_T_49,
+ID_PM_COGG_T_50,
+ID_PM_COGG_T_51,
+ID_PM_COGG_T_52,
+ID_PM_COGG_T_53,
+ID_PM_COGG_T_54,
+ID_PM_COGG_T_55,
+ID_PM_COGG_T_56,
+ID_PM_COGG_T_57,
+ID_PM_COGG_T_58,
+ID_PM_COGG_T_59,
+ID_PM_COGG_T_60,
+ID_PM_COGG_T_61,
+ID_PM_COGG_T_62,
+ID_PM_COGG_T_63,
+ID_PM_COGG_GAIN_LP,
+ID_PM_COGG_GAIN_LE,
 ID_PM_V_MAXIMAL,
 ID_PM_V_REVERSE,
 ID_PM_S_MAXIMAL,
@@ -290,3 +457,27 @@ ID_TI_REG_ID_6,
 ID_TI_REG_ID_7,
 ID_TI_REG_ID_8,
 ID_TI_REG_ID_9,
+ID_TI_DIV_0,
+ID_TI_DIV_1,
+ID_TI_DIV_2,
+ID_TI_DIV_3,
+ID_TI_DIV_4,
+ID_TI_DIV_5,
+ID_TI_DIV_6,
+ID_TI_DIV_7,
+ID_TI_DIV_8,
+ID_TI_DIV_9,
+ID_TI_AGG_0,
+ID_TI_AGG_1,
+ID_TI_AGG_2,
+ID_TI_AGG_3,
+ID_TI_AGG_4,
+ID_TI_AGG_5,
+ID_TI_AGG_6,
+ID_TI_AGG_7,
+ID_TI_AGG_8,
+ID_TI_AGG_9,
+ID_TI_TR_MODE,
+ID_TI_TR_REG_ID,
+ID_TI_TR_LEVEL,
+ID_TI_TR_POST,
@@ -33,6 +33,7 @@ reg_proc_pwm(const reg_t *reg, float *lval, const float *rval)
 		pm.freq_hz = hal.PWM_frequency;
 		pm.dT = 1.f / pm.freq_hz;
 		pm.dc_resolution = hal.PWM_resolution;
+		pm.vsf_K = 1.f;
 
 		ADC_irq_unlock();
 		taskEXIT_CRITICAL();
@@ -350,13 +351,58 @@ reg_proc_km(const reg_t *reg, float *lval, const float *rval)
         }
 }
 
+static float
+reg_prof_us(unsigned long ticks)
+{
+	return (float) ticks * (1000000.f / (float) clock_cpu_hz);
+}
+
+static void
+reg_proc_prof_min(const reg_t *reg, float *lval, const float *rval)
+{
+	if (lval != NULL) {
+
+		*lval = reg_prof_us(((const prof_t *) reg->link)->min);
+	}
+}
+
+static void
+reg_proc_prof_mean(const reg_t *reg, float *lval, const float *rval)
+{
+	if (lval != NULL) {
+
+		*lval = reg_prof_us(prof_mean((const prof_t *) reg->link));
+	}
+}
+
+static void
+reg_proc_prof_max(const reg_t *reg, float *lval, const float *rval)
+{
+	if (lval != NULL) {
+
+		*lval = reg_prof_us(((const prof_t *) reg->link)->max);
+	}
+}
+
+static void
+reg_proc_prof_pc(const reg_t *reg, float *lval, const float *rval)
+{
+	if (lval != NULL) {
+
+		/* Peak time in percent of the PWM period.
+		 * */
+		*lval = reg_prof_us(((const prof_t *) reg->link)->max)
+			* pm.freq_hz / 10000.f;
+	}
+}
+
 static void
 reg_format_dcns(const reg_t *reg)
 {
 	float			dcns;
 
 	dcns = (float) (reg->link->i) * 1000000000.f
-		/ (hal.PWM_frequency * (float) hal.PWM_resolution);
+		/ (pm.freq_hz * (float) pm.dc_resolution);
 
 	printf("%i (%1f ns)", reg->link->i, &dcns);
 }
@@ -366,11 +412,44 @@ reg_format_dcms(const reg_t *reg)
 {
 	float			dcms;
 
-	dcms = (float) (reg->link->i) * 1000.f / hal.PWM_frequency;
+	/* Hold time is counted in periods of the base frequency.
+	 * */
+	dcms = (float) (reg->link->i) * 1000.f / (pm.freq_hz * pm.vsf_K);
 
 	printf("%i (%1f ms)", reg->link->i, &dcms);
 }
 
+static void
+reg_format_task(const reg_t *reg)
+{
+	reg_val_t		rval;
+	const char		*su, *name;
+	int			N;
+
+	N = (int) (((const char *) reg->link - (const char *) ap.task)
+			/ sizeof(rtos_task_t));
+
+	reg_getval(reg, &rval);
+	reg_format_rval(reg, &rval);
+
+	su = reg->sym + strlen(reg->sym) + 1;
+
+	if (*su != 0) {
+
+		printf(" (%s)", su);
+	}
+
+	/* Task may be deleted at any time so the name is not safe to
+	 * print after that, it is just a hint.
+	 * */
+	name = ap.task[N].name;
+
+	if (name != NULL) {
+
+		printf(" %s", name);
+	}
+}
+
 static void
 reg_format_self_BM(const reg_t *reg)
 {
@@ -449,6 +528,43 @@ reg_format_enum(const reg_t *reg)
 			}
 			break;
 
+		case ID_TI_AGG_0:
+		case ID_TI_AGG_1:
+		case ID_TI_AGG_2:
+		case ID_TI_AGG_3:
+		case ID_TI_AGG_4:
+		case ID_TI_AGG_5:
+		case ID_TI_AGG_6:
+		case ID_TI_AGG_7:
+		case ID_TI_AGG_8:
+		case ID_TI_AGG_9:
+
+			switch (val) {
+
+				TEXT_ITEM(TEL_AGG_LAST);
+				TEXT_ITEM(TEL_AGG_MEAN);
+				TEXT_ITEM(TEL_AGG_MIN);
+				TEXT_ITEM(TEL_AGG_MAX);
+				TEXT_ITEM(TEL_AGG_RMS);
+
+				default: break;
+			}
+			break;
+
+		case ID_TI_TR_MODE:
+
+			switch (val) {
+
+				TEXT_ITEM(TEL_TRIG_DISABLED);
+				TEXT_ITEM(TEL_TRIG_RISING);
+				TEXT_ITEM(TEL_TRIG_FALLING);
+				TEXT_ITEM(TEL_TRIG_CHANGE);
+				TEXT_ITEM(TEL_TRIG_FAULT);
+
+				default: break;
+			}
+			break;
+
 		case ID_PM_FAIL_REASON:
 
 			printf("(%s)", pm_strerror(pm.fail_reason));
@@ -466,7 +582,10 @@ reg_format_enum(const reg_t *reg)
 			break;
 
 		case ID_PM_CONFIG_TVM:
+		case ID_PM_CONFIG_DRIFT:
+		case ID_PM_CONFIG_VSF:
 		case ID_PM_CONFIG_HFI:
+		case ID_PM_CONFIG_EKF:
 		case ID_PM_CONFIG_WEAK:
 		case ID_PM_CONFIG_SERVO:
 		case ID_PM_CONFIG_STAT:
@@ -492,6 +611,18 @@ reg_format_enum(const reg_t *reg)
 			}
 			break;
 
+		case ID_PM_CONFIG_COGG:
+
+			switch (val) {
+
+				TEXT_ITEM(PM_COGG_DISABLED);
+				TEXT_ITEM(PM_COGG_APPLY);
+				TEXT_ITEM(PM_COGG_LEARN);
+
+				default: break;
+			}
+			break;
+
 		case ID_PM_CONFIG_DRIVE:
 
 			switch (val) {
@@ -541,6 +672,7 @@ reg_format_enum(const reg_t *reg)
 				TEXT_ITEM(PM_LU_ESTIMATE_HFI);
 				TEXT_ITEM(PM_LU_SENSOR_HALL);
 				TEXT_ITEM(PM_LU_SENSOR_QEP);
+				TEXT_ITEM(PM_LU_ESTIMATE_EKF);
 
 				default: break;
 			}
@@ -558,6 +690,7 @@ const reg_t		regfile[] = {
 	REG_DEF(hal.USART_baud_rate,,		"",	"%i",	REG_CONFIG, NULL, NULL),
 	REG_DEF(hal.PWM_frequency,,		"Hz",	"%1f",	REG_CONFIG, &reg_proc_pwm, NULL),
 	REG_DEF(hal.PWM_deadtime,,		"ns",	"%1f",	REG_CONFIG, &reg_proc_pwm, NULL),
+	REG_DEF(hal.PWM_dual,,			"",	"%i",	REG_CONFIG, NULL, NULL),
 	REG_DEF(hal.ADC_reference_voltage,,	"V",	"%3f",	REG_CONFIG, NULL, NULL),
 	REG_DEF(hal.ADC_shunt_resistance,,	"Ohm",	"%4e",	REG_CONFIG, NULL, NULL),
 	REG_DEF(hal.ADC_amplifier_gain,,	"",	"%4e",	REG_CONFIG, NULL, NULL),
@@ -565,10 +698,22 @@ const reg_t		regfile[] = {
 	REG_DEF(hal.ADC_terminal_ratio,,	"",	"%4e",	REG_CONFIG, NULL, NULL),
 	REG_DEF(hal.ADC_terminal_bias,,		"",	"%4e",	REG_CONFIG, NULL, NULL),
 	REG_DEF(hal.TIM_mode,,		"",	"%i", REG_CONFIG, &reg_proc_tim, &reg_format_enum),
+	REG_DEF(hal.CAN_ring.overflow_N,,	"",	"%i",	REG_READ_ONLY, NULL, NULL),
+	REG_DEF(hal.CAN_ring.peak_N,,		"",	"%i",	REG_READ_ONLY, NULL, NULL),
+	REG_DEF(hal.CAN_overrun_N,,		"",	"%i",	REG_READ_ONLY, NULL, NULL),
+	REG_DEF(hal.CAN_tx_ring[0].overflow_N,,	"",	"%i",	REG_READ_ONLY, NULL, NULL),
+	REG_DEF(hal.CAN_tx_ring[1].overflow_N,,	"",	"%i",	REG_READ_ONLY, NULL, NULL),
+	REG_DEF(hal.CAN_tx_ring[2].overflow_N,,	"",	"%i",	REG_READ_ONLY, NULL, NULL),
+	REG_DEF(hal.CAN_tx_ring[0].peak_N,,	"",	"%i",	REG_READ_ONLY, NULL, NULL),
+	REG_DEF(hal.CAN_tx_ring[1].peak_N,,	"",	"%i",	REG_READ_ONLY, NULL, NULL),
+	REG_DEF(hal.CAN_tx_ring[2].peak_N,,	"",	"%i",	REG_READ_ONLY, NULL, NULL),
 	REG_DEF(hal.PPM_mode,,		"",	"%i", REG_CONFIG, &reg_proc_ppm, &reg_format_enum),
 	REG_DEF(hal.PPM_timebase,,		"Hz",	"%i",	REG_CONFIG, NULL, NULL),
 	REG_DEF(hal.PPM_signal_caught,,		"",	"%i",	REG_READ_ONLY, NULL, NULL),
 
+	REG_DEF(ap.can_node_ID,,		"",	"%i",	REG_CONFIG, NULL, NULL),
+	REG_DEF(ap.can_state_rate,,		"Hz",	"%i",	REG_CONFIG, NULL, NULL),
+
 	REG_DEF(ap.ppm_reg_ID,,			"",	"%i",	REG_CONFIG | REG_LINKED, NULL, NULL),
 	REG_DEF(ap.ppm_pulse_range[0],,		"us",	"%3f",	REG_CONFIG, NULL, NULL),
 	REG_DEF(ap.ppm_pulse_range[1],,		"us",	"%3f",	REG_CONFIG, NULL, NULL),
@@ -626,6 +771,75 @@ const reg_t		regfile[] = {
 	REG_DEF(ap.pull_ad[0],,			"g",	"%1f",	REG_CONFIG, NULL, NULL),
 	REG_DEF(ap.pull_ad[1],,			"",	"%4e",	REG_CONFIG, NULL, NULL),
 
+	REG_DEF(ap.prof.ADC_IRQ, _min,		"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_min, NULL),
+	REG_DEF(ap.prof.ADC_IRQ, _mean,		"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_mean, NULL),
+	REG_DEF(ap.prof.ADC_IRQ, _max,		"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_max, NULL),
+	REG_DEF(ap.prof.ADC_IRQ, _pc,		"%",	"%1f",	REG_READ_ONLY, &reg_proc_prof_pc, NULL),
+	REG_DEF(ap.prof.pm_input, _min,		"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_min, NULL),
+	REG_DEF(ap.prof.pm_input, _mean,	"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_mean, NULL),
+	REG_DEF(ap.prof.pm_input, _max,		"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_max, NULL),
+	REG_DEF(ap.prof.pm_FSM, _min,		"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_min, NULL),
+	REG_DEF(ap.prof.pm_FSM, _mean,		"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_mean, NULL),
+	REG_DEF(ap.prof.pm_FSM, _max,		"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_max, NULL),
+	REG_DEF(ap.prof.pm_observer, _min,	"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_min, NULL),
+	REG_DEF(ap.prof.pm_observer, _mean,	"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_mean, NULL),
+	REG_DEF(ap.prof.pm_observer, _max,	"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_max, NULL),
+	REG_DEF(ap.prof.pm_loop, _min,		"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_min, NULL),
+	REG_DEF(ap.prof.pm_loop, _mean,		"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_mean, NULL),
+	REG_DEF(ap.prof.pm_loop, _max,		"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_max, NULL),
+	REG_DEF(ap.prof.tel_grab, _min,		"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_min, NULL),
+	REG_DEF(ap.prof.tel_grab, _mean,	"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_mean, NULL),
+	REG_DEF(ap.prof.tel_grab, _max,		"us",	"%2f",	REG_READ_ONLY, &reg_proc_prof_max, NULL),
+
+	REG_DEF(ap.task[0].load_1s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[1].load_1s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[2].load_1s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[3].load_1s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[4].load_1s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[5].load_1s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[6].load_1s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[7].load_1s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[8].load_1s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[9].load_1s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[10].load_1s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[11].load_1s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[0].load_10s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[1].load_10s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[2].load_10s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[3].load_10s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[4].load_10s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[5].load_10s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[6].load_10s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[7].load_10s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[8].load_10s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[9].load_10s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[10].load_10s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[11].load_10s,,		"%",	"%1f",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[0].switch_N,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[1].switch_N,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[2].switch_N,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[3].switch_N,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[4].switch_N,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[5].switch_N,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[6].switch_N,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[7].switch_N,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[8].switch_N,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[9].switch_N,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[10].switch_N,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[11].switch_N,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[0].stack_free,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[1].stack_free,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[2].stack_free,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[3].stack_free,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[4].stack_free,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[5].stack_free,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[6].stack_free,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[7].stack_free,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[8].stack_free,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[9].stack_free,,		"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[10].stack_free,,	"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+	REG_DEF(ap.task[11].stack_free,,	"",	"%i",	REG_READ_ONLY, NULL, &reg_format_task),
+
 	REG_DEF(pm.dc_resolution,,	"",	"%i",	REG_READ_ONLY, NULL, NULL),
 	REG_DEF(pm.dc_minimal,,		"",	"%i",	REG_CONFIG, NULL, &reg_format_dcns),
 	REG_DEF(pm.dc_clearance,,	"",	"%i",	REG_CONFIG, NULL, &reg_format_dcns),
@@ -637,9 +851,13 @@ const reg_t		regfile[] = {
 
 	REG_DEF(pm.config_NOP,,		"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
 	REG_DEF(pm.config_TVM,,		"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(pm.config_DRIFT,,	"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(pm.config_VSF,,		"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
 	REG_DEF(pm.config_HFI,,		"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(pm.config_EKF,,		"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
 	REG_DEF(pm.config_SENSOR,,	"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
 	REG_DEF(pm.config_WEAK,,	"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(pm.config_COGG,,	"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
 	REG_DEF(pm.config_DRIVE,,	"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
 	REG_DEF(pm.config_SERVO,,	"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
 	REG_DEF(pm.config_STAT,,	"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
@@ -670,6 +888,16 @@ const reg_t		regfile[] = {
 	REG_DEF(pm.ad_UC[0],,			"V",	"%3f",	REG_CONFIG, NULL, NULL),
 	REG_DEF(pm.ad_UC[1],,			"",	"%4e",	REG_CONFIG, NULL, NULL),
 
+	REG_DEF(pm.drift_IA,,			"A",	"%3f",	REG_READ_ONLY, NULL, NULL),
+	REG_DEF(pm.drift_IB,,			"A",	"%3f",	REG_READ_ONLY, NULL, NULL),
+	REG_DEF(pm.drift_slew,,			"A/s",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.drift_gain_LP,,		"",	"%2e",	REG_CONFIG, NULL, NULL),
+
+	REG_DEF(pm.vsf_freq_base,,		"Hz",	"%1f",	REG_READ_ONLY, NULL, NULL),
+	REG_DEF(pm.vsf_freq_low,,		"Hz",	"%1f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.vsf_rev_N,,			"",	"%1f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.vsf_load_i,,			"A",	"%3f",	REG_CONFIG, NULL, NULL),
+
 	REG_DEF(pm.fb_iA,,			"A",	"%3f",	REG_READ_ONLY, NULL, NULL),
 	REG_DEF(pm.fb_iB,,			"A",	"%3f",	REG_READ_ONLY, NULL, NULL),
 	REG_DEF(pm.fb_uA,,			"V",	"%3f",	REG_READ_ONLY, NULL, NULL),
@@ -755,6 +983,17 @@ const reg_t		regfile[] = {
 	REG_DEF(pm.flux_gain_LP_E,,		"",	"%2e",	REG_CONFIG, NULL, NULL),
 	REG_DEF(pm.flux_gain_SF,,		"",	"%2e",	REG_CONFIG, NULL, NULL),
 
+	REG_DEF(pm.ekf_F[0],,			"",	"%3f",	REG_READ_ONLY, NULL, NULL),
+	REG_DEF(pm.ekf_F[1],,			"",	"%3f",	REG_READ_ONLY, NULL, NULL),
+	REG_DEF(pm.ekf_F, g,			"g",	"%2f",	REG_READ_ONLY, &reg_proc_Fg, NULL),
+	REG_DEF(pm.ekf_wS,,		"rad/s",	"%2f",	REG_READ_ONLY, NULL, NULL),
+	REG_DEF(pm.ekf_wS, _rpm,		"rpm",	"%2f",	REG_READ_ONLY, &reg_proc_rpm, NULL),
+	REG_DEF(pm.ekf_wS, _kmh,		"km/h",	"%1f",	REG_READ_ONLY, &reg_proc_kmh, NULL),
+	REG_DEF(pm.ekf_gain_QI,,		"",	"%2e",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.ekf_gain_QS,,		"",	"%2e",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.ekf_gain_QF,,		"",	"%2e",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.ekf_gain_R,,			"",	"%2e",	REG_CONFIG, NULL, NULL),
+
 	REG_DEF(pm.inject_bias_U,,		"V",	"%3f",	REG_CONFIG, NULL, NULL),
 	REG_DEF(pm.inject_ratio_D,,		"",	"%2e",	REG_CONFIG, NULL, NULL),
 
@@ -826,6 +1065,73 @@ const reg_t		regfile[] = {
 	REG_DEF(pm.weak_D,,			"A",	"%3f",	REG_READ_ONLY, NULL, NULL),
 	REG_DEF(pm.weak_gain_EU,,		"",	"%2e",	REG_CONFIG, NULL, NULL),
 
+	REG_DEF(pm.cogg_T[0],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[1],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[2],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[3],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[4],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[5],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[6],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[7],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[8],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[9],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[10],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[11],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[12],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[13],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[14],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[15],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[16],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[17],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[18],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[19],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[20],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[21],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[22],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[23],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[24],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[25],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[26],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[27],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[28],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[29],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[30],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[31],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[32],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[33],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[34],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[35],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[36],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[37],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[38],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[39],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[40],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[41],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[42],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[43],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[44],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[45],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[46],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[47],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[48],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[49],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[50],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[51],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[52],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[53],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[54],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[55],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[56],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[57],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[58],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[59],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[60],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[61],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[62],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_T[63],,		"A",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_gain_LP,,		"",	"%2e",	REG_CONFIG, NULL, NULL),
+	REG_DEF(pm.cogg_gain_LE,,		"",	"%2e",	REG_CONFIG, NULL, NULL),
+
 	REG_DEF(pm.v_maximal,,			"V",	"%3f",	REG_CONFIG, NULL, NULL),
 	REG_DEF(pm.v_reverse,,			"V",	"%3f",	REG_CONFIG, NULL, NULL),
 
@@ -877,6 +1183,30 @@ const reg_t		regfile[] = {
 	REG_DEF(ti.reg_ID[7],,			"",	"%i",	REG_CONFIG | REG_LINKED, NULL, NULL),
 	REG_DEF(ti.reg_ID[8],,			"",	"%i",	REG_CONFIG | REG_LINKED, NULL, NULL),
 	REG_DEF(ti.reg_ID[9],,			"",	"%i",	REG_CONFIG | REG_LINKED, NULL, NULL),
+	REG_DEF(ti.div[0],,			"",	"%i",	REG_CONFIG, NULL, NULL),
+	REG_DEF(ti.div[1],,			"",	"%i",	REG_CONFIG, NULL, NULL),
+	REG_DEF(ti.div[2],,			"",	"%i",	REG_CONFIG, NULL, NULL),
+	REG_DEF(ti.div[3],,			"",	"%i",	REG_CONFIG, NULL, NULL),
+	REG_DEF(ti.div[4],,			"",	"%i",	REG_CONFIG, NULL, NULL),
+	REG_DEF(ti.div[5],,			"",	"%i",	REG_CONFIG, NULL, NULL),
+	REG_DEF(ti.div[6],,			"",	"%i",	REG_CONFIG, NULL, NULL),
+	REG_DEF(ti.div[7],,			"",	"%i",	REG_CONFIG, NULL, NULL),
+	REG_DEF(ti.div[8],,			"",	"%i",	REG_CONFIG, NULL, NULL),
+	REG_DEF(ti.div[9],,			"",	"%i",	REG_CONFIG, NULL, NULL),
+	REG_DEF(ti.agg[0],,			"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(ti.agg[1],,			"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(ti.agg[2],,			"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(ti.agg[3],,			"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(ti.agg[4],,			"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(ti.agg[5],,			"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(ti.agg[6],,			"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(ti.agg[7],,			"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(ti.agg[8],,			"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(ti.agg[9],,			"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(ti.tr_mode,,			"",	"%i",	REG_CONFIG, NULL, &reg_format_enum),
+	REG_DEF(ti.tr_reg_ID,,			"",	"%i",	REG_CONFIG | REG_LINKED, NULL, NULL),
+	REG_DEF(ti.tr_level,,			"",	"%3f",	REG_CONFIG, NULL, NULL),
+	REG_DEF(ti.tr_post,,			"",	"%i",	REG_CONFIG, NULL, NULL),
 
 	{ NULL, "", 0, NULL, NULL, NULL }
 };
@@ -903,6 +1233,70 @@ void reg_setval(const reg_t *reg, const void *rval)
 		else {
 			*reg->link = *(reg_val_t *) rval;
 		}
+
+		reg_mark_value((int) (reg - regfile));
+	}
+}
+
+int reg_grab_op(const reg_t *reg)
+{
+	int			op;
+
+	if (reg->proc == NULL) {
+
+		op = REG_GRAB_COPY;
+	}
+	else if (	   reg->proc == (void *) &reg_proc_pwm
+			|| reg->proc == (void *) &reg_proc_ppm
+			|| reg->proc == (void *) &reg_proc_tim
+			|| reg->proc == (void *) &reg_proc_rpm
+			|| reg->proc == (void *) &reg_proc_kmh
+			|| reg->proc == (void *) &reg_proc_rpm_pc
+			|| reg->proc == (void *) &reg_proc_Q_pc
+			|| reg->proc == (void *) &reg_proc_kv
+			|| reg->proc == (void *) &reg_proc_halt
+			|| reg->proc == (void *) &reg_proc_maximal_i
+			|| reg->proc == (void *) &reg_proc_reverse_i
+			|| reg->proc == (void *) &reg_proc_km) {
+
+		/* Unit conversion of the linked value only so we can
+		 * grab a raw value and convert it later.
+		 * */
+		op = REG_GRAB_CONVERT;
+	}
+	else if (reg->proc == (void *) &reg_proc_Fg) {
+
+		/* We pack the rotation vector into the single value.
+		 * */
+		op = REG_GRAB_ANGLE;
+	}
+	else {
+		op = REG_GRAB_PROC;
+	}
+
+	return op;
+}
+
+void reg_grab_value(const reg_t *reg, int op, void *lval, const reg_val_t *raw)
+{
+	reg_t			temp = *reg;
+	reg_val_t		F[2];
+
+	if (op == REG_GRAB_CONVERT) {
+
+		temp.link = (reg_val_t *) raw;
+		reg->proc(&temp, lval, NULL);
+	}
+	else if (op == REG_GRAB_ANGLE) {
+
+		F[0].f = (float) (short) (raw->i & 0xFFFF) * (1.f / 32767.f);
+		F[1].f = (float) (short) (raw->i >> 16) * (1.f / 32767.f);
+
+		temp.link = F;
+		reg->proc(&temp, lval, NULL);
+	}
+	else {
+		*(reg_val_t *) lval = *raw;
 	}
 }
 
@@ -960,6 +1354,51 @@ void reg_format(const reg_t *reg)
 	}
 }
 
+/* The index of registers sorted by name is generated by cgtool.
+ * */
+static const unsigned short	regidx[] = {
+
+#include "regidx.h"
+};
+
+#define REG_IDX_MAX			(int) (sizeof(regidx) / sizeof(regidx[0]))
+
+static int
+reg_lower_bound(const char *sym)
+{
+	int			L = 0, R = REG_IDX_MAX, M;
+
+	while (L < R) {
+
+		M = (L + R) / 2;
+
+		if (strcmp(regfile[regidx[M]].sym, sym) < 0)
+			L = M + 1;
+		else
+			R = M;
+	}
+
+	return L;
+}
+
+const reg_t *reg_search_prefix(const char *sym, int N)
+{
+	int			L;
+
+	/* All names with the same prefix are adjacent in the index so we get
+	 * N-th of them in name order.
+	 * */
+	L = reg_lower_bound(sym) + N;
+
+	if (N >= 0 && L < REG_IDX_MAX) {
+
+		if (strcmpe(sym, regfile[regidx[L]].sym) == 0)
+			return regfile + regidx[L];
+	}
+
+	return NULL;
+}
+
 const reg_t *reg_search(const char *sym)
 {
 	const reg_t		*reg, *found = NULL;
@@ -971,17 +1410,15 @@ const reg_t *reg_search(const char *sym)
 			found = regfile + n;
 	}
 	else {
-		for (reg = regfile; reg->sym != NULL; ++reg) {
+		n = reg_lower_bound(sym);
 
-			if (strcmp(reg->sym, sym) == 0) {
+		if (n < REG_IDX_MAX && strcmp(regfile[regidx[n]].sym, sym) == 0) {
 
-				found = reg;
-				break;
-			}
+			found = regfile + regidx[n];
 		}
-
-		if (found == NULL) {
-
+		else {
+			/* Unique substring.
+			 * */
 			for (reg = regfile; reg->sym != NULL; ++reg) {
 
 				if (strstr(reg->sym, sym) != NULL) {
@@ -1076,6 +1513,53 @@ SH_DEF(reg)
 	}
 }
 
+static reg_sub_t	reg_sub_watch;
+
+void task_WATCH(void *pData)
+{
+	reg_sub_t		*sub = (reg_sub_t *) pData;
+	int			ID;
+
+	do {
+		/* 10 Hz.
+		 * */
+		vTaskDelay((TickType_t) 100);
+
+		reg_sub_scan(sub);
+
+		while ((ID = reg_sub_next(sub)) >= 0)
+			reg_format(regfile + ID);
+	}
+	while (1);
+}
+
+SH_DEF(reg_watch)
+{
+	TaskHandle_t		xHandle;
+	const reg_t		*reg;
+
+	if (reg_subscribe(&reg_sub_watch) == 0)
+		return ;
+
+	/* Each argument is a pattern as in reg command.
+	 * */
+	for (; *s != 0; s = sh_next_arg(s)) {
+
+		for (reg = regfile; reg->sym != NULL; ++reg) {
+
+			if (strstr(reg->sym, s) != NULL)
+				reg_sub_add(&reg_sub_watch, (int) (reg - regfile));
+		}
+	}
+
+	xTaskCreate(task_WATCH, "WATCH", configMINIMAL_STACK_SIZE, (void *) &reg_sub_watch, 1, &xHandle);
+
+	getc();
+
+	vTaskDelete(xHandle);
+	reg_unsubscribe(&reg_sub_watch);
+}
+
 SH_DEF(reg_export)
 {
 	reg_val_t		rval;
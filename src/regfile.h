@@ -1,7 +1,10 @@
 #ifndef _H_REGFILE_
 #define _H_REGFILE_
 
-#define REG_CONFIG_VERSION		54
+#define REG_CONFIG_VERSION		62
+
+#define REG_SUB_MAX			4
+#define REG_BITMAP_N			((REG_ID_MAX + 31) / 32)
 
 enum {
 	REG_CONFIG		= 1,
@@ -11,6 +14,15 @@ enum {
 
 enum {
 #include "regdefs.h"
+
+	REG_ID_MAX
+};
+
+enum {
+	REG_GRAB_COPY		= 0,
+	REG_GRAB_CONVERT,
+	REG_GRAB_ANGLE,
+	REG_GRAB_PROC
 };
 
 typedef union {
@@ -33,13 +45,36 @@ typedef struct {
 }
 reg_t;
 
+typedef struct {
+
+	/* Subscribed and changed registers.
+	 * */
+	unsigned long		mask[REG_BITMAP_N];
+	unsigned long		dirty[REG_BITMAP_N];
+}
+reg_sub_t;
+
 extern const reg_t	regfile[];
 
 void reg_getval(const reg_t *reg, void *lval);
 void reg_setval(const reg_t *reg, const void *rval);
 void reg_format_rval(const reg_t *reg, const void *rval);
+
+int reg_grab_op(const reg_t *reg);
+void reg_grab_value(const reg_t *reg, int op, void *lval, const reg_val_t *raw);
+
 void reg_format(const reg_t *reg);
 const reg_t *reg_search(const char *sym);
+const reg_t *reg_search_prefix(const char *sym, int N);
+
+int reg_subscribe(reg_sub_t *sub);
+void reg_unsubscribe(reg_sub_t *sub);
+void reg_sub_add(reg_sub_t *sub, int ID);
+void reg_sub_scan(reg_sub_t *sub);
+int reg_sub_next(reg_sub_t *sub);
+void reg_mark(int ID);
+void reg_mark_value(int ID);
+void reg_mark_state();
 
 void reg_GET(int n, void *lval);
 void reg_SET(int n, const void *rval);
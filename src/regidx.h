@@ -0,0 +1,483 @@
+ID_AP_ANALOG_CONTROL_ANALOG_0,
+ID_AP_ANALOG_CONTROL_ANALOG_1,
+ID_AP_ANALOG_CONTROL_ANALOG_2,
+ID_AP_ANALOG_CONTROL_BRAKE_0,
+ID_AP_ANALOG_CONTROL_BRAKE_1,
+ID_AP_ANALOG_CONTROL_BRAKE_2,
+ID_AP_ANALOG_ENABLED,
+ID_AP_ANALOG_REG_ID,
+ID_AP_ANALOG_STARTUP_RANGE_0,
+ID_AP_ANALOG_STARTUP_RANGE_1,
+ID_AP_ANALOG_TIMEOUT,
+ID_AP_ANALOG_VOLTAGE_ANALOG_0,
+ID_AP_ANALOG_VOLTAGE_ANALOG_1,
+ID_AP_ANALOG_VOLTAGE_ANALOG_2,
+ID_AP_ANALOG_VOLTAGE_BRAKE_0,
+ID_AP_ANALOG_VOLTAGE_BRAKE_1,
+ID_AP_ANALOG_VOLTAGE_BRAKE_2,
+ID_AP_ANALOG_VOLTAGE_LOST_0,
+ID_AP_ANALOG_VOLTAGE_LOST_1,
+ID_AP_ANALOG_VOLTAGE_RATIO,
+ID_AP_CAN_NODE_ID,
+ID_AP_CAN_STATE_RATE,
+ID_AP_HEAT_EXT,
+ID_AP_HEAT_EXT_DERATED_I,
+ID_AP_HEAT_PCB,
+ID_AP_HEAT_PCB_FAN,
+ID_AP_HEAT_PCB_DERATED_I,
+ID_AP_HEAT_GAP,
+ID_AP_NTC_EXT_BETTA,
+ID_AP_NTC_EXT_R_BALANCE,
+ID_AP_NTC_EXT_R_NTC_0,
+ID_AP_NTC_EXT_TA_0,
+ID_AP_NTC_PCB_BETTA,
+ID_AP_NTC_PCB_R_BALANCE,
+ID_AP_NTC_PCB_R_NTC_0,
+ID_AP_NTC_PCB_TA_0,
+ID_AP_PPM_CONTROL_RANGE_0,
+ID_AP_PPM_CONTROL_RANGE_1,
+ID_AP_PPM_CONTROL_RANGE_2,
+ID_AP_PPM_PULSE_LOST_0,
+ID_AP_PPM_PULSE_LOST_1,
+ID_AP_PPM_PULSE_RANGE_0,
+ID_AP_PPM_PULSE_RANGE_1,
+ID_AP_PPM_PULSE_RANGE_2,
+ID_AP_PPM_REG_ID,
+ID_AP_PPM_STARTUP_RANGE_0,
+ID_AP_PPM_STARTUP_RANGE_1,
+ID_AP_PROF_ADC_IRQ_MAX,
+ID_AP_PROF_ADC_IRQ_MEAN,
+ID_AP_PROF_ADC_IRQ_MIN,
+ID_AP_PROF_ADC_IRQ_PC,
+ID_AP_PROF_PM_FSM_MAX,
+ID_AP_PROF_PM_FSM_MEAN,
+ID_AP_PROF_PM_FSM_MIN,
+ID_AP_PROF_PM_INPUT_MAX,
+ID_AP_PROF_PM_INPUT_MEAN,
+ID_AP_PROF_PM_INPUT_MIN,
+ID_AP_PROF_PM_LOOP_MAX,
+ID_AP_PROF_PM_LOOP_MEAN,
+ID_AP_PROF_PM_LOOP_MIN,
+ID_AP_PROF_PM_OBSERVER_MAX,
+ID_AP_PROF_PM_OBSERVER_MEAN,
+ID_AP_PROF_PM_OBSERVER_MIN,
+ID_AP_PROF_TEL_GRAB_MAX,
+ID_AP_PROF_TEL_GRAB_MEAN,
+ID_AP_PROF_TEL_GRAB_MIN,
+ID_AP_PULL_AD_0,
+ID_AP_PULL_AD_1,
+ID_AP_PULL_G,
+ID_AP_TASK_0_LOAD_10S,
+ID_AP_TASK_0_LOAD_1S,
+ID_AP_TASK_0_STACK_FREE,
+ID_AP_TASK_0_SWITCH_N,
+ID_AP_TASK_10_LOAD_10S,
+ID_AP_TASK_10_LOAD_1S,
+ID_AP_TASK_10_STACK_FREE,
+ID_AP_TASK_10_SWITCH_N,
+ID_AP_TASK_11_LOAD_10S,
+ID_AP_TASK_11_LOAD_1S,
+ID_AP_TASK_11_STACK_FREE,
+ID_AP_TASK_11_SWITCH_N,
+ID_AP_TASK_1_LOAD_10S,
+ID_AP_TASK_1_LOAD_1S,
+ID_AP_TASK_1_STACK_FREE,
+ID_AP_TASK_1_SWITCH_N,
+ID_AP_TASK_2_LOAD_10S,
+ID_AP_TASK_2_LOAD_1S,
+ID_AP_TASK_2_STACK_FREE,
+ID_AP_TASK_2_SWITCH_N,
+ID_AP_TASK_3_LOAD_10S,
+ID_AP_TASK_3_LOAD_1S,
+ID_AP_TASK_3_STACK_FREE,
+ID_AP_TASK_3_SWITCH_N,
+ID_AP_TASK_4_LOAD_10S,
+ID_AP_TASK_4_LOAD_1S,
+ID_AP_TASK_4_STACK_FREE,
+ID_AP_TASK_4_SWITCH_N,
+ID_AP_TASK_5_LOAD_10S,
+ID_AP_TASK_5_LOAD_1S,
+ID_AP_TASK_5_STACK_FREE,
+ID_AP_TASK_5_SWITCH_N,
+ID_AP_TASK_6_LOAD_10S,
+ID_AP_TASK_6_LOAD_1S,
+ID_AP_TASK_6_STACK_FREE,
+ID_AP_TASK_6_SWITCH_N,
+ID_AP_TASK_7_LOAD_10S,
+ID_AP_TASK_7_LOAD_1S,
+ID_AP_TASK_7_STACK_FREE,
+ID_AP_TASK_7_SWITCH_N,
+ID_AP_TASK_8_LOAD_10S,
+ID_AP_TASK_8_LOAD_1S,
+ID_AP_TASK_8_STACK_FREE,
+ID_AP_TASK_8_SWITCH_N,
+ID_AP_TASK_9_LOAD_10S,
+ID_AP_TASK_9_LOAD_1S,
+ID_AP_TASK_9_STACK_FREE,
+ID_AP_TASK_9_SWITCH_N,
+ID_AP_TEMP_EXT,
+ID_AP_TEMP_INT,
+ID_AP_TEMP_PCB,
+ID_HAL_ADC_AMPLIFIER_GAIN,
+ID_HAL_ADC_REFERENCE_VOLTAGE,
+ID_HAL_ADC_SHUNT_RESISTANCE,
+ID_HAL_ADC_TERMINAL_BIAS,
+ID_HAL_ADC_TERMINAL_RATIO,
+ID_HAL_ADC_VOLTAGE_RATIO,
+ID_HAL_CAN_OVERRUN_N,
+ID_HAL_CAN_RING_OVERFLOW_N,
+ID_HAL_CAN_RING_PEAK_N,
+ID_HAL_CAN_TX_RING_0_OVERFLOW_N,
+ID_HAL_CAN_TX_RING_0_PEAK_N,
+ID_HAL_CAN_TX_RING_1_OVERFLOW_N,
+ID_HAL_CAN_TX_RING_1_PEAK_N,
+ID_HAL_CAN_TX_RING_2_OVERFLOW_N,
+ID_HAL_CAN_TX_RING_2_PEAK_N,
+ID_HAL_HSE_CRYSTAL_CLOCK,
+ID_HAL_PPM_MODE,
+ID_HAL_PPM_SIGNAL_CAUGHT,
+ID_HAL_PPM_TIMEBASE,
+ID_HAL_PWM_DEADTIME,
+ID_HAL_PWM_DUAL,
+ID_HAL_PWM_FREQUENCY,
+ID_HAL_TIM_MODE,
+ID_HAL_USART_BAUD_RATE,
+ID_NULL,
+ID_PM_AD_IA_0,
+ID_PM_AD_IA_1,
+ID_PM_AD_IB_0,
+ID_PM_AD_IB_1,
+ID_PM_AD_UA_0,
+ID_PM_AD_UA_1,
+ID_PM_AD_UB_0,
+ID_PM_AD_UB_1,
+ID_PM_AD_UC_0,
+ID_PM_AD_UC_1,
+ID_PM_AD_US_0,
+ID_PM_AD_US_1,
+ID_PM_COGG_T_0,
+ID_PM_COGG_T_10,
+ID_PM_COGG_T_11,
+ID_PM_COGG_T_12,
+ID_PM_COGG_T_13,
+ID_PM_COGG_T_14,
+ID_PM_COGG_T_15,
+ID_PM_COGG_T_16,
+ID_PM_COGG_T_17,
+ID_PM_COGG_T_18,
+ID_PM_COGG_T_19,
+ID_PM_COGG_T_1,
+ID_PM_COGG_T_20,
+ID_PM_COGG_T_21,
+ID_PM_COGG_T_22,
+ID_PM_COGG_T_23,
+ID_PM_COGG_T_24,
+ID_PM_COGG_T_25,
+ID_PM_COGG_T_26,
+ID_PM_COGG_T_27,
+ID_PM_COGG_T_28,
+ID_PM_COGG_T_29,
+ID_PM_COGG_T_2,
+ID_PM_COGG_T_30,
+ID_PM_COGG_T_31,
+ID_PM_COGG_T_32,
+ID_PM_COGG_T_33,
+ID_PM_COGG_T_34,
+ID_PM_COGG_T_35,
+ID_PM_COGG_T_36,
+ID_PM_COGG_T_37,
+ID_PM_COGG_T_38,
+ID_PM_COGG_T_39,
+ID_PM_COGG_T_3,
+ID_PM_COGG_T_40,
+ID_PM_COGG_T_41,
+ID_PM_COGG_T_42,
+ID_PM_COGG_T_43,
+ID_PM_COGG_T_44,
+ID_PM_COGG_T_45,
+ID_PM_COGG_T_46,
+ID_PM_COGG_T_47,
+ID_PM_COGG_T_48,
+ID_PM_COGG_T_49,
+ID_PM_COGG_T_4,
+ID_PM_COGG_T_50,
+ID_PM_COGG_T_51,
+ID_PM_COGG_T_52,
+ID_PM_COGG_T_53,
+ID_PM_COGG_T_54,
+ID_PM_COGG_T_55,
+ID_PM_COGG_T_56,
+ID_PM_COGG_T_57,
+ID_PM_COGG_T_58,
+ID_PM_COGG_T_59,
+ID_PM_COGG_T_5,
+ID_PM_COGG_T_60,
+ID_PM_COGG_T_61,
+ID_PM_COGG_T_62,
+ID_PM_COGG_T_63,
+ID_PM_COGG_T_6,
+ID_PM_COGG_T_7,
+ID_PM_COGG_T_8,
+ID_PM_COGG_T_9,
+ID_PM_COGG_GAIN_LE,
+ID_PM_COGG_GAIN_LP,
+ID_PM_CONFIG_COGG,
+ID_PM_CONFIG_DRIFT,
+ID_PM_CONFIG_DRIVE,
+ID_PM_CONFIG_EKF,
+ID_PM_CONFIG_HFI,
+ID_PM_CONFIG_NOP,
+ID_PM_CONFIG_SENSOR,
+ID_PM_CONFIG_SERVO,
+ID_PM_CONFIG_STAT,
+ID_PM_CONFIG_TVM,
+ID_PM_CONFIG_VSF,
+ID_PM_CONFIG_WEAK,
+ID_PM_CONST_E,
+ID_PM_CONST_E_KV,
+ID_PM_CONST_J,
+ID_PM_CONST_L,
+ID_PM_CONST_R,
+ID_PM_CONST_ZP,
+ID_PM_CONST_DD_T,
+ID_PM_CONST_GAIN_LP_U,
+ID_PM_CONST_IM_B,
+ID_PM_CONST_IM_LD,
+ID_PM_CONST_IM_LQ,
+ID_PM_CONST_IM_R,
+ID_PM_CONST_LPF_U,
+ID_PM_DC_CLEARANCE,
+ID_PM_DC_MINIMAL,
+ID_PM_DC_RESOLUTION,
+ID_PM_DC_TM_HOLD,
+ID_PM_DRIFT_IA,
+ID_PM_DRIFT_IB,
+ID_PM_DRIFT_GAIN_LP,
+ID_PM_DRIFT_SLEW,
+ID_PM_EKF_F_0,
+ID_PM_EKF_F_1,
+ID_PM_EKF_FG,
+ID_PM_EKF_GAIN_QF,
+ID_PM_EKF_GAIN_QI,
+ID_PM_EKF_GAIN_QS,
+ID_PM_EKF_GAIN_R,
+ID_PM_EKF_WS,
+ID_PM_EKF_WS_KMH,
+ID_PM_EKF_WS_RPM,
+ID_PM_FAIL_REASON,
+ID_PM_FAULT_ACCURACY_TOL,
+ID_PM_FAULT_CURRENT_HALT,
+ID_PM_FAULT_CURRENT_TOL,
+ID_PM_FAULT_FLUX_LPFE_HALT,
+ID_PM_FAULT_VOLTAGE_HALT,
+ID_PM_FAULT_VOLTAGE_TOL,
+ID_PM_FB_HS,
+ID_PM_FB_IA,
+ID_PM_FB_IB,
+ID_PM_FB_UA,
+ID_PM_FB_UB,
+ID_PM_FB_UC,
+ID_PM_FLUX_E,
+ID_PM_FLUX_F_0,
+ID_PM_FLUX_F_1,
+ID_PM_FLUX_FG,
+ID_PM_FLUX_H,
+ID_PM_FLUX_N,
+ID_PM_FLUX_GAIN_HI,
+ID_PM_FLUX_GAIN_IN,
+ID_PM_FLUX_GAIN_LO,
+ID_PM_FLUX_GAIN_LP_E,
+ID_PM_FLUX_GAIN_SF,
+ID_PM_FLUX_LOWER_R,
+ID_PM_FLUX_LPF_E,
+ID_PM_FLUX_TRANSIENT_S,
+ID_PM_FLUX_UPPER_R,
+ID_PM_FLUX_WS,
+ID_PM_FLUX_WS_KMH,
+ID_PM_FLUX_WS_RPM,
+ID_PM_FORCED_ACCEL,
+ID_PM_FORCED_ACCEL_RPM,
+ID_PM_FORCED_HOLD_D,
+ID_PM_FORCED_MAXIMAL,
+ID_PM_FORCED_MAXIMAL_RPM,
+ID_PM_FORCED_REVERSE,
+ID_PM_FORCED_REVERSE_RPM,
+ID_PM_FSM_PHASE,
+ID_PM_FSM_REQ,
+ID_PM_FSM_STATE,
+ID_PM_HALL_AT_1,
+ID_PM_HALL_AT_2,
+ID_PM_HALL_AT_3,
+ID_PM_HALL_AT_4,
+ID_PM_HALL_AT_5,
+ID_PM_HALL_AT_6,
+ID_PM_HALL_F_0,
+ID_PM_HALL_F_1,
+ID_PM_HALL_FG,
+ID_PM_HALL_TIM,
+ID_PM_HALL_WS,
+ID_PM_HALL_WS_KMH,
+ID_PM_HALL_WS_RPM,
+ID_PM_HFI_F_0,
+ID_PM_HFI_F_1,
+ID_PM_HFI_FG,
+ID_PM_HFI_DERATED_I,
+ID_PM_HFI_FREQ_HZ,
+ID_PM_HFI_GAIN_EP,
+ID_PM_HFI_GAIN_FP,
+ID_PM_HFI_GAIN_SF,
+ID_PM_HFI_POLARITY,
+ID_PM_HFI_SWING_D,
+ID_PM_HFI_WS,
+ID_PM_HFI_WS_KMH,
+ID_PM_HFI_WS_RPM,
+ID_PM_I_DERATED_1,
+ID_PM_I_GAIN_I,
+ID_PM_I_GAIN_P,
+ID_PM_I_MAXIMAL,
+ID_PM_I_REVERSE,
+ID_PM_I_SETPOINT_D,
+ID_PM_I_SETPOINT_Q,
+ID_PM_I_SETPOINT_Q_PC,
+ID_PM_INJECT_BIAS_U,
+ID_PM_INJECT_RATIO_D,
+ID_PM_LU_F_0,
+ID_PM_LU_F_1,
+ID_PM_LU_FG,
+ID_PM_LU_GAIN_LP_S,
+ID_PM_LU_ID,
+ID_PM_LU_IQ,
+ID_PM_LU_IX,
+ID_PM_LU_IY,
+ID_PM_LU_LOCK_S,
+ID_PM_LU_LPF_WS,
+ID_PM_LU_LPF_WS_KMH,
+ID_PM_LU_LPF_WS_RPM,
+ID_PM_LU_MODE,
+ID_PM_LU_UNLOCK_S,
+ID_PM_LU_WS,
+ID_PM_LU_WS_KMH,
+ID_PM_LU_WS_RPM,
+ID_PM_PROBE_CURRENT_BIAS_Q,
+ID_PM_PROBE_CURRENT_HOLD,
+ID_PM_PROBE_CURRENT_SINE,
+ID_PM_PROBE_FREQ_SINE_HZ,
+ID_PM_PROBE_GAIN_I,
+ID_PM_PROBE_GAIN_P,
+ID_PM_PROBE_SPEED_HOLD,
+ID_PM_PROBE_SPEED_HOLD_RPM,
+ID_PM_S_ACCEL,
+ID_PM_S_ACCEL_KMH,
+ID_PM_S_ACCEL_RPM,
+ID_PM_S_GAIN_HF_S,
+ID_PM_S_GAIN_LP_I,
+ID_PM_S_GAIN_P,
+ID_PM_S_MAXIMAL,
+ID_PM_S_MAXIMAL_KMH,
+ID_PM_S_MAXIMAL_RPM,
+ID_PM_S_REVERSE,
+ID_PM_S_REVERSE_KMH,
+ID_PM_S_REVERSE_RPM,
+ID_PM_S_SETPOINT,
+ID_PM_S_SETPOINT_KMH,
+ID_PM_S_SETPOINT_PC,
+ID_PM_S_SETPOINT_RPM,
+ID_PM_SELF_BM,
+ID_PM_SELF_RMS,
+ID_PM_STAT_CAPACITY_AH,
+ID_PM_STAT_CONSUMED_AH,
+ID_PM_STAT_CONSUMED_WH,
+ID_PM_STAT_DISTANCE,
+ID_PM_STAT_DISTANCE_KM,
+ID_PM_STAT_FUEL_PC,
+ID_PM_STAT_PEAK_CONSUMED_WATT,
+ID_PM_STAT_PEAK_REVERTED_WATT,
+ID_PM_STAT_PEAK_SPEED,
+ID_PM_STAT_PEAK_SPEED_KMH,
+ID_PM_STAT_PEAK_SPEED_RPM,
+ID_PM_STAT_REVERTED_AH,
+ID_PM_STAT_REVERTED_WH,
+ID_PM_STAT_REVOL_TOTAL,
+ID_PM_TM_AVERAGE_DRIFT,
+ID_PM_TM_AVERAGE_PROBE,
+ID_PM_TM_CURRENT_HOLD,
+ID_PM_TM_INSTANT_PROBE,
+ID_PM_TM_STARTUP,
+ID_PM_TM_TRANSIENT_FAST,
+ID_PM_TM_TRANSIENT_SLOW,
+ID_PM_TM_VOLTAGE_HOLD,
+ID_PM_TVM_A,
+ID_PM_TVM_B,
+ID_PM_TVM_C,
+ID_PM_TVM_DX,
+ID_PM_TVM_DY,
+ID_PM_TVM_FIR_A,
+ID_PM_TVM_FIR_B,
+ID_PM_TVM_FIR_C,
+ID_PM_TVM_RANGE,
+ID_PM_V_MAXIMAL,
+ID_PM_V_REVERSE,
+ID_PM_VSF_FREQ_BASE,
+ID_PM_VSF_FREQ_LOW,
+ID_PM_VSF_LOAD_I,
+ID_PM_VSF_REV_N,
+ID_PM_VSI_DX,
+ID_PM_VSI_DY,
+ID_PM_VSI_IF,
+ID_PM_VSI_UF,
+ID_PM_VSI_X,
+ID_PM_VSI_Y,
+ID_PM_WATT_DCLINK_HI,
+ID_PM_WATT_DCLINK_LO,
+ID_PM_WATT_GAIN_LP_F,
+ID_PM_WATT_GAIN_LP_P,
+ID_PM_WATT_IB_MAXIMAL,
+ID_PM_WATT_IB_REVERSE,
+ID_PM_WATT_LPF_D,
+ID_PM_WATT_LPF_Q,
+ID_PM_WATT_LPF_WP,
+ID_PM_WATT_WP_MAXIMAL,
+ID_PM_WATT_WP_REVERSE,
+ID_PM_WEAK_D,
+ID_PM_WEAK_BIAS_U,
+ID_PM_WEAK_GAIN_EU,
+ID_PM_WEAK_MAXIMAL,
+ID_PM_X_GAIN_N,
+ID_PM_X_GAIN_P,
+ID_PM_X_NEAR_EP,
+ID_PM_X_SETPOINT_F,
+ID_PM_X_SETPOINT_FG,
+ID_TI_AGG_0,
+ID_TI_AGG_1,
+ID_TI_AGG_2,
+ID_TI_AGG_3,
+ID_TI_AGG_4,
+ID_TI_AGG_5,
+ID_TI_AGG_6,
+ID_TI_AGG_7,
+ID_TI_AGG_8,
+ID_TI_AGG_9,
+ID_TI_DIV_0,
+ID_TI_DIV_1,
+ID_TI_DIV_2,
+ID_TI_DIV_3,
+ID_TI_DIV_4,
+ID_TI_DIV_5,
+ID_TI_DIV_6,
+ID_TI_DIV_7,
+ID_TI_DIV_8,
+ID_TI_DIV_9,
+ID_TI_REG_ID_0,
+ID_TI_REG_ID_1,
+ID_TI_REG_ID_2,
+ID_TI_REG_ID_3,
+ID_TI_REG_ID_4,
+ID_TI_REG_ID_5,
+ID_TI_REG_ID_6,
+ID_TI_REG_ID_7,
+ID_TI_REG_ID_8,
+ID_TI_REG_ID_9,
+ID_TI_TR_LEVEL,
+ID_TI_TR_MODE,
+ID_TI_TR_POST,
+ID_TI_TR_REG_ID,
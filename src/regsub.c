@@ -0,0 +1,192 @@
+#include <stddef.h>
+
+#include "hal/hal.h"
+
+#include "libc.h"
+#include "regfile.h"
+
+#define REG_BIT(ID)			(1UL << ((ID) & 31))
+
+static reg_sub_t	*reg_sub[REG_SUB_MAX];
+static int		reg_sub_N;
+static reg_val_t	reg_last[REG_ID_MAX];
+
+static const int	reg_state_ID[] = {
+
+	ID_PM_FSM_STATE,
+	ID_PM_FAIL_REASON,
+	ID_PM_LU_MODE
+};
+
+void reg_mark(int ID)
+{
+	reg_sub_t		*sub;
+	int			N, irq;
+
+	/* We can be called from IRQ as well.
+	 * */
+	irq = hal_lock_irq();
+
+	for (N = 0; N < REG_SUB_MAX; ++N) {
+
+		sub = reg_sub[N];
+
+		if (sub != NULL && (sub->mask[ID / 32] & REG_BIT(ID)) != 0)
+			sub->dirty[ID / 32] |= REG_BIT(ID);
+	}
+
+	hal_unlock_irq(irq);
+}
+
+void reg_mark_state()
+{
+	const reg_t		*reg;
+	int			N, ID;
+
+	if (reg_sub_N != 0) {
+
+		/* State is changed from IRQ and may return back before
+		 * the next scan so we track it at the PWM rate.
+		 * */
+		for (N = 0; N < sizeof(reg_state_ID) / sizeof(int); ++N) {
+
+			ID = reg_state_ID[N];
+			reg = regfile + ID;
+
+			if (reg->link->i != reg_last[ID].i) {
+
+				reg_last[ID] = *reg->link;
+				reg_mark(ID);
+			}
+		}
+	}
+}
+
+void reg_mark_value(int ID)
+{
+	if (reg_sub_N != 0) {
+
+		/* Take the snapshot so scan does not report the change
+		 * twice.
+		 * */
+		reg_getval(regfile + ID, &reg_last[ID]);
+		reg_mark(ID);
+	}
+}
+
+int reg_subscribe(reg_sub_t *sub)
+{
+	int			N, irq, rc = 0;
+
+	memset(sub, 0, sizeof(reg_sub_t));
+
+	irq = hal_lock_irq();
+
+	for (N = 0; N < REG_SUB_MAX; ++N) {
+
+		if (reg_sub[N] == NULL) {
+
+			reg_sub[N] = sub;
+			reg_sub_N++;
+
+			rc = 1;
+			break;
+		}
+	}
+
+	hal_unlock_irq(irq);
+
+	return rc;
+}
+
+void reg_unsubscribe(reg_sub_t *sub)
+{
+	int			N, irq;
+
+	irq = hal_lock_irq();
+
+	for (N = 0; N < REG_SUB_MAX; ++N) {
+
+		if (reg_sub[N] == sub) {
+
+			reg_sub[N] = NULL;
+			reg_sub_N--;
+		}
+	}
+
+	hal_unlock_irq(irq);
+}
+
+void reg_sub_add(reg_sub_t *sub, int ID)
+{
+	int			irq;
+
+	if (ID >= 0 && ID < REG_ID_MAX) {
+
+		irq = hal_lock_irq();
+
+		/* Current value is reported at first.
+		 * */
+		sub->mask[ID / 32] |= REG_BIT(ID);
+		sub->dirty[ID / 32] |= REG_BIT(ID);
+
+		hal_unlock_irq(irq);
+	}
+}
+
+void reg_sub_scan(reg_sub_t *sub)
+{
+	reg_val_t		rval;
+	unsigned long		mask;
+	int			N, ID;
+
+	/* Registers that are changed not by reg_setval (state variables
+	 * and virtual registers) are detected by value.
+	 * */
+	for (N = 0; N < REG_BITMAP_N; ++N) {
+
+		mask = sub->mask[N];
+
+		for (ID = N * 32; mask != 0; ++ID, mask >>= 1) {
+
+			if ((mask & 1UL) != 0) {
+
+				reg_getval(regfile + ID, &rval);
+
+				if (rval.i != reg_last[ID].i) {
+
+					reg_last[ID] = rval;
+					reg_mark(ID);
+				}
+			}
+		}
+	}
+}
+
+int reg_sub_next(reg_sub_t *sub)
+{
+	unsigned long		dirty;
+	int			N, ID, irq;
+
+	for (N = 0; N < REG_BITMAP_N; ++N) {
+
+		dirty = sub->dirty[N];
+
+		if (dirty != 0) {
+
+			for (ID = N * 32; (dirty & 1UL) == 0; ++ID)
+				dirty >>= 1;
+
+			irq = hal_lock_irq();
+
+			sub->dirty[N] &= ~REG_BIT(ID);
+
+			hal_unlock_irq(irq);
+
+			return ID;
+		}
+	}
+
+	return -1;
+}
+
@@ -1,8 +1,12 @@
 SH_DEF(flash_write)
 SH_DEF(flash_info_map)
 SH_DEF(flash_cleanup)
+SH_DEF(ifcan_info)
 SH_DEF(rtos_uptime)
 SH_DEF(rtos_cpu_usage)
+SH_DEF(rtos_prof)
+SH_DEF(rtos_prof_hist)
+SH_DEF(rtos_prof_reset)
 SH_DEF(rtos_list)
 SH_DEF(rtos_kill)
 SH_DEF(rtos_heap)
@@ -36,12 +40,18 @@ SH_DEF(hal_GPIO_set_low_FAN)
 SH_DEF(hal_GPIO_set_high_LED)
 SH_DEF(hal_GPIO_set_low_LED)
 SH_DEF(reg)
+SH_DEF(reg_watch)
 SH_DEF(reg_export)
 SH_DEF(shell_keycodes)
 SH_DEF(tel_grab)
+SH_DEF(tel_pack_grab)
+SH_DEF(tel_trigger)
 SH_DEF(tel_stop)
 SH_DEF(tel_flush_sync)
+SH_DEF(tel_pack_dump)
 SH_DEF(tel_live_sync)
+SH_DEF(tel_flush_frame)
+SH_DEF(tel_live_frame)
 SH_DEF(ap_hx711_startup)
 SH_DEF(ap_hx711_halt)
 SH_DEF(ap_hx711_adjust)
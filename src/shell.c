@@ -2,6 +2,8 @@
 
 #include "shell.h"
 #include "libc.h"
+#include "regbin.h"
+#include "regfile.h"
 
 #define SH_CLINE_SZ			84
 #define SH_HISTORY_SZ			440
@@ -29,6 +31,7 @@ typedef struct {
 	/* Completion block.
 	 * */
 	int		mCOMP, cEON, cNUM;
+	int		cARG, cMAX;
 
 	/* History block.
 	 * */
@@ -182,6 +185,75 @@ sh_common_match(sh_t *sh)
 		sh->cEON = 0;
 }
 
+static void
+sh_reg_cyclic_match(sh_t *sh, int xDIR)
+{
+	const reg_t		*reg;
+	char			*s;
+
+	s = sh->cLINE + sh->cARG;
+	sh->cLINE[sh->cEON] = 0;
+
+	sh->cNUM += (xDIR == DIR_UP) ? 1 : - 1;
+
+	sh->cNUM = (sh->cNUM < 0) ? sh->cMAX - 1
+		: (sh->cNUM >= sh->cMAX) ? 0 : sh->cNUM;
+
+	reg = reg_search_prefix(s, sh->cNUM);
+
+	if (reg != NULL) {
+
+		/* Copy the register name.
+		 * */
+		strcpyn(s, reg->sym, (SH_CLINE_SZ - 2 - sh->cARG));
+	}
+}
+
+static void
+sh_reg_common_match(sh_t *sh)
+{
+	const reg_t		*reg;
+	const char		*id, *sp;
+	char			*s;
+	int			n;
+
+	s = sh->cLINE + sh->cARG;
+	sp = NULL;
+
+	sh->cNUM = 0;
+
+	do {
+		/* All registers with the same prefix are adjacent in name
+		 * order so we walk them through the index.
+		 * */
+		reg = reg_search_prefix(s, sh->cNUM);
+
+		if (reg == NULL)
+			break;
+
+		id = reg->sym;
+
+		n = (sp != NULL) ? strcmpn(sp, id, n) : strlen(id);
+		sp = id;
+
+		sh->cNUM++;
+	}
+	while (1);
+
+	sh->cMAX = sh->cNUM;
+
+	if (sp != NULL) {
+
+		if (n > (SH_CLINE_SZ - 2 - sh->cARG))
+			n = (SH_CLINE_SZ - 2 - sh->cARG);
+
+		strcpyn(s, sp, n);
+		sh->cEON = sh->cARG + n;
+	}
+	else
+		sh->cEON = sh->cARG;
+}
+
 static int
 sh_history_move(sh_t *sh, int xNUM, int xDIR)
 {
@@ -347,19 +419,32 @@ sh_complete(sh_t *sh, int xDIR)
 {
 	const char		space = ' ';
 	char			*s;
+	int			n;
 
 	if (sh->mCOMP == 0) {
 
 		s = sh->cLINE;
 
+		/* Command name is completed in the first word and register
+		 * name in any of the next words.
+		 * */
+		for (n = 0, sh->cARG = 0; s[n] != 0; ++n) {
+
+			if (s[n] == space)
+				sh->cARG = n + 1;
+		}
+
 		/* Do not complete with trailing spaces.
 		 * */
-		if (strchr(s, space) != NULL)
+		if (sh->cARG != 0 && sh->cARG == sh->cEOL)
 			return ;
 
 		/* Complete to the common substring.
 		 * */
-		sh_common_match(sh);
+		if (sh->cARG == 0)
+			sh_common_match(sh);
+		else
+			sh_reg_common_match(sh);
 		puts(sh->cLINE + sh->cEOL);
 
 		if (sh->cNUM == 1) {
@@ -394,7 +479,10 @@ sh_complete(sh_t *sh, int xDIR)
 	else {
 		/* Search for the next match.
 		 * */
-		sh_cyclic_match(sh, xDIR);
+		if (sh->cARG == 0)
+			sh_cyclic_match(sh, xDIR);
+		else
+			sh_reg_cyclic_match(sh, xDIR);
 
 		/* Update the command line.
 		 * */
@@ -572,6 +660,12 @@ void task_SH(void *pData)
 
 				sh->xESC = 1;
 			}
+			else if (c == K_NUL) {
+
+				/* Binary frame of register protocol.
+				 * */
+				regbin_frame();
+			}
 		}
 		else {
 			switch (sh->xESC) {
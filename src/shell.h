@@ -1,6 +1,7 @@
 #ifndef _H_SHELL_
 #define _H_SHELL_
 
+#define K_NUL			0x00
 #define K_ETX			0x03	/* Ctrl + C */
 #define K_EOT			0x04	/* Ctrl + D */
 #define K_BS			0x08	/* Ctrl + H */
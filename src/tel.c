@@ -4,13 +4,29 @@
 #include "hal/hal.h"
 
 #include "tel.h"
+#include "frame.h"
 #include "libc.h"
 #include "main.h"
 #include "regfile.h"
 #include "shell.h"
 
+#define TEL_FRAME_MAX		(TELPACK_BLOCK_SIZE + 80)
+#define TEL_FRAME_SYM_MAX	20
+
+#define TEL_QUANT_MAX		2147483520.f
+
+enum {
+	TEL_FRAME_HEADER	= 'H',
+	TEL_FRAME_BLOCK		= 'B'
+};
+
+static unsigned char		tel_frame[TEL_FRAME_MAX];
+static unsigned char		tel_live[TELPACK_BLOCK_SIZE];
+
 void tel_reg_default(tel_t *ti)
 {
+	int		N;
+
 	ti->reg_ID[0] = ID_PM_FB_IA;
 	ti->reg_ID[1] = ID_PM_FB_IB;
 	ti->reg_ID[2] = ID_PM_LU_ID;
@@ -21,28 +37,287 @@ void tel_reg_default(tel_t *ti)
 	ti->reg_ID[7] = ID_PM_WATT_LPF_WP;
 	ti->reg_ID[8] = ID_PM_CONST_LPF_U;
 	ti->reg_ID[9] = ID_AP_TEMP_PCB;
+
+	for (N = 0; N < TEL_INPUT_MAX; ++N) {
+
+		ti->div[N] = 1;
+		ti->agg[N] = TEL_AGG_LAST;
+	}
+
+	ti->tr_mode = TEL_TRIG_FAULT;
+	ti->tr_reg_ID = ID_PM_LU_IQ;
+	ti->tr_level = 0.f;
+	ti->tr_post = 100;
 }
 
-void tel_reg_grab(tel_t *ti)
+static void
+tel_reg_aggregate(tel_t *ti)
 {
-	const reg_t		*reg;
+	tel_plan_t		*plan;
+	reg_val_t		val;
+	int			N;
+
+	for (N = 0; N < ti->pN; ++N) {
+
+		plan = &ti->plan[N];
+
+		if (plan->agg == TEL_AGG_LAST)
+			continue;
+
+		if (plan->op == REG_GRAB_PROC) {
+
+			reg_getval(plan->reg, &val);
+		}
+		else {
+			val = *plan->link;
+		}
+
+		if (plan->aN == 0) {
+
+			plan->acc = (plan->agg == TEL_AGG_MIN
+					|| plan->agg == TEL_AGG_MAX) ? val.f : 0.f;
+		}
+
+		switch (plan->agg) {
+
+			case TEL_AGG_MEAN:
+				plan->acc += val.f;
+				break;
+
+			case TEL_AGG_MIN:
+				plan->acc = (val.f < plan->acc) ? val.f : plan->acc;
+				break;
+
+			case TEL_AGG_MAX:
+				plan->acc = (val.f > plan->acc) ? val.f : plan->acc;
+				break;
+
+			case TEL_AGG_RMS:
+				plan->acc += val.f * val.f;
+				break;
+		}
+
+		plan->aN++;
+	}
+}
+
+static void
+tel_reg_raw(tel_t *ti, reg_val_t *data)
+{
+	tel_plan_t		*plan;
+	unsigned long		pack;
+	int			N;
+
+	for (N = 0; N < ti->pN; ++N) {
+
+		plan = &ti->plan[N];
+
+		if (plan->cnt > 1) {
+
+			/* Hold the value until the channel divider is
+			 * expired.
+			 * */
+			data[plan->N] = plan->last;
+			plan->cnt--;
+
+			continue;
+		}
+
+		plan->cnt = plan->div;
+
+		if (plan->agg != TEL_AGG_LAST && plan->aN > 0) {
+
+			if (plan->agg == TEL_AGG_MEAN) {
+
+				data[plan->N].f = plan->acc / (float) plan->aN;
+			}
+			else if (plan->agg == TEL_AGG_RMS) {
+
+				data[plan->N].f = m_sqrtf(plan->acc / (float) plan->aN);
+			}
+			else {
+				data[plan->N].f = plan->acc;
+			}
+
+			plan->last = data[plan->N];
+			plan->aN = 0;
+
+			continue;
+		}
+
+		/* Grab the raw value according to the plan.
+		 * */
+		switch (plan->op) {
+
+			case REG_GRAB_COPY:
+			case REG_GRAB_CONVERT:
+				data[plan->N] = *plan->link;
+				break;
+
+			case REG_GRAB_ANGLE:
+				pack = (unsigned long) (int) (plan->link[0].f * 32767.f) & 0xFFFFUL;
+				pack |= ((unsigned long) (int) (plan->link[1].f * 32767.f) & 0xFFFFUL) << 16;
+				data[plan->N].i = (int) pack;
+				break;
+
+			default:
+				reg_getval(plan->reg, &data[plan->N]);
+				break;
+		}
+
+		plan->last = data[plan->N];
+	}
+}
+
+static void
+tel_reg_quant(tel_t *ti, const reg_val_t *data, int *q)
+{
+	const tel_plan_t	*plan;
+	float			f;
 	int			N;
 
+	for (N = 0; N < ti->pN; ++N) {
+
+		plan = &ti->plan[N];
+
+		/* Quantize the raw value with channel scale.
+		 * */
+		if (plan->op == REG_GRAB_ANGLE) {
+
+			q[plan->q] = (short) (data[plan->N].i & 0xFFFF);
+			q[plan->q + 1] = data[plan->N].i >> 16;
+		}
+		else if (plan->scale != 0.f) {
+
+			f = data[plan->N].f * plan->scale;
+			f = f + ((f < 0.f) ? - .5f : .5f);
+
+			/* Values out of the integer range are saturated,
+			 * including PM_INFINITY and NaN.
+			 * */
+			f = (f < TEL_QUANT_MAX) ? ((f > - TEL_QUANT_MAX) ? f
+				: - TEL_QUANT_MAX) : TEL_QUANT_MAX;
+
+			q[plan->q] = (int) f;
+		}
+		else {
+			q[plan->q] = data[plan->N].i;
+		}
+	}
+}
+
+static void
+tel_reg_pack(tel_t *ti)
+{
+	reg_val_t		data[TEL_INPUT_MAX];
+	int			q[TELPACK_CHANNEL_MAX];
+
+	tel_reg_raw(ti, data);
+	tel_reg_quant(ti, data, q);
+
+	if (telpack_encode(&ti->tp, q) == 0) {
+
+		ti->mode = 0;
+	}
+}
+
+static void
+tel_reg_unpack(tel_t *ti, const int *q, reg_val_t *data)
+{
+	const tel_plan_t	*plan;
+	int			N;
+
+	for (N = 0; N < ti->pN; ++N) {
+
+		plan = &ti->plan[N];
+
+		if (plan->op == REG_GRAB_ANGLE) {
+
+			data[plan->N].i = (int) (((unsigned long) q[plan->q] & 0xFFFFUL)
+				| (((unsigned long) q[plan->q + 1] & 0xFFFFUL) << 16));
+		}
+		else if (plan->scale != 0.f) {
+
+			data[plan->N].f = (float) q[plan->q] / plan->scale;
+		}
+		else {
+			data[plan->N].i = q[plan->q];
+		}
+	}
+}
+
+static int
+tel_reg_trigger(tel_t *ti)
+{
+	reg_val_t		val;
+	int			fired = 0;
+
+	if (ti->tr_mode == TEL_TRIG_FAULT) {
+
+		fired = (pm.fail_reason != PM_OK) ? 1 : 0;
+	}
+	else if (ti->tr_reg != NULL) {
+
+		if (ti->tr_reg->proc == NULL) {
+
+			val = *ti->tr_reg->link;
+		}
+		else {
+			reg_getval(ti->tr_reg, &val);
+		}
+
+		if (ti->tr_mode == TEL_TRIG_CHANGE) {
+
+			fired = (val.i != ti->tr_last.i) ? 1 : 0;
+		}
+		else if (ti->tr_reg->fmt[1] == 'i') {
+
+			fired = (ti->tr_mode == TEL_TRIG_RISING)
+				? (ti->tr_last.i < (int) ti->tr_level && val.i >= (int) ti->tr_level)
+				: (ti->tr_last.i > (int) ti->tr_level && val.i <= (int) ti->tr_level);
+		}
+		else {
+			fired = (ti->tr_mode == TEL_TRIG_RISING)
+				? (ti->tr_last.f < ti->tr_level && val.f >= ti->tr_level)
+				: (ti->tr_last.f > ti->tr_level && val.f <= ti->tr_level);
+		}
+
+		ti->tr_last = val;
+	}
+
+	return fired;
+}
+
+void tel_reg_grab(tel_t *ti)
+{
 	if (ti->mode != 0) {
 
+		if (ti->mode == TEL_MODE_TRIGGER && ti->tr_N < 0) {
+
+			/* Check the trigger condition at each cycle.
+			 * */
+			if (tel_reg_trigger(ti) != 0) {
+
+				ti->tr_N = ti->tr_post;
+			}
+		}
+
+		if (ti->gN != 0) {
+
+			tel_reg_aggregate(ti);
+		}
+
 		ti->i++;
 
 		if (ti->i == 1) {
 
-			for (N = 0; N < TEL_INPUT_MAX; ++N) {
-
-				if (ti->reg_ID[N] != ID_NULL) {
+			if (		ti->mode == TEL_MODE_PACK_GRAB
+					|| ti->mode == TEL_MODE_TRIGGER) {
 
-					/* Grab the value is register is not null.
-					 * */
-					reg = &regfile[ti->reg_ID[N]];
-					reg_getval(reg, &ti->data[ti->n][N]);
-				}
+				tel_reg_pack(ti);
+			}
+			else {
+				tel_reg_raw(ti, ti->data[ti->n]);
 			}
 		}
 
@@ -63,15 +338,123 @@ void tel_reg_grab(tel_t *ti)
 
 				ti->n = (ti->n < (TEL_DATA_MAX - 1)) ? ti->n + 1 : 0;
 			}
+			else if (ti->mode == TEL_MODE_PACK_GRAB) {
+
+				ti->n++;
+			}
+			else if (ti->mode == TEL_MODE_TRIGGER) {
+
+				ti->n++;
+
+				if (ti->tr_N == 0) {
+
+					/* Freeze the ring after post-trigger
+					 * samples.
+					 * */
+					ti->mode = 0;
+				}
+				else if (ti->tr_N > 0) {
+
+					ti->tr_N--;
+				}
+			}
+		}
+	}
+}
+
+static float
+tel_reg_gain(const reg_t *reg)
+{
+	reg_val_t		raw, lval[2];
+	float			gain;
+
+	/* Gain of the linear unit conversion.
+	 * */
+	raw.f = 0.f;
+	reg_grab_value(reg, REG_GRAB_CONVERT, &lval[0], &raw);
+
+	raw.f = 1.f;
+	reg_grab_value(reg, REG_GRAB_CONVERT, &lval[1], &raw);
+
+	gain = m_fabsf(lval[1].f - lval[0].f);
+
+	return (m_isfinitef(gain) != 0 && gain > 0.f) ? gain : 1.f;
+}
+
+static void
+tel_reg_plan(tel_t *ti)
+{
+	const reg_t		*reg;
+	tel_plan_t		*plan;
+	int			N, K;
+
+	ti->pN = 0;
+	ti->qN = 0;
+	ti->gN = 0;
+
+	for (N = 0; N < TEL_INPUT_MAX; ++N) {
+
+		if (ti->reg_ID[N] != ID_NULL) {
+
+			reg = &regfile[ti->reg_ID[N]];
+			plan = &ti->plan[ti->pN++];
+
+			plan->reg = reg;
+			plan->link = reg->link;
+			plan->op = reg_grab_op(reg);
+			plan->N = N;
+
+			/* Quantization step is taken from the register
+			 * format so we keep all printed digits.
+			 * */
+			plan->scale = 0.f;
+			plan->q = ti->qN;
+
+			if (plan->op == REG_GRAB_ANGLE) {
+
+				ti->qN += 2;
+			}
+			else {
+				if (reg->fmt[2] == 'f') {
+
+					plan->scale = 1.f;
+
+					for (K = 0; K < reg->fmt[1] - '0'; ++K)
+						plan->scale *= 10.f;
+
+					if (plan->op == REG_GRAB_CONVERT) {
+
+						/* Digits are printed after the
+						 * conversion of the raw value.
+						 * */
+						plan->scale *= tel_reg_gain(reg);
+					}
+				}
+
+				ti->qN += 1;
+			}
+
+			plan->div = (ti->div[N] > 1) ? ti->div[N] : 1;
+			plan->cnt = 0;
+
+			/* Aggregation is applied to float values only.
+			 * */
+			plan->agg = (plan->op == REG_GRAB_ANGLE || reg->fmt[1] == 'i')
+				? TEL_AGG_LAST : ti->agg[N];
+			plan->aN = 0;
+
+			ti->gN += (plan->agg != TEL_AGG_LAST) ? 1 : 0;
 		}
 	}
 }
 
 void tel_startup(tel_t *ti, int freq, int mode)
 {
-	if (freq > 0 && freq <= hal.PWM_frequency) {
+	/* We take the actual PWM frequency as it may be lowered by VSF.
+	 * */
+	if (freq > 0 && freq <= pm.freq_hz) {
 
-		ti->d = (hal.PWM_frequency + freq / 2) / freq;
+		ti->d = ((int) pm.freq_hz + freq / 2) / freq;
 	}
 	else {
 		ti->d = 1;
@@ -80,6 +463,27 @@ void tel_startup(tel_t *ti, int freq, int mode)
 	ti->i = 0;
 	ti->n = 0;
 
+	tel_reg_plan(ti);
+
+	if (mode == TEL_MODE_PACK_GRAB) {
+
+		telpack_startup(&ti->tp, ti->pack, sizeof(ti->pack), ti->qN, 0);
+	}
+	else if (mode == TEL_MODE_TRIGGER) {
+
+		telpack_startup(&ti->tp, ti->pack, sizeof(ti->pack), ti->qN, 1);
+
+		ti->tr_reg = (ti->tr_reg_ID != ID_NULL) ? &regfile[ti->tr_reg_ID] : NULL;
+		ti->tr_N = -1;
+
+		if (ti->tr_reg != NULL) {
+
+			reg_getval(ti->tr_reg, &ti->tr_last);
+		}
+	}
+
+	ti->packed = (mode == TEL_MODE_PACK_GRAB || mode == TEL_MODE_TRIGGER) ? 1 : 0;
+
 	hal_fence();
 	ti->mode = mode;
 }
@@ -98,6 +502,22 @@ SH_DEF(tel_grab)
 	tel_startup(&ti, freq, TEL_MODE_SINGLE_GRAB);
 }
 
+SH_DEF(tel_pack_grab)
+{
+	int		freq = 0;
+
+	stoi(&freq, s);
+	tel_startup(&ti, freq, TEL_MODE_PACK_GRAB);
+}
+
+SH_DEF(tel_trigger)
+{
+	int		freq = 0;
+
+	stoi(&freq, s);
+	tel_startup(&ti, freq, TEL_MODE_TRIGGER);
+}
+
 SH_DEF(tel_stop)
 {
 	tel_halt(&ti);
@@ -109,67 +529,244 @@ void tel_reg_labels(tel_t *ti)
 	const char		*su;
 	int			N;
 
-	for (N = 0; N < TEL_INPUT_MAX; ++N) {
+	for (N = 0; N < ti->pN; ++N) {
 
-		if (ti->reg_ID[N] != ID_NULL) {
+		reg = ti->plan[N].reg;
 
-			reg = &regfile[ti->reg_ID[N]];
+		puts(reg->sym);
 
-			puts(reg->sym);
+		su = reg->sym + strlen(reg->sym) + 1;
 
-			su = reg->sym + strlen(reg->sym) + 1;
+		if (*su != 0) {
 
-			if (*su != 0) {
+			printf("@%s", su);
+		}
 
-				printf("@%s", su);
-			}
+		puts(";");
+	}
 
-			puts(";");
-		}
+	puts(EOL);
+}
+
+static void
+tel_reg_flush_data(tel_t *ti, const reg_val_t *data)
+{
+	const tel_plan_t	*plan;
+	reg_val_t		rval;
+	int			N;
+
+	for (N = 0; N < ti->pN; ++N) {
+
+		plan = &ti->plan[N];
+
+		/* Unit conversion is deferred up to this point.
+		 * */
+		reg_grab_value(plan->reg, plan->op, &rval, &data[plan->N]);
+		reg_format_rval(plan->reg, &rval);
+
+		puts(";");
 	}
 
 	puts(EOL);
 }
 
+void tel_reg_flush_1(tel_t *ti, int nR)
+{
+	tel_reg_flush_data(ti, ti->data[nR]);
+}
+
 void tel_reg_flush(tel_t *ti)
 {
-	const reg_t		*reg;
-	int			K, N;
+	int			K;
 
 	for (K = 0; K < TEL_DATA_MAX; ++K) {
 
-		for (N = 0; N < TEL_INPUT_MAX; ++N) {
+		tel_reg_flush_1(ti, K);
+	}
+}
 
-			if (ti->reg_ID[N] != ID_NULL) {
+void tel_reg_flush_pack(tel_t *ti)
+{
+	telpack_iter_t		it;
+	const unsigned char	*block;
+	reg_val_t		data[TEL_INPUT_MAX];
+	int			K = 0;
 
-				reg = &regfile[ti->reg_ID[N]];
-				reg_format_rval(reg, &ti->data[K][N]);
+	while ((block = telpack_block(&ti->tp, K++)) != NULL) {
 
-				puts(";");
-			}
+		telpack_iter(&it, block, ti->qN);
+
+		while (telpack_next(&it) != 0) {
+
+			tel_reg_unpack(ti, it.q, data);
+			tel_reg_flush_data(ti, data);
 		}
+	}
+}
+
+static int
+tel_reg_desc(const tel_plan_t *plan, float *gain)
+{
+	reg_val_t		rval;
+	int			type;
+
+	rval.f = 1.f;
+	*gain = 1.f;
+
+	/* We assume that unit conversion is linear so only the gain is
+	 * passed to the host.
+	 * */
+	if (plan->op == REG_GRAB_ANGLE) {
+
+		type = 'a';
+	}
+	else if (plan->scale != 0.f) {
+
+		type = 'f';
+
+		if (plan->op == REG_GRAB_CONVERT) {
+
+			reg_grab_value(plan->reg, plan->op, gain, &rval);
+		}
+	}
+	else {
+		type = (plan->reg->fmt[2] == 'e') ? 'e' : 'i';
+	}
+
+	return type;
+}
+
+static int
+tel_block_len(tel_t *ti, const unsigned char *block)
+{
+	telpack_iter_t		it;
+
+	telpack_iter(&it, block, ti->qN);
+
+	while (telpack_next(&it) != 0) ;
+
+	return (int) (it.p - block);
+}
+
+void tel_reg_dump_pack(tel_t *ti)
+{
+	const unsigned char	*block, *end;
+	float			gain;
+	int			N, K = 0, type;
+
+	tel_reg_labels(ti);
+
+	/* Channel descriptors for host decoder.
+	 * */
+	for (N = 0; N < ti->pN; ++N) {
+
+		type = tel_reg_desc(&ti->plan[N], &gain);
+
+		printf("%c %4e %4e;", type, &ti->plan[N].scale, &gain);
+	}
+
+	puts(EOL);
+
+	while ((block = telpack_block(&ti->tp, K++)) != NULL) {
+
+		end = block + tel_block_len(ti, block);
+
+		for (; block < end; ++block)
+			printf("%2x", *block);
 
 		puts(EOL);
 	}
 }
 
-void tel_reg_flush_1(tel_t *ti, int nR)
+static void
+tel_frame_header(tel_t *ti)
 {
 	const reg_t		*reg;
-	int			N;
+	unsigned char		*p = tel_frame;
+	float			gain;
+	int			N, type;
 
-	for (N = 0; N < TEL_INPUT_MAX; ++N) {
+	*p++ = TEL_FRAME_HEADER;
+	*p++ = (unsigned char) ti->pN;
 
-		if (ti->reg_ID[N] != ID_NULL) {
+	for (N = 0; N < ti->pN; ++N) {
 
-			reg = &regfile[ti->reg_ID[N]];
-			reg_format_rval(reg, &ti->data[nR][N]);
+		reg = ti->plan[N].reg;
+		type = tel_reg_desc(&ti->plan[N], &gain);
+
+		*p++ = (unsigned char) type;
+
+		memcpy(p, &ti->plan[N].scale, sizeof(float));
+		p += sizeof(float);
 
-			puts(";");
+		memcpy(p, &gain, sizeof(float));
+		p += sizeof(float);
+
+		/* Symbol and unit separated with zero byte.
+		 * */
+		p = (unsigned char *) strcpyn((char *) p, reg->sym, TEL_FRAME_SYM_MAX) + 1;
+		p = (unsigned char *) strcpyn((char *) p, reg->sym + strlen(reg->sym) + 1,
+				TEL_FRAME_SYM_MAX) + 1;
+	}
+
+	frame_send(tel_frame, (int) (p - tel_frame));
+}
+
+static void
+tel_frame_block(const unsigned char *block, int len, int seq)
+{
+	tel_frame[0] = TEL_FRAME_BLOCK;
+	tel_frame[1] = (unsigned char) (seq);
+	tel_frame[2] = (unsigned char) (seq >> 8);
+
+	if (block != tel_frame + 3) {
+
+		memcpy(tel_frame + 3, block, len);
+	}
+
+	frame_send(tel_frame, len + 3);
+}
+
+void tel_reg_flush_frame(tel_t *ti)
+{
+	telpack_t		tp;
+	const unsigned char	*block;
+	int			q[TELPACK_CHANNEL_MAX];
+	int			K = 0, seq = 0;
+
+	tel_frame_header(ti);
+
+	if (ti->packed != 0) {
+
+		while ((block = telpack_block(&ti->tp, K++)) != NULL) {
+
+			tel_frame_block(block, tel_block_len(ti, block), seq++);
 		}
 	}
+	else {
+		telpack_startup(&tp, tel_frame + 3, TELPACK_BLOCK_SIZE, ti->qN, 0);
 
-	puts(EOL);
+		while (K < TEL_DATA_MAX) {
+
+			tel_reg_quant(ti, ti->data[K], q);
+
+			if (telpack_encode(&tp, q) != 0) {
+
+				K++;
+			}
+			else {
+				/* Block is full so we send it and start over.
+				 * */
+				tel_frame_block(tel_frame + 3, tp.len, seq++);
+				telpack_startup(&tp, tel_frame + 3, TELPACK_BLOCK_SIZE, ti->qN, 0);
+			}
+		}
+
+		if (tp.bN != 0) {
+
+			tel_frame_block(tel_frame + 3, tp.len, seq++);
+		}
+	}
 }
 
 SH_DEF(tel_flush_sync)
@@ -177,7 +774,22 @@ SH_DEF(tel_flush_sync)
 	if (ti.mode == TEL_MODE_DISABLED) {
 
 		tel_reg_labels(&ti);
-		tel_reg_flush(&ti);
+
+		if (ti.packed != 0) {
+
+			tel_reg_flush_pack(&ti);
+		}
+		else {
+			tel_reg_flush(&ti);
+		}
+	}
+}
+
+SH_DEF(tel_pack_dump)
+{
+	if (ti.mode == TEL_MODE_DISABLED && ti.packed != 0) {
+
+		tel_reg_dump_pack(&ti);
 	}
 }
 
@@ -207,18 +819,99 @@ SH_DEF(tel_live_sync)
 	TaskHandle_t		xHandle;
 	int			freq = 20;
 
-	xTaskCreate(task_LIVE, "LIVE", configMINIMAL_STACK_SIZE, (void *) &ti, 1, &xHandle);
-
 	if (stoi(&freq, s) != NULL) {
 
 		freq = (freq < 1) ? 1 : (freq > 50) ? 50 : freq;
 	}
 
+	/* Startup before the task is created so labels are taken from the
+	 * actual plan.
+	 * */
 	tel_startup(&ti, freq, TEL_MODE_LIVE);
 
+	xTaskCreate(task_LIVE, "LIVE", configMINIMAL_STACK_SIZE, (void *) &ti, 1, &xHandle);
+
 	getc();
 
 	tel_halt(&ti);
 	vTaskDelete(xHandle);
 }
 
+
+SH_DEF(tel_flush_frame)
+{
+	if (ti.mode == TEL_MODE_DISABLED) {
+
+		tel_reg_flush_frame(&ti);
+	}
+}
+
+void task_LIVE_FRAME(void *pData)
+{
+	tel_t		*ti = (tel_t *) pData;
+	telpack_t	tp;
+	int		q[TELPACK_CHANNEL_MAX];
+	int		nR = ti->n, seq = 0, hseq = -1, wait = 0;
+
+	telpack_startup(&tp, tel_live, TELPACK_BLOCK_SIZE, ti->qN, 0);
+
+	do {
+		vTaskDelay((TickType_t) 5);
+
+		if ((seq & 0x3F) == 0 && seq != hseq) {
+
+			/* Repeat the header so host can join at any time.
+			 * */
+			tel_frame_header(ti);
+			hseq = seq;
+		}
+
+		while (ti->n != nR) {
+
+			tel_reg_quant(ti, ti->data[nR], q);
+
+			if (telpack_encode(&tp, q) != 0) {
+
+				nR = (nR < (TEL_DATA_MAX - 1)) ? nR + 1 : 0;
+			}
+			else {
+				tel_frame_block(tel_live, tp.len, seq++);
+				telpack_startup(&tp, tel_live, TELPACK_BLOCK_SIZE, ti->qN, 0);
+			}
+
+			hal_fence();
+		}
+
+		/* Send a partial block to keep the latency low.
+		 * */
+		if (tp.bN != 0 && (tp.len > TELPACK_BLOCK_SIZE / 4 || ++wait >= 20)) {
+
+			tel_frame_block(tel_live, tp.len, seq++);
+			telpack_startup(&tp, tel_live, TELPACK_BLOCK_SIZE, ti->qN, 0);
+
+			wait = 0;
+		}
+	}
+	while (1);
+}
+
+SH_DEF(tel_live_frame)
+{
+	TaskHandle_t		xHandle;
+	int			freq = 500;
+
+	if (stoi(&freq, s) != NULL) {
+
+		freq = (freq < 1) ? 1 : (freq > 1000) ? 1000 : freq;
+	}
+
+	tel_startup(&ti, freq, TEL_MODE_LIVE);
+
+	xTaskCreate(task_LIVE_FRAME, "LIVE", configMINIMAL_STACK_SIZE + 128,
+			(void *) &ti, 1, &xHandle);
+
+	getc();
+
+	tel_halt(&ti);
+	vTaskDelete(xHandle);
+}
@@ -2,6 +2,7 @@
 #define _H_TEL_
 
 #include "regfile.h"
+#include "telpack.h"
 
 #define TEL_DATA_MAX		1000
 #define TEL_INPUT_MAX		10
@@ -9,21 +10,86 @@
 enum {
 	TEL_MODE_DISABLED	= 0,
 	TEL_MODE_SINGLE_GRAB,
-	TEL_MODE_LIVE
+	TEL_MODE_LIVE,
+	TEL_MODE_PACK_GRAB,
+	TEL_MODE_TRIGGER
 };
 
+enum {
+	TEL_AGG_LAST		= 0,
+	TEL_AGG_MEAN,
+	TEL_AGG_MIN,
+	TEL_AGG_MAX,
+	TEL_AGG_RMS
+};
+
+enum {
+	TEL_TRIG_DISABLED	= 0,
+	TEL_TRIG_RISING,
+	TEL_TRIG_FALLING,
+	TEL_TRIG_CHANGE,
+	TEL_TRIG_FAULT
+};
+
+typedef struct {
+
+	const reg_t		*reg;
+	const reg_val_t		*link;
+
+	int			op;
+	int			N;
+
+	float			scale;
+	int			q;
+
+	int			div;
+	int			cnt;
+	int			agg;
+
+	float			acc;
+	int			aN;
+
+	reg_val_t		last;
+}
+tel_plan_t;
+
 typedef struct {
 
 	int		mode;
 
 	int		reg_ID[TEL_INPUT_MAX];
+	int		div[TEL_INPUT_MAX];
+	int		agg[TEL_INPUT_MAX];
+
+	tel_plan_t	plan[TEL_INPUT_MAX];
+	int		pN;
+	int		qN;
+	int		gN;
 
 	int		d;
 	int		i;
 
-	reg_val_t	data[TEL_DATA_MAX][TEL_INPUT_MAX];
+	union {
+
+		reg_val_t	data[TEL_DATA_MAX][TEL_INPUT_MAX];
+		unsigned char	pack[TEL_DATA_MAX * TEL_INPUT_MAX * sizeof(reg_val_t)];
+	};
+
+	telpack_t	tp;
 
+	int		packed;
 	int		n;
+
+	/* Trigger configuration.
+	 * */
+	int		tr_mode;
+	int		tr_reg_ID;
+	float		tr_level;
+	int		tr_post;
+
+	const reg_t	*tr_reg;
+	reg_val_t	tr_last;
+	int		tr_N;
 }
 tel_t;
 
@@ -0,0 +1,160 @@
+#include <stddef.h>
+
+#include "telpack.h"
+
+static unsigned char *
+telpack_put(unsigned char *p, int v)
+{
+	unsigned int		u;
+
+	u = ((unsigned int) v << 1) ^ (unsigned int) (v >> 31);
+
+	while (u >= 0x80U) {
+
+		*p++ = (unsigned char) (u | 0x80U);
+		u >>= 7;
+	}
+
+	*p++ = (unsigned char) u;
+
+	return p;
+}
+
+static const unsigned char *
+telpack_get(const unsigned char *p, int *v)
+{
+	unsigned int		u = 0;
+	int			s = 0;
+
+	do {
+		u |= (unsigned int) (*p & 0x7FU) << s;
+		s += 7;
+	}
+	while ((*p++ & 0x80U) != 0 && s < 35);
+
+	*v = (int) (u >> 1) ^ - (int) (u & 1U);
+
+	return p;
+}
+
+void telpack_startup(telpack_t *tp, void *pack, int size, int N, int ring)
+{
+	tp->pack = (unsigned char *) pack;
+	tp->ring = ring;
+	tp->N = (N < TELPACK_CHANNEL_MAX) ? N : TELPACK_CHANNEL_MAX;
+
+	tp->bMAX = size / TELPACK_BLOCK_SIZE;
+	tp->bH = 0;
+	tp->bN = 0;
+	tp->len = 0;
+}
+
+int telpack_encode(telpack_t *tp, const int *q)
+{
+	unsigned char		*block, *p;
+	int			N, count;
+
+	if (tp->bN == 0 || tp->len + tp->N * 5 > TELPACK_BLOCK_SIZE) {
+
+		/* Open the next block with a keyframe.
+		 * */
+		if (tp->bN != 0) {
+
+			if (tp->bH + 1 < tp->bMAX) {
+
+				tp->bH += 1;
+			}
+			else if (tp->ring != 0) {
+
+				tp->bH = 0;
+			}
+			else {
+				return 0;
+			}
+		}
+		else if (tp->bMAX < 1) {
+
+			return 0;
+		}
+
+		tp->bN = (tp->bN < tp->bMAX) ? tp->bN + 1 : tp->bMAX;
+
+		block = tp->pack + tp->bH * TELPACK_BLOCK_SIZE;
+		p = block + 2;
+
+		for (N = 0; N < tp->N; ++N) {
+
+			p = telpack_put(p, q[N]);
+			tp->last[N] = q[N];
+		}
+
+		count = 0;
+	}
+	else {
+		block = tp->pack + tp->bH * TELPACK_BLOCK_SIZE;
+		p = block + tp->len;
+
+		for (N = 0; N < tp->N; ++N) {
+
+			p = telpack_put(p, (int) ((unsigned int) q[N]
+						- (unsigned int) tp->last[N]));
+			tp->last[N] = q[N];
+		}
+
+		count = block[0] | (block[1] << 8);
+	}
+
+	count += 1;
+
+	block[0] = (unsigned char) (count);
+	block[1] = (unsigned char) (count >> 8);
+
+	tp->len = (int) (p - block);
+
+	return 1;
+}
+
+const unsigned char *telpack_block(const telpack_t *tp, int K)
+{
+	int			bK;
+
+	if (K < 0 || K >= tp->bN)
+		return NULL;
+
+	/* Blocks are returned from the oldest one.
+	 * */
+	bK = tp->bH - (tp->bN - 1) + K;
+	bK += (bK < 0) ? tp->bMAX : 0;
+
+	return tp->pack + bK * TELPACK_BLOCK_SIZE;
+}
+
+void telpack_iter(telpack_iter_t *it, const unsigned char *block, int N)
+{
+	it->p = block + 2;
+
+	it->N = (N < TELPACK_CHANNEL_MAX) ? N : TELPACK_CHANNEL_MAX;
+	it->n = block[0] | (block[1] << 8);
+	it->k = 0;
+}
+
+int telpack_next(telpack_iter_t *it)
+{
+	int			N, v;
+
+	if (it->k >= it->n)
+		return 0;
+
+	for (N = 0; N < it->N; ++N) {
+
+		it->p = telpack_get(it->p, &v);
+
+		it->q[N] = (it->k == 0) ? v
+			: (int) ((unsigned int) it->q[N] + (unsigned int) v);
+	}
+
+	it->k += 1;
+
+	return 1;
+}
+
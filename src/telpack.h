@@ -0,0 +1,48 @@
+#ifndef _H_TELPACK_
+#define _H_TELPACK_
+
+#define TELPACK_BLOCK_SIZE		512
+#define TELPACK_CHANNEL_MAX		20
+
+/* Each block begins with the number of samples (16-bit), then the keyframe
+ * of absolute values and the deltas of the following samples. All values are
+ * zigzag variable-length integers with 7 bits per byte.
+ * */
+
+typedef struct {
+
+	unsigned char		*pack;
+
+	int			ring;
+	int			N;
+
+	int			bMAX;
+	int			bH;
+	int			bN;
+	int			len;
+
+	int			last[TELPACK_CHANNEL_MAX];
+}
+telpack_t;
+
+typedef struct {
+
+	const unsigned char	*p;
+
+	int			N;
+	int			n;
+	int			k;
+
+	int			q[TELPACK_CHANNEL_MAX];
+}
+telpack_iter_t;
+
+void telpack_startup(telpack_t *tp, void *pack, int size, int N, int ring);
+int telpack_encode(telpack_t *tp, const int *q);
+const unsigned char *telpack_block(const telpack_t *tp, int K);
+
+void telpack_iter(telpack_iter_t *it, const unsigned char *block, int N);
+int telpack_next(telpack_iter_t *it);
+
+#endif /* _H_TELPACK_ */
+